@@ -1,12 +1,21 @@
 #include <QApplication>
+#include <QCoreApplication>
 #include <QDir>
 #include <QFileInfo>
+#include <QScreen>
+#include <QTimer>
 #include <cstdlib>
 #include <iostream>
 
+#include "frame_target.hpp"
 #include "global_path.hpp"
 #include "image_formats.hpp"
 #include "main_window.hpp"
+#include "preview_cache.hpp"
+#include "session_replay.hpp"
+#include "single_instance.hpp"
+#include "startup_loader.hpp"
+#include "trace.hpp"
 
 namespace {
 
@@ -23,45 +32,216 @@ QString EnsureDefaultDirectoryExists() {
   return g_basicPath;
 }
 
-}  // namespace
+// Value following `name` on the command line, e.g. the file of --record.
+QString OptionValue(int argc, char* argv[], const char* name) {
+  for (int i = 1; i + 1 < argc; ++i) {
+    if (qstrcmp(argv[i], name) == 0) return QString::fromLocal8Bit(argv[i + 1]);
+  }
+  return QString();
+}
 
-MainWindow* CreateWindow(int argc, char* argv[]) {
-  // Collect non-flag arguments; honour --no-autoshow by starting blank.
+bool HasOption(int argc, char* argv[], const char* name) {
+  for (int i = 1; i < argc; ++i) {
+    if (qstrcmp(argv[i], name) == 0) return true;
+  }
+  return false;
+}
+
+// The non-option arguments: a folder and a start number, or image files.
+QStringList Arguments(int argc, char* argv[]) {
   QStringList args;
-  bool no_autoshow = false;
   for (int i = 1; i < argc; ++i) {
-    if (QString(argv[i]) == "--no-autoshow")
-      no_autoshow = true;
-    else
-      args << argv[i];
+    const QString arg = QString::fromLocal8Bit(argv[i]);
+    if (arg == "--record" || arg == "--replay" || arg == "--autoscroll-speed")
+      ++i;  // takes a value, handled in main()
+    else if (!arg.startsWith("--"))
+      args << arg;
   }
+  return args;
+}
 
-  if (no_autoshow) return new MainWindow();
+// What `args` ask to open: the images of `directory` from number `start`,
+// or else `images`.
+struct Request {
+  QString directory;
+  int start = 1;
+  QList<QString> images;
+};
 
-  if (!args.isEmpty() && QFileInfo(args[0]).isDir()) {
-    int start = args.size() >= 2 ? args[1].toInt() : 0;
-    return new MainWindow(args[0], start);
-  } else if (!args.isEmpty()) {
-    QList<QString> images;
-    for (const QString& filename : std::as_const(args)) {
+// False, with the reason in `error`, if a named image is not a file.
+bool ParseRequest(QStringList const& args, Request* request, QString* error) {
+  if (args.isEmpty()) {
+    request->directory = EnsureDefaultDirectoryExists();
+  } else if (QFileInfo(args[0]).isDir()) {
+    request->directory = args[0];
+    request->start = args.size() >= 2 ? args[1].toInt() : 0;
+  } else {
+    for (const QString& filename : args) {
       QFileInfo info(filename);
       if (!info.isFile()) {
-        std::cout << '\'' << filename.toStdString() << '\''
-                  << " is not a file\nAborting..." << std::endl;
-        std::exit(1);
+        *error = '\'' + filename + "' is not a file";
+        return false;
       }
-      if (IsSupportedImageSuffix(info.suffix())) images.append(filename);
+      if (IsSupportedImageSuffix(info.suffix()))
+        request->images.append(filename);
     }
-    return new MainWindow(images);
-  } else {
-    return new MainWindow(EnsureDefaultDirectoryExists());
   }
+  return true;
+}
+
+// `args` with their paths made absolute, for a viewer running elsewhere.
+QStringList AbsoluteArguments(QStringList args) {
+  const bool directory = !args.isEmpty() && QFileInfo(args[0]).isDir();
+  for (int i = 0; i < args.size(); ++i) {
+    if (i == 0 || !directory) args[i] = QFileInfo(args[i]).absoluteFilePath();
+  }
+  return args;
+}
+
+// Opens what a later launch forwarded, in place of the current list.
+void OpenForwarded(MainWindow* window, QStringList const& args) {
+  Request request;
+  QString error;
+  if (!ParseRequest(args, &request, &error)) {
+    std::cerr << error.toStdString() << std::endl;
+    return;
+  }
+  if (!request.directory.isEmpty())
+    request.images = ImagesInDirectory(QDir(request.directory));
+  window->openImages(std::move(request.images), request.start);
+}
+
+// Fills the preview cache for `directories` without opening a window,
+// reporting progress on stderr and a summary on stdout.
+int RunPrefetch(QStringList const& directories) {
+  if (directories.isEmpty()) {
+    std::cerr << "--prefetch needs at least one folder" << std::endl;
+    return 1;
+  }
+  auto rate = [](double amount, qint64 elapsed_ms) {
+    return elapsed_ms > 0 ? amount * 1000 / elapsed_ms : 0.0;
+  };
+  auto line = [&rate](PrefetchStats const& stats) {
+    return QStringLiteral("%1/%2 images  %3 images/s  %4 MiB/s")
+        .arg(stats.done)
+        .arg(stats.images)
+        .arg(rate(stats.done, stats.elapsed_ms), 0, 'f', 1)
+        .arg(rate(stats.bytes / (1024.0 * 1024.0), stats.elapsed_ms), 0,
+             'f', 1)
+        .toStdString();
+  };
+  const PreviewCache cache;
+  const PrefetchStats stats =
+      Prefetch(directories, cache, [&line](PrefetchStats const& progress) {
+        std::cerr << '\r' << line(progress) << std::flush;
+      });
+  std::cerr << '\r' << line(stats) << std::endl;
+  std::cout << stats.stored << " previews stored, " << stats.fresh
+            << " already up to date, " << stats.failed << " failed in "
+            << stats.elapsed_ms << " ms (" << cache.Directory().toStdString()
+            << ")" << std::endl;
+  return stats.failed == 0 ? 0 : 2;
+}
+
+}  // namespace
+
+// Starts loading what the command line asks for before the window is built,
+// so listing and decoding overlap with the window's construction.
+MainWindow* CreateWindow(int argc, char* argv[]) {
+  // Honour --no-autoshow by starting blank.
+  if (HasOption(argc, argv, "--no-autoshow")) return new MainWindow();
+
+  Request request;
+  QString error;
+  if (!ParseRequest(Arguments(argc, argv), &request, &error)) {
+    std::cout << error.toStdString() << "\nAborting..." << std::endl;
+    std::exit(1);
+  }
+  QScreen* screen = QGuiApplication::primaryScreen();
+  auto* loader = new StartupLoader(ScreenFrameTarget(screen));
+  if (!request.directory.isEmpty())
+    loader->LoadDirectory(request.directory, request.start);
+  else
+    loader->LoadImages(request.images);
+  auto* window = new MainWindow();
+  window->openWhenLoaded(loader);
+  return window;
 }
 
 int main(int argc, char* argv[]) {
+  if (HasOption(argc, argv, "--prefetch")) {
+    QCoreApplication app(argc, argv);
+    return RunPrefetch(Arguments(argc, argv));
+  }
+  // A replay is a measurement run: headless unless told otherwise.
+  const QString replay_path = OptionValue(argc, argv, "--replay");
+  if (!replay_path.isEmpty() && qEnvironmentVariableIsEmpty("QT_QPA_PLATFORM"))
+    qputenv("QT_QPA_PLATFORM", "offscreen");
+  // A running viewer takes over before this process pays for GUI start-up.
+  const bool single_instance = HasOption(argc, argv, "--single-instance") &&
+                               !HasOption(argc, argv, "--no-autoshow") &&
+                               replay_path.isEmpty();
+  if (single_instance &&
+      SingleInstance::Forward(SingleInstance::DefaultName(),
+                              AbsoluteArguments(Arguments(argc, argv))))
+    return 0;
   QApplication app(argc, argv);
+  // PVIEWER_TRACE=<file> records trace events for the whole session and
+  // writes them there, as Chrome trace JSON, on exit.
+  const QString trace_path = qEnvironmentVariable("PVIEWER_TRACE");
+  if (!trace_path.isEmpty()) trace::Start();
+  trace::NameThread("GUI");
   MainWindow* ps = CreateWindow(argc, argv);
+  const QString speed = OptionValue(argc, argv, "--autoscroll-speed");
+  if (!speed.isEmpty()) {
+    bool valid = false;
+    const double pixels_per_second = speed.toDouble(&valid);
+    if (valid && pixels_per_second > 0)
+      ps->setAutoScrollSpeed(pixels_per_second);
+    else
+      std::cerr << "Ignoring --autoscroll-speed " << speed.toStdString()
+                << ": not a positive number" << std::endl;
+  }
   ps->setWindowState(Qt::WindowMaximized | Qt::WindowFullScreen);
   ps->show();
-  return app.exec();
+
+  if (single_instance) {
+    auto* instance = new SingleInstance(&app);
+    QObject::connect(instance, &SingleInstance::argumentsReceived, ps,
+                     [ps](QStringList args) { OpenForwarded(ps, args); });
+    if (!instance->Listen(SingleInstance::DefaultName()))
+      std::cerr << "Failed to listen for other launches" << std::endl;
+  }
+
+  const QString record_path = OptionValue(argc, argv, "--record");
+  if (!record_path.isEmpty() && !ps->startRecording(record_path)) {
+    std::cerr << "Failed to record to '" << record_path.toStdString() << '\''
+              << std::endl;
+  }
+  if (!replay_path.isEmpty()) {
+    QString error;
+    const QVector<SessionEvent> events = ReadSession(replay_path, &error);
+    if (events.isEmpty()) {
+      std::cerr << "Nothing to replay in '" << replay_path.toStdString()
+                << "' " << error.toStdString() << std::endl;
+      return 1;
+    }
+    auto* replay = new SessionReplay(events, ps, &app);
+    QObject::connect(replay, &SessionReplay::finished, &app, [replay] {
+      std::cout << replay->Report().toStdString() << std::flush;
+      QApplication::quit();
+    });
+    // Replay against the full list, not against the startup preview.
+    if (ps->isOpening())
+      QObject::connect(ps, &MainWindow::opened, replay, &SessionReplay::Start);
+    else
+      QTimer::singleShot(0, replay, &SessionReplay::Start);
+  }
+
+  const int result = app.exec();
+  if (!trace_path.isEmpty() && !trace::WriteChromeJson(trace_path)) {
+    std::cerr << "Failed to write trace to '" << trace_path.toStdString()
+              << '\'' << std::endl;
+  }
+  return result;
 }
@@ -0,0 +1,114 @@
+#include <benchmark/benchmark.h>
+
+#include <QString>
+#include <QVector>
+
+#include "image_comparison_model.hpp"
+
+/*
+ * ImageComparisonModel is consulted on every panel edit, and most of its
+ * lookups are linear scans by id. These benchmarks track how the edits the
+ * panel emits scale with the number of entries. The edited path is always the
+ * last row, i.e. the worst case for RowOf().
+ */
+
+namespace {
+
+QVector<QString> Paths(int n) {
+  QVector<QString> paths;
+  paths.reserve(n);
+  for (int i = 0; i != n; ++i)
+    paths.push_back(
+        QString("/photos/IMG_%1.jpg").arg(i, 7, 10, QLatin1Char('0')));
+  return paths;
+}
+
+ImageComparisonModel Model(int n) {
+  ImageComparisonModel model;
+  model.SetImages(Paths(n));
+  return model;
+}
+
+void ListSizes(benchmark::internal::Benchmark* b) {
+  b->ArgName("entries")->RangeMultiplier(10)->Range(100, 100'000);
+}
+
+}  // namespace
+
+static void BM_ModelSetImages(benchmark::State& state) {
+  const QVector<QString> paths = Paths(state.range(0));
+  ImageComparisonModel model;
+  for (auto _ : state) model.SetImages(paths);
+  state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+BENCHMARK(BM_ModelSetImages)->Apply(ListSizes);
+
+static void BM_ModelEnabledIds(benchmark::State& state) {
+  const ImageComparisonModel model = Model(state.range(0));
+  for (auto _ : state) benchmark::DoNotOptimize(model.EnabledIds());
+}
+BENCHMARK(BM_ModelEnabledIds)->Apply(ListSizes);
+
+// A checkbox toggled in the panel: one Disable plus one Enable edit.
+static void BM_ModelToggleEdit(benchmark::State& state) {
+  ImageComparisonModel model = Model(state.range(0));
+  const QString path = model.Entries().last().Path();
+  const EntryEdit disable{EntryEdit::Kind::Disable, path};
+  const EntryEdit enable{EntryEdit::Kind::Enable, path};
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(model.ApplyEdit(disable));
+    benchmark::DoNotOptimize(model.ApplyEdit(enable));
+  }
+  state.SetItemsProcessed(2 * state.iterations());
+}
+BENCHMARK(BM_ModelToggleEdit)->Apply(ListSizes);
+
+// A row dragged from the bottom to the top and back.
+static void BM_ModelMoveEdit(benchmark::State& state) {
+  ImageComparisonModel model = Model(state.range(0));
+  const int last = model.Entries().size() - 1;
+  const QString path = model.Entries().last().Path();
+  const EntryEdit to_top{EntryEdit::Kind::Move, path, 0};
+  const EntryEdit to_bottom{EntryEdit::Kind::Move, path, last};
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(model.ApplyEdit(to_top));
+    benchmark::DoNotOptimize(model.ApplyEdit(to_bottom));
+  }
+  state.SetItemsProcessed(2 * state.iterations());
+}
+BENCHMARK(BM_ModelMoveEdit)->Apply(ListSizes);
+
+// Removing a row and restoring it, as Delete followed by undo does.
+static void BM_ModelRemoveInsertEdit(benchmark::State& state) {
+  ImageComparisonModel model = Model(state.range(0));
+  const int last = model.Entries().size() - 1;
+  const QString path = model.Entries().last().Path();
+  const EntryEdit remove{EntryEdit::Kind::Remove, path};
+  const EntryEdit insert{EntryEdit::Kind::Insert, path, last};
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(model.ApplyEdit(remove));
+    benchmark::DoNotOptimize(model.ApplyEdit(insert));
+  }
+  state.SetItemsProcessed(2 * state.iterations());
+}
+BENCHMARK(BM_ModelRemoveInsertEdit)->Apply(ListSizes);
+
+static void BM_ModelActiveIndexOf(benchmark::State& state) {
+  const ImageComparisonModel model = Model(state.range(0));
+  const QString path = model.Entries().last().Path();
+  for (auto _ : state) benchmark::DoNotOptimize(model.ActiveIndexOf(path));
+}
+BENCHMARK(BM_ModelActiveIndexOf)->Apply(ListSizes);
+
+// Resolving a disabled path to its nearest enabled neighbour, with every
+// other entry disabled so the outward search has to walk.
+static void BM_ModelEnabledPositionFor(benchmark::State& state) {
+  ImageComparisonModel model = Model(state.range(0));
+  for (int row = 0; row < model.Entries().size(); row += 2)
+    model.SetEnabled(row, false);
+  const QString path = model.Entries().at(model.Entries().size() / 2).Path();
+  model.SetPathEnabled(path, false);
+  for (auto _ : state)
+    benchmark::DoNotOptimize(model.EnabledPositionFor(path));
+}
+BENCHMARK(BM_ModelEnabledPositionFor)->Apply(ListSizes);
@@ -0,0 +1,278 @@
+#include <benchmark/benchmark.h>
+
+#include <QCoreApplication>
+#include <QDir>
+#include <QFileInfo>
+#include <QImage>
+#include <QImageReader>
+#include <QImageWriter>
+#include <QPixmap>
+#include <QTemporaryDir>
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <memory>
+#include <mutex>
+#include <random>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "decode_queue.hpp"
+
+/*
+ * Cost of each stage between a file on disk and a QPixmap on screen: the
+ * decode a DecodeQueue worker runs, the downscaled decode we could run
+ * instead, the conversion to the raster engine's premultiplied format, and
+ * QPixmap::fromImage on the GUI thread. The last benchmark runs the real
+ * DecodeQueue end to end with a varying number of workers.
+ *
+ * The corpus is generated on first use, deterministically, into a temporary
+ * directory. Set PVIEWER_BENCH_CORPUS to a directory to keep it between runs.
+ */
+
+namespace {
+
+struct CorpusImage {
+  const char* format;  // "jpg" or "png"
+  bool alpha;          // png only
+  bool progressive;    // jpg only; Qt cannot write interlaced PNGs
+  int megapixels;
+
+  std::string Name() const {
+    std::string name = format;
+    if (alpha) name += "-alpha";
+    if (progressive) name += "-progressive";
+    return name + "/" + std::to_string(megapixels) + "MP";
+  }
+  QString FileName() const {
+    return QString::fromStdString(Name()).replace('/', '-') + '.' + format;
+  }
+};
+
+std::vector<CorpusImage> CorpusSpecs() {
+  std::vector<CorpusImage> specs;
+  for (int megapixels : {1, 12, 48, 100}) {
+    specs.push_back({"jpg", false, false, megapixels});
+    specs.push_back({"jpg", false, true, megapixels});
+    specs.push_back({"png", false, false, megapixels});
+    specs.push_back({"png", true, false, megapixels});
+  }
+  return specs;
+}
+
+// Gradients, a block pattern and a little seeded noise: compresses like a
+// photo far more than a flat fill would, and is identical on every run.
+QImage Render(CorpusImage const& spec) {
+  const int width = std::lround(std::sqrt(spec.megapixels * 1.5e6));
+  const int height = width * 2 / 3;
+  QImage image(width, height,
+               spec.alpha ? QImage::Format_ARGB32 : QImage::Format_RGB32);
+  std::mt19937 rng(spec.megapixels);
+  for (int y = 0; y < height; ++y) {
+    auto* line = reinterpret_cast<QRgb*>(image.scanLine(y));
+    for (int x = 0; x < width; ++x) {
+      const int noise = rng() & 0x0f;
+      const int alpha = spec.alpha ? 128 + ((x + y) & 0x7f) : 255;
+      line[x] = qRgba((x * 255 / width) ^ noise, y * 255 / height,
+                      ((x / 16) ^ (y / 16)) & 0xff, alpha);
+    }
+  }
+  return image;
+}
+
+QString CorpusDirectory() {
+  static const QString directory = [] {
+    const QString requested = qEnvironmentVariable("PVIEWER_BENCH_CORPUS");
+    if (!requested.isEmpty() && QDir().mkpath(requested)) return requested;
+    static QTemporaryDir temporary;
+    return temporary.path();
+  }();
+  return directory;
+}
+
+// Path of the corpus file for `spec`, written on first request. Every thread
+// of a multi-threaded benchmark asks for it at once, hence the lock.
+QString CorpusFile(CorpusImage const& spec) {
+  static std::mutex mutex;
+  std::lock_guard<std::mutex> lock(mutex);
+  const QString path = QDir(CorpusDirectory()).filePath(spec.FileName());
+  if (QFileInfo::exists(path)) return path;
+  QImageWriter writer(path, spec.format);
+  writer.setQuality(90);
+  writer.setProgressiveScanWrite(spec.progressive);
+  if (!writer.write(Render(spec))) return {};
+  return path;
+}
+
+// Per-iteration wall time, reported as percentiles next to the mean that
+// Google Benchmark prints; averaged over threads in multi-threaded runs.
+class Latencies {
+ public:
+  template <typename Function>
+  void Measure(Function&& function) {
+    const auto start = std::chrono::steady_clock::now();
+    function();
+    samples_.push_back(std::chrono::duration<double, std::milli>(
+                           std::chrono::steady_clock::now() - start)
+                           .count());
+  }
+  void Report(benchmark::State& state) {
+    if (samples_.empty()) return;
+    std::sort(samples_.begin(), samples_.end());
+    auto percentile = [&](double p) {
+      const std::size_t at = std::ceil(p * samples_.size()) - 1;
+      return benchmark::Counter(samples_[std::min(at, samples_.size() - 1)],
+                                benchmark::Counter::kAvgThreads);
+    };
+    state.counters["p50_ms"] = percentile(0.50);
+    state.counters["p99_ms"] = percentile(0.99);
+    state.counters["max_ms"] = percentile(1.0);
+  }
+
+ private:
+  std::vector<double> samples_;
+};
+
+void ReportThroughput(benchmark::State& state, CorpusImage const& spec) {
+  state.SetItemsProcessed(state.iterations());
+  state.counters["MP/s"] =
+      benchmark::Counter(double(spec.megapixels) * state.iterations(),
+                         benchmark::Counter::kIsRate);
+}
+
+void FullDecode(benchmark::State& state, CorpusImage spec) {
+  const QString path = CorpusFile(spec);
+  if (path.isEmpty()) {
+    state.SkipWithError("corpus file not written");
+    return;
+  }
+  Latencies latencies;
+  for (auto _ : state)
+    latencies.Measure([&] { benchmark::DoNotOptimize(QImage(path)); });
+  latencies.Report(state);
+  ReportThroughput(state, spec);
+}
+
+// Decoding straight to screen size; the JPEG plugin scales in the DCT.
+void ScaledDecode(benchmark::State& state, CorpusImage spec) {
+  const QString path = CorpusFile(spec);
+  if (path.isEmpty()) {
+    state.SkipWithError("corpus file not written");
+    return;
+  }
+  Latencies latencies;
+  for (auto _ : state) {
+    latencies.Measure([&] {
+      QImageReader reader(path);
+      reader.setScaledSize(
+          reader.size().scaled(1920, 1080, Qt::KeepAspectRatio));
+      benchmark::DoNotOptimize(reader.read());
+    });
+  }
+  latencies.Report(state);
+  ReportThroughput(state, spec);
+}
+
+void FormatConversion(benchmark::State& state, CorpusImage spec) {
+  const QImage decoded(CorpusFile(spec));
+  if (decoded.isNull()) {
+    state.SkipWithError("corpus file not decoded");
+    return;
+  }
+  Latencies latencies;
+  for (auto _ : state) {
+    latencies.Measure([&] {
+      benchmark::DoNotOptimize(
+          decoded.convertToFormat(QImage::Format_ARGB32_Premultiplied));
+    });
+  }
+  latencies.Report(state);
+  ReportThroughput(state, spec);
+}
+
+// Single-threaded on purpose: pixmaps may only be created on the GUI thread,
+// which is where CachedImagesList::Materialize runs.
+void FromImage(benchmark::State& state, CorpusImage spec) {
+  const QImage decoded(CorpusFile(spec));
+  if (decoded.isNull()) {
+    state.SkipWithError("corpus file not decoded");
+    return;
+  }
+  Latencies latencies;
+  for (auto _ : state) {
+    latencies.Measure(
+        [&] { benchmark::DoNotOptimize(QPixmap::fromImage(decoded)); });
+  }
+  latencies.Report(state);
+  ReportThroughput(state, spec);
+}
+
+// A batch of decodes through DecodeQueue with `range(0)` workers: Submit()
+// everything, then Result() in order, as a window refill does.
+void QueuedDecode(benchmark::State& state, CorpusImage spec) {
+  constexpr int kBatch = 16;
+  const QString path = CorpusFile(spec);
+  if (path.isEmpty()) {
+    state.SkipWithError("corpus file not written");
+    return;
+  }
+  DecodeQueue decoder(state.range(0));
+  Latencies latencies;
+  for (auto _ : state) {
+    latencies.Measure([&] {
+      std::vector<decode_task_t> tasks;
+      for (int i = 0; i < kBatch; ++i) tasks.push_back(decoder.Submit(path));
+      for (decode_task_t const& task : tasks)
+        benchmark::DoNotOptimize(decoder.Result(task));
+    });
+    // Lets the batched taskFinished() call run, as the GUI event loop would.
+    state.PauseTiming();
+    QCoreApplication::processEvents();
+    state.ResumeTiming();
+  }
+  latencies.Report(state);
+  state.SetItemsProcessed(state.iterations() * kBatch);
+  state.counters["MP/s"] =
+      benchmark::Counter(double(spec.megapixels) * kBatch * state.iterations(),
+                         benchmark::Counter::kIsRate);
+}
+
+[[maybe_unused]] const bool registered = [] {
+  const int threads = std::max(1u, std::thread::hardware_concurrency());
+  for (CorpusImage const& spec : CorpusSpecs()) {
+    const std::string name = spec.Name();
+    benchmark::RegisterBenchmark(("BM_FullDecode/" + name).c_str(), FullDecode,
+                                 spec)
+        ->ThreadRange(1, threads)
+        ->UseRealTime()
+        ->Unit(benchmark::kMillisecond);
+    benchmark::RegisterBenchmark(("BM_ScaledDecode/" + name).c_str(),
+                                 ScaledDecode, spec)
+        ->ThreadRange(1, threads)
+        ->UseRealTime()
+        ->Unit(benchmark::kMillisecond);
+    benchmark::RegisterBenchmark(("BM_FormatConversion/" + name).c_str(),
+                                 FormatConversion, spec)
+        ->ThreadRange(1, threads)
+        ->UseRealTime()
+        ->Unit(benchmark::kMillisecond);
+    benchmark::RegisterBenchmark(("BM_FromImage/" + name).c_str(), FromImage,
+                                 spec)
+        ->UseRealTime()
+        ->Unit(benchmark::kMillisecond);
+  }
+  for (CorpusImage const& spec : CorpusSpecs()) {
+    if (spec.megapixels != 12) continue;
+    benchmark::RegisterBenchmark(("BM_QueuedDecode/" + spec.Name()).c_str(),
+                                 QueuedDecode, spec)
+        ->ArgName("workers")
+        ->RangeMultiplier(2)
+        ->Range(1, threads)
+        ->UseRealTime()
+        ->Unit(benchmark::kMillisecond);
+  }
+  return true;
+}();
+
+}  // namespace
@@ -0,0 +1,125 @@
+#include <benchmark/benchmark.h>
+
+#include <memory>
+#include <random>
+#include <vector>
+
+#include "cache-builder.hpp"
+#include "images_navigator.hpp"
+
+/*
+ * Cost of the cache-windowing algorithm, measured on the same fakes the tests
+ * use, so only the bookkeeping is timed and not any decoding. Every benchmark
+ * is parameterized by (list size, cache capacity): the window should make a
+ * single step independent of the list size, and a jump linear in capacity.
+ */
+
+namespace {
+
+using move_t = ImagesNavigator<info_test_t, image_test_t>;
+using NextImage = ImageBase<NumericalOrder, info_test_t, image_test_t>;
+using PreviousImage = ImageBase<ReverseOrder, info_test_t, image_test_t>;
+using ImageNumber = ImageNumberImpl<info_test_t, image_test_t>;
+using RemoveImage = RemoveImageImpl<info_test_t, image_test_t>;
+using InsertImage = InsertImageImpl<info_test_t, image_test_t>;
+
+struct System {
+  std::shared_ptr<FakeImagePathList> images;
+  std::shared_ptr<FakeCachedImageList> cache;
+  std::unique_ptr<move_t> move;
+};
+
+// Mirrors ViewerFixture::Configure: list of `n` images, cache of `capacity`,
+// initial fill centered on index 0.
+System Build(int n, int capacity) {
+  System s;
+  s.images = FakeImagePathList::Construct(n);
+  s.images->CreateTaskQueue<FakeTaskQueue>(capacity);
+  FakeImagePathList::InitialImageTask(*s.images, s.images->TaskQueueObject());
+  s.cache =
+      s.images->CreateCacheObject<FakeCachedImageList>(capacity, *s.images);
+  s.move = std::make_unique<move_t>(s.images, s.cache, nullptr,
+                                    s.cache->GetIsImageNullFunctor());
+  s.images->CacheImage();
+  return s;
+}
+
+// Deterministic 1-based jump targets, so runs are comparable between builds.
+std::vector<int> JumpTargets(int n) {
+  std::mt19937 rng(n);
+  std::uniform_int_distribution<int> position(1, n);
+  std::vector<int> targets(1024);
+  for (int& target : targets) target = position(rng);
+  return targets;
+}
+
+void ListSizesAndCapacities(benchmark::internal::Benchmark* b) {
+  b->ArgNames({"images", "capacity"})
+      ->ArgsProduct({{100, 10'000, 1'000'000}, {3, 10, 40}});
+}
+
+}  // namespace
+
+// One Next/Previous step, bouncing between both ends of the list so the
+// window keeps sliding instead of parking at a border.
+static void BM_ImageBaseStep(benchmark::State& state) {
+  const int n = state.range(0);
+  System s = Build(n, state.range(1));
+  int direction = 1;
+  for (auto _ : state) {
+    const int pos = s.images->Pos();
+    if (pos == n - 1) direction = -1;
+    if (pos == 0) direction = 1;
+    benchmark::DoNotOptimize(direction > 0 ? s.move->moveTo<NextImage>()
+                                           : s.move->moveTo<PreviousImage>());
+    s.cache->displaying_test_result.clear();
+  }
+  state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_ImageBaseStep)->Apply(ListSizesAndCapacities);
+
+// A jump to an arbitrary image: drops the window and refills it around the
+// target.
+static void BM_ImageNumberJump(benchmark::State& state) {
+  System s = Build(state.range(0), state.range(1));
+  const std::vector<int> targets = JumpTargets(state.range(0));
+  std::size_t next = 0;
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(
+        s.move->moveTo<ImageNumber>(targets[next++ % targets.size()]));
+    s.cache->displaying_test_result.clear();
+  }
+  state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_ImageNumberJump)->Apply(ListSizesAndCapacities);
+
+// Planning the initial fill, then draining the plan the way the cache does.
+static void BM_InitialImageTask(benchmark::State& state) {
+  auto images = FakeImagePathList::Construct(state.range(0));
+  images->setIndex(state.range(0) / 2);
+  images->CreateTaskQueue<FakeTaskQueue>(state.range(1));
+  auto& queue = images->TaskQueueObject();
+  for (auto _ : state) {
+    FakeImagePathList::InitialImageTask(*images, queue);
+    while (!queue.Empty()) benchmark::DoNotOptimize(queue.Next());
+  }
+  state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_InitialImageTask)->Apply(ListSizesAndCapacities);
+
+// Removing the image right after the current one and putting it back: both
+// edits land inside the window, which is patched in place.
+static void BM_WindowEdit(benchmark::State& state) {
+  const int n = state.range(0);
+  System s = Build(n, state.range(1));
+  s.move->moveTo<ImageNumber>(n / 2);
+  const int position = s.images->Pos() + 1;
+  for (auto _ : state) {
+    const info_test_t value = s.images->file_info_.at(position);
+    s.move->moveTo<RemoveImage>(position);
+    s.move->moveTo<InsertImage>(position, value);
+    s.cache->displaying_test_result.clear();
+  }
+  state.SetItemsProcessed(2 * state.iterations());
+}
+BENCHMARK(BM_WindowEdit)->Apply(ListSizesAndCapacities);
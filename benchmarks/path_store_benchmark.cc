@@ -0,0 +1,82 @@
+#include <benchmark/benchmark.h>
+
+#include <QString>
+#include <QVector>
+
+#include "path_store.hpp"
+
+/*
+ * PathStore holds every path the viewer lists, so its footprint and intern
+ * rate bound how large a folder can get. The lists are shaped like a photo
+ * library: a handful of directories, many similar file names. Each run
+ * reports the store's own bytes per path next to what the same paths cost
+ * as QStrings (object, header and UTF-16 payload, before allocator overhead).
+ */
+
+namespace {
+
+QVector<QString> Paths(int n) {
+  QVector<QString> paths;
+  paths.reserve(n);
+  for (int i = 0; i != n; ++i)
+    paths.push_back(QString("/photos/dir_%1/IMG_%2.jpg")
+                        .arg(i % 10)
+                        .arg(i, 7, 10, QLatin1Char('0')));
+  return paths;
+}
+
+double QStringBytes(QVector<QString> const& paths) {
+  double bytes = 0;
+  for (QString const& path : paths)
+    bytes += sizeof(QString) + sizeof(QArrayData) +
+             (path.capacity() + 1) * sizeof(QChar);
+  return bytes;
+}
+
+void ListSizes(benchmark::internal::Benchmark* b) {
+  b->ArgName("paths")->RangeMultiplier(10)->Range(10'000, 1'000'000);
+  b->Unit(benchmark::kMillisecond);
+}
+
+}  // namespace
+
+// Interning a whole folder listing into an empty store.
+static void BM_PathStoreIntern(benchmark::State& state) {
+  const QVector<QString> paths = Paths(state.range(0));
+  qint64 bytes = 0;
+  for (auto _ : state) {
+    PathStore store;
+    benchmark::DoNotOptimize(store.Intern(paths));
+    bytes = store.MemoryBytes();
+  }
+  state.SetItemsProcessed(state.iterations() * paths.size());
+  state.counters["bytes_per_path"] = double(bytes) / paths.size();
+  state.counters["qstring_bytes_per_path"] =
+      QStringBytes(paths) / paths.size();
+}
+BENCHMARK(BM_PathStoreIntern)->Apply(ListSizes);
+
+// Looking up paths that are all known, as RowOf(QString) does.
+static void BM_PathStoreFind(benchmark::State& state) {
+  const QVector<QString> paths = Paths(state.range(0));
+  PathStore store;
+  store.Intern(paths);
+  for (auto _ : state) {
+    for (QString const& path : paths)
+      benchmark::DoNotOptimize(store.Find(path));
+  }
+  state.SetItemsProcessed(state.iterations() * paths.size());
+}
+BENCHMARK(BM_PathStoreFind)->Apply(ListSizes);
+
+// Resolving every id back to a QString, as the panel does when it lists them.
+static void BM_PathStorePath(benchmark::State& state) {
+  const QVector<QString> paths = Paths(state.range(0));
+  PathStore store;
+  const QVector<PathId> ids = store.Intern(paths);
+  for (auto _ : state) {
+    for (PathId id : ids) benchmark::DoNotOptimize(store.Path(id));
+  }
+  state.SetItemsProcessed(state.iterations() * ids.size());
+}
+BENCHMARK(BM_PathStorePath)->Apply(ListSizes);
@@ -0,0 +1,48 @@
+#include <benchmark/benchmark.h>
+
+#include <QVector>
+#include <optional>
+#include <random>
+
+#include "duplicate_finder.hpp"
+#include "perceptual_hash.hpp"
+
+/*
+ * Looking for near-duplicates clusters every hash of the list at once, so
+ * its cost grows with the folder. The hashes come in bursts, as a camera
+ * takes them: runs of a few shots whose hashes differ in a handful of bits.
+ */
+
+namespace {
+
+QVector<std::optional<quint64>> Bursts(int count) {
+  std::mt19937_64 random(count);
+  QVector<std::optional<quint64>> hashes;
+  hashes.reserve(count);
+  quint64 base = random();
+  for (int i = 0; i < count; ++i) {
+    if (random() % 8 == 0) base = random();
+    quint64 hash = base;
+    for (int flips = random() % 12; flips > 0; --flips)
+      hash ^= 1ull << (random() % 64);
+    hashes.append(hash);
+  }
+  return hashes;
+}
+
+}  // namespace
+
+// Arguments: the number of hashes.
+static void BM_NearDuplicateClusters(benchmark::State& state) {
+  const QVector<std::optional<quint64>> hashes = Bursts(int(state.range(0)));
+  for (auto _ : state)
+    benchmark::DoNotOptimize(
+        NearDuplicateClusters(hashes, DuplicateFinder::kMaxDistance));
+  state.SetItemsProcessed(state.iterations() * hashes.size());
+}
+BENCHMARK(BM_NearDuplicateClusters)
+    ->ArgName("hashes")
+    ->Arg(10'000)
+    ->Arg(30'000)
+    ->Arg(100'000)
+    ->Unit(benchmark::kMillisecond);
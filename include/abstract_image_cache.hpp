@@ -22,7 +22,7 @@ namespace Abstract {
 template <typename In, typename Im>
 class ImageCache : public QObject {
  protected:
-  using info_t = typename QVector<In>::iterator;
+  using info_t = ListHandle<QVector<In>>;
   using pointer_t = void (QList<Im>::*)(const Im&);
   using queue_t = Abstract::TaskQueue<In, Im>;
 
@@ -60,9 +60,23 @@ class ImageCache : public QObject {
       direction > 0 ? ++info_cached_left_ : --info_cached_right_;
     }
   }
+  // Re-points the window edges after the location list has been edited in
+  // place (the old iterators may have been invalidated by the edit).
+  void SetEdges(info_t left, info_t right) {
+    info_cached_left_ = left;
+    info_cached_right_ = right;
+  }
+  std::size_t Capacity() const { return capacity_; }
+  virtual std::size_t Size() const = 0;
+
   virtual void PopFront() = 0;
   virtual void PopBack() = 0;
   virtual void Push(pointer_t, info_t) = 0;
+  // Slot-level edits used by the in-place list edits (see WindowEdit in
+  // images_navigator.hpp). `slot` is relative to the left edge of the window.
+  virtual void RemoveSlot(int slot) = 0;
+  virtual void InsertSlot(int slot, info_t) = 0;
+  virtual void MoveSlot(int from, int to) = 0;
 
   virtual void DisplayImage() = 0;
   virtual void HideImage() = 0;
@@ -86,7 +100,6 @@ class ImageCache : public QObject {
     int result = (capacity % 2 == 0) ? (capacity - 1) / 2 : capacity / 2;
     return result > 0 ? result : 1;
   }
-  virtual std::size_t Size() const = 0;
   std::size_t capacity_;
   const int distance_threshold_;
   info_t const& current_image_iterator_;  // pointer to displayed image
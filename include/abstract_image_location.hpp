@@ -4,6 +4,7 @@
 #include <memory>
 
 #include "cached_images_list.hpp"
+#include "path_store.hpp"
 
 namespace Abstract {
 
@@ -21,8 +22,8 @@ class ImageLocation : public QObject {
   using image_storage_t = QList<Ts...>;
 
   using task_queue_t = TaskQueue<In, Im>;
-  using info_t = typename info_storage_t<In>::iterator;
-  using const_info_t = typename info_storage_t<In>::const_iterator;
+  using info_t = ListHandle<info_storage_t<In>>;
+  using const_info_t = ListHandle<const info_storage_t<In>>;
   using pointer_t = void (image_storage_t<Im>::*)(const Im &);
   static constexpr pointer_t Back = &image_storage_t<Im>::push_back;
   static constexpr pointer_t Front = &image_storage_t<Im>::push_front;
@@ -49,6 +50,11 @@ class ImageLocation : public QObject {
   info_t Index() { return index_; }
   const_info_t Index() const { return index_; }
   void setIndex(int value) { index_ = std::next(Begin(), value); }
+  // In-place list edits. Each keeps index_ on the same image it pointed to
+  // before the edit (or on its successor, if that image is the one removed).
+  void RemoveItem(int position);
+  void InsertItem(int position, In value);
+  void MoveItem(int from, int to);
   bool ImageHideNeeded(int direction) {
     bool from_begin = index_ == Begin() && direction < 0;
     bool from_end = index_ == std::prev(End()) && direction > 0;
@@ -97,6 +103,10 @@ class ImageLocation : public QObject {
 
  private:
   virtual const_info_t CBegin() const = 0;
+  // Container primitives behind RemoveItem / InsertItem / MoveItem. They may
+  // invalidate every iterator into the list; the callers rebind index_.
+  virtual In TakeAt(int position) = 0;
+  virtual void InsertAt(int position, In value) = 0;
   std::unique_ptr<task_queue_t> task_queue_;
   info_t index_;
 };
@@ -111,6 +121,35 @@ void ImageLocation<In, Im>::MoveIndex(int direction) {
 template <typename In, typename Im>
 inline ImageLocation<In, Im>::ImageLocation(info_t value) : index_(value) {}
 
+template <typename In, typename Im>
+void ImageLocation<In, Im>::RemoveItem(int position) {
+  int current = Pos();
+  TakeAt(position);
+  if (position < current || current >= size()) --current;
+  setIndex(current);
+}
+
+template <typename In, typename Im>
+void ImageLocation<In, Im>::InsertItem(int position, In value) {
+  int current = Pos();
+  InsertAt(position, std::move(value));
+  if (position <= current) ++current;
+  setIndex(current);
+}
+
+template <typename In, typename Im>
+void ImageLocation<In, Im>::MoveItem(int from, int to) {
+  int current = Pos();
+  InsertAt(to, TakeAt(from));
+  if (current == from)
+    current = to;
+  else if (from < current && current <= to)
+    --current;
+  else if (to <= current && current < from)
+    ++current;
+  setIndex(current);
+}
+
 template <typename In, typename Im>
 template <typename Order>
 bool ImageLocation<In, Im>::initialState() {
@@ -131,31 +170,45 @@ bool ImageLocation<In, Im>::lastIsPointed() {
 
 }  // namespace Abstract
 
-class CPathBase : public Abstract::ImageLocation<QString, QPixmap> {
+// Paths are held as ids into PathStore::Shared().
+class CPathBase : public Abstract::ImageLocation<PathId, QPixmap> {
  public:
-  CPathBase(int value, info_storage_t<QString> container = {})
-      : ImageLocation(std::next(container.begin(), value)),
+  CPathBase(int value, info_storage_t<PathId> container = {})
+      : ImageLocation(info_t(&container_, value)),
         container_(std::move(container)) {}
-  QString const &pathByIndex() const;
-  void setNewList(info_storage_t<QString>);
-  void appendItem(QString path);
+  QString pathByIndex() const;
+  void setNewList(info_storage_t<PathId>);
+  void setNewList(info_storage_t<QString> const &paths) {
+    setNewList(PathStore::Shared().Intern(paths));
+  }
+  void appendItem(QString const &path);
   void clear() { container_.clear(); }
   bool isEmpty() const final { return container_.isEmpty(); }
   int size() const override { return container_.size(); }
 
-  info_t Begin() override { return container_.begin(); }
-  info_t End() override { return container_.end(); }
-  const_info_t CBegin() const override { return container_.cbegin(); }
+  info_t Begin() override { return info_t(&container_, 0); }
+  info_t End() override { return info_t(&container_, container_.size()); }
+  const_info_t CBegin() const override { return const_info_t(&container_, 0); }
 
  private:
-  info_storage_t<QString> container_;
+  PathId TakeAt(int position) override { return container_.takeAt(position); }
+  void InsertAt(int position, PathId id) override {
+    container_.insert(position, id);
+  }
+  info_storage_t<PathId> container_;
 };
 
-inline QString const &CPathBase::pathByIndex() const { return *Index(); }
+inline QString CPathBase::pathByIndex() const {
+  return PathStore::Shared().Path(*Index());
+}
 
-inline void CPathBase::setNewList(info_storage_t<QString> list) {
+inline void CPathBase::setNewList(info_storage_t<PathId> list) {
   container_ = std::move(list);
   ImageLocation::setIndex(0);
 }
 
-inline void CPathBase::appendItem(QString path) { container_.append(path); }
\ No newline at end of file
+// Handles address the list by index, so appending never invalidates the cache
+// window; the window only grows into new items via InsertImageImpl.
+inline void CPathBase::appendItem(QString const &path) {
+  container_.append(PathStore::Shared().Intern(path));
+}
\ No newline at end of file
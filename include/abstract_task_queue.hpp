@@ -3,12 +3,14 @@
 #include <QList>
 #include <QVector>
 
+#include "list_handle.hpp"
+
 namespace Abstract {
 
 template<typename In, typename Im>
 class TaskQueue {
 protected:
-  using info_t = typename QVector<In>::iterator;
+  using info_t = ListHandle<QVector<In>>;
   using pointer_t = void(QList<Im>::*)(const Im&);
 public:
   TaskQueue(const int initial_task_size): initial_task_size_(initial_task_size) { }
@@ -1,37 +1,64 @@
 #pragma once
 
+#include <QElapsedTimer>
 #include <QKeyEvent>
 #include <QObject>
 #include <QScrollBar>
 #include <QTimer>
 
+/*
+ * Scrolls while arrow keys are held, one step per display frame. A step
+ * covers the distance the current speed gives for the time since the last
+ * one, so motion stays even however late a tick runs, and the speed ramps
+ * up along a Profile the longer keys are held. The timer runs only while a
+ * key is held: an idle viewer gets no wakeups from here.
+ */
 class ArrowKeysScroller : public QObject {
   Q_OBJECT
- private:
-  struct Param {
-    std::function<void()> func;
-    bool pressed;
-    Param(std::function<void()> f) : func(f), pressed(false) {}
+ public:
+  enum class Curve { Constant, Linear, EaseIn };
+
+  struct Profile {
+    double initial_speed = 800;  // pixels per second
+    double max_speed = 3200;
+    double ramp_ms = 1200;  // from initial_speed to max_speed
+    Curve curve = Curve::EaseIn;
   };
 
- public:
   static bool isNoModifier(const QKeyEvent* const event);
   static bool isArrowKeys(const QKeyEvent* const event);
+  // Pixels per second once keys have been held for `held_ms`.
+  static double Speed(Profile const& profile, double held_ms);
 
-  ArrowKeysScroller(QScrollBar* h, QScrollBar* v);
+  ArrowKeysScroller(QScrollBar* h, QScrollBar* v,
+                    Profile profile = Profile());
   void setKeyState(QKeyEvent* event);
+  // Lets go of every key, for when their releases will never arrive, e.g.
+  // after the window lost focus.
+  void releaseAll();
+  bool isScrolling() const { return timer_.isActive(); }
+
+ signals:
+  // Emitted on every step taken while an arrow key is held.
+  void scrolled();
 
  private:
-  static int increment(int a, int b);
-  static int decrement(int a, int b);
+  enum Direction { Up, Down, Left, Right, kDirections };
 
-  static void scroll(std::function<int(int, int)> op,
-                     int (QAbstractSlider::*f)() const,
-                     QAbstractSlider* slider);
+  // Time between two frames of the screen the scroll bars are on.
+  int FrameIntervalMs() const;
   void Scroll();
+  // Moves `bar` by the whole pixels of `distance` plus what is left over
+  // from earlier steps in `remainder`, and keeps the new fraction there.
+  static void Step(QScrollBar* bar, double distance, double* remainder);
 
-  std::map<Qt::Key, Param> k;
-  QTimer timer;
+  const Profile profile_;
   QScrollBar* horizontal_;
   QScrollBar* vertical_;
-};
\ No newline at end of file
+  bool held_[kDirections] = {};
+  QElapsedTimer held_for_;   // since the first of the held keys went down
+  QElapsedTimer last_step_;
+  double remainder_x_ = 0;
+  double remainder_y_ = 0;
+  QTimer timer_;
+};
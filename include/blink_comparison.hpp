@@ -0,0 +1,45 @@
+#pragma once
+
+#include <QGraphicsPixmapItem>
+#include <QObject>
+#include <QPixmap>
+#include <QTimer>
+
+/*
+ * Blink comparison: a pinned partner image is laid over the displayed one
+ * and shown and hidden in turn, on a timer or while a key is held. The
+ * partner is an already converted pixmap in its own item, a child of the
+ * displayed image's item, scaled to cover it. Switching only flips that
+ * item's visibility: no decode, no change to the scene rect, the zoom or
+ * the scroll position. While blinking, both items cache their rendering in
+ * device coordinates, so every switch after the first is a plain blit.
+ */
+class BlinkComparison : public QObject {
+  Q_OBJECT
+ public:
+  static constexpr int kIntervalMs = 250;
+
+  // `base` is the item of the displayed image; it must outlive this.
+  explicit BlinkComparison(QGraphicsPixmapItem* base,
+                           QObject* parent = nullptr);
+
+  void Pin(QPixmap partner);
+  bool HasPartner() const { return !partner_->pixmap().isNull(); }
+  // Alternates the displayed image and the partner every kIntervalMs.
+  void Start();
+  void Stop();
+  bool IsRunning() const { return timer_.isActive(); }
+  void ShowPartner(bool shown);
+  bool IsPartnerShown() const { return partner_->isVisible(); }
+  // Fits the partner to a new displayed image, or stops if there is none.
+  void BaseChanged();
+  // Filters the displayed image and the partner alike.
+  void SetTransformationMode(Qt::TransformationMode mode);
+
+ private:
+  void SetCaching(bool caching);
+
+  QGraphicsPixmapItem* base_;
+  QGraphicsPixmapItem* partner_;  // owned by base_
+  QTimer timer_;
+};
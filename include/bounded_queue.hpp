@@ -0,0 +1,99 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <memory>
+#include <optional>
+#include <utility>
+
+/*
+ * Fixed-capacity lock-free FIFO that any number of threads may push to and pop
+ * from concurrently (Vyukov's bounded MPMC ring). Every cell carries a sequence
+ * number telling producers and consumers whose turn it is, so neither side
+ * ever takes a lock or waits: TryPush fails when the ring is full and TryPop
+ * when it is empty, and the caller decides what to do about it.
+ */
+template <typename T>
+class BoundedQueue {
+ public:
+  // The capacity is rounded up to a power of two.
+  explicit BoundedQueue(std::size_t capacity);
+  BoundedQueue(BoundedQueue const&) = delete;
+  BoundedQueue& operator=(BoundedQueue const&) = delete;
+
+  bool TryPush(T value);
+  std::optional<T> TryPop();
+  std::size_t Capacity() const { return mask_ + 1; }
+
+ private:
+  struct Cell {
+    std::atomic<std::size_t> sequence;
+    T value;
+  };
+  static std::size_t RoundUp(std::size_t capacity) {
+    std::size_t result = 2;
+    while (result < capacity) result <<= 1;
+    return result;
+  }
+
+  const std::size_t mask_;
+  std::unique_ptr<Cell[]> cells_;
+  // Kept on separate cache lines: producers and consumers hammer different
+  // counters and should not invalidate each other's line.
+  alignas(64) std::atomic<std::size_t> enqueue_pos_{0};
+  alignas(64) std::atomic<std::size_t> dequeue_pos_{0};
+};
+
+template <typename T>
+BoundedQueue<T>::BoundedQueue(std::size_t capacity)
+    : mask_(RoundUp(capacity) - 1), cells_(new Cell[mask_ + 1]) {
+  for (std::size_t i = 0; i <= mask_; ++i)
+    cells_[i].sequence.store(i, std::memory_order_relaxed);
+}
+
+template <typename T>
+bool BoundedQueue<T>::TryPush(T value) {
+  std::size_t pos = enqueue_pos_.load(std::memory_order_relaxed);
+  for (;;) {
+    Cell& cell = cells_[pos & mask_];
+    const std::size_t sequence = cell.sequence.load(std::memory_order_acquire);
+    const auto diff = static_cast<std::ptrdiff_t>(sequence) -
+                      static_cast<std::ptrdiff_t>(pos);
+    if (diff == 0) {
+      if (enqueue_pos_.compare_exchange_weak(pos, pos + 1,
+                                             std::memory_order_relaxed)) {
+        cell.value = std::move(value);
+        cell.sequence.store(pos + 1, std::memory_order_release);
+        return true;
+      }
+    } else if (diff < 0) {
+      return false;  // full
+    } else {
+      pos = enqueue_pos_.load(std::memory_order_relaxed);
+    }
+  }
+}
+
+template <typename T>
+std::optional<T> BoundedQueue<T>::TryPop() {
+  std::size_t pos = dequeue_pos_.load(std::memory_order_relaxed);
+  for (;;) {
+    Cell& cell = cells_[pos & mask_];
+    const std::size_t sequence = cell.sequence.load(std::memory_order_acquire);
+    const auto diff = static_cast<std::ptrdiff_t>(sequence) -
+                      static_cast<std::ptrdiff_t>(pos + 1);
+    if (diff == 0) {
+      if (dequeue_pos_.compare_exchange_weak(pos, pos + 1,
+                                             std::memory_order_relaxed)) {
+        std::optional<T> value(std::move(cell.value));
+        cell.value = T{};
+        cell.sequence.store(pos + mask_ + 1, std::memory_order_release);
+        return value;
+      }
+    } else if (diff < 0) {
+      return std::nullopt;  // empty
+    } else {
+      pos = dequeue_pos_.load(std::memory_order_relaxed);
+    }
+  }
+}
@@ -1,22 +1,43 @@
 #pragma once
 
 #include <QCoreApplication>
-#include <QDebug>
-#include <QFuture>
+#include <QElapsedTimer>
+#include <QHash>
 #include <QImage>
 #include <QObject>
 #include <QPainter>
-#include <QtConcurrent>
+#include <QTimer>
+#include <chrono>
+#include <functional>
+#include <optional>
 
 #include "abstract_image_cache.hpp"
 #include "abstract_image_location.hpp"
+#include "decode_queue.hpp"
+#include "path_store.hpp"
+#include "performance_stats.hpp"
+#include "trace.hpp"
 
 using update_image_t = std::function<void(QPixmap const&)>;
 
 // Zoom and scaling now live entirely in the view layer (MainWindow / QGraphicsView).
 // CachedImagesList is responsible only for: async decode, cache eviction, and
 // handing source pixmaps to the view via the update_image callback.
-class CachedImagesList : public Abstract::ImageCache<QString, QPixmap> {
+// Decoding runs on the DecodeQueue workers; finished frames are turned into
+// pixmaps as soon as they arrive, so displaying a slot rarely has to wait.
+// Slots hold frames fitted to the frame target rather than full images. When
+// the target changes, only the displayed slot is re-targeted right away (in
+// the background, showing the old frame meanwhile); the others follow as they
+// are displayed.
+// DisplayImage() never blocks: a slot still being decoded is presented when
+// its decode completes, unless a later DisplayImage() or HideImage() has
+// superseded it by then. Frames are presented at most once per display frame,
+// so steps that outrun the screen (key repeat) only show where they end up,
+// and a skipped slot's decode yields to those of the slots still ahead.
+// The finished part of a window dropped by Clear() is kept while the next
+// window is built, so that a new list sharing images with the old one starts
+// warm; a worker then checks that their files did not change meanwhile.
+class CachedImagesList : public Abstract::ImageCache<PathId, QPixmap> {
  public:
   CachedImagesList(std::size_t capacity, info_t const&, update_image_t);
   bool isEmpty() const override { return source_.isEmpty(); }
@@ -26,25 +47,33 @@ class CachedImagesList : public Abstract::ImageCache<QString, QPixmap> {
 
   void PopFront() override {
     source_.pop_front();
-    pending_.pop_front();
+    pending_.takeFirst()->Cancel();
   }
   void PopBack() override {
     source_.pop_back();
-    pending_.pop_back();
+    pending_.takeLast()->Cancel();
   }
   std::size_t Size() const override { return source_.size(); }
   void Push(pointer_t op, info_t value) override {
     constexpr pointer_t push_front_op = &QList<QPixmap>::push_front;
-    const QString path = *value;
-    qDebug() << "-- Caching (async)" << path;
-    QFuture<QImage> future = QtConcurrent::run([path] {
-      QImage image(path);
-      if (image.isNull()) qWarning() << "Failed to load image:" << path;
-      return image;
-    });
-    (source_.*op)(QPixmap{});
-    op == push_front_op ? pending_.push_front(future)
-                        : pending_.push_back(future);
+    QPixmap pixmap;
+    decode_task_t task = Submit(PathStore::Shared().Path(*value), &pixmap);
+    (source_.*op)(pixmap);
+    op == push_front_op ? pending_.push_front(task) : pending_.push_back(task);
+  }
+  void RemoveSlot(int slot) override {
+    source_.removeAt(slot);
+    pending_.takeAt(slot)->Cancel();
+  }
+  void InsertSlot(int slot, info_t value) override {
+    QPixmap pixmap;
+    decode_task_t task = Submit(PathStore::Shared().Path(*value), &pixmap);
+    source_.insert(slot, pixmap);
+    pending_.insert(slot, std::move(task));
+  }
+  void MoveSlot(int from, int to) override {
+    source_.move(from, to);
+    pending_.move(from, to);
   }
   void SetScrollCallbacks(std::function<void()> save,
                           std::function<void()> restore,
@@ -53,11 +82,85 @@ class CachedImagesList : public Abstract::ImageCache<QString, QPixmap> {
     restore_scroll_position_ = restore;
     can_save_scroll_position_ = can_save;
   }
+  CacheStats Stats() const;
+  // Sets the frame target (device pixels, see frame_target.hpp) that slots
+  // are prepared for.
+  void SetFrameTarget(QSize target);
+  // The pixmap of the slot `offset` places from the displayed one, if that
+  // image is decoded; never waits for a decode. `path` receives the slot's
+  // image, or is cleared if the slot is outside the window.
+  QPixmap SlotPixmap(int offset, QString* path = nullptr);
+  // Whether displaying the slot `offset` places from the displayed one would
+  // find its pixmap ready; also true outside the window, where there is
+  // nothing to wait for. If not, makes sure a worker is on it.
+  bool PrepareSlot(int offset);
+  // Called on the GUI thread whenever a slot's pixmap, or the statistics of
+  // its image, become available.
+  void SetSlotReadyCallback(std::function<void()> ready) {
+    slot_ready_ = std::move(ready);
+  }
+  // The image last presented, which is what is on screen: while a newer frame
+  // is pending it is still the previous one, and it outlives Clear(). Empty
+  // before the first frame and after HideImage().
+  QString ShownPath() const {
+    return shown_task_ ? shown_task_->Path() : QString();
+  }
+  // Its full-size decoded image (null if it failed to decode), without a copy
+  // of its pixels. Never waits: a presented image is always decoded.
+  QImage ShownImage() const {
+    return shown_task_ ? shown_task_->Wait() : QImage();
+  }
+  // Its statistics; null while still being computed.
+  std::shared_ptr<const ImageStats> ShownStats() const {
+    return shown_task_ ? shown_task_->Stats() : nullptr;
+  }
+  // Counts DisplayImage() calls, so callers can tell whether one happened.
+  quint64 DisplayCount() const { return display_count_; }
+  // Whether the last DisplayImage() is still waiting for its decode.
+  bool HasPendingFrame() const { return frame_requested_; }
+  // How the last presented frame got its pixmap, and how long it waited.
+  SlotResolve LastResolve() const { return last_resolve_; }
+  double LastWaitMs() const { return last_wait_ms_; }
+  // The clock, in milliseconds, that spaces presents a display frame apart.
+  // Tests stop it, so that no step finds the next frame due by itself.
+  void SetFrameClock(std::function<qint64()> now_ms) {
+    now_ms_ = std::move(now_ms);
+    presented_ms_.reset();
+  }
 
  private:
-  // Materializes the QPixmap for a slot the first time it is needed. Blocks on
-  // the decode future only if that particular image is not ready yet.
+  struct Kept {
+    decode_task_t task;  // done
+    QPixmap pixmap;      // null if it was never converted
+  };
+
+  // The finished task kept for `path` by the last Clear(), with its pixmap in
+  // `pixmap`; otherwise a new decode.
+  decode_task_t Submit(QString const& path, QPixmap* pixmap);
+  // Replaces the task of `slot`, whose file changed since it was decoded,
+  // with a new decode. The displayed slot is presented again once done.
+  void Redecode(int slot);
+  // Materializes the QPixmap for a slot the first time it is needed, or when
+  // a new frame came in for it. Only called once the slot's decode is done.
   const QPixmap& ResolvedSource(int index);
+  // The pixmap of the frame of a done `task`, for the current target.
+  QPixmap Prepared(decode_task_t const& task);
+  // Has a done `task` whose frame was made for another target re-targeted.
+  void Retarget(decode_task_t const& task);
+  // Whether the displayed slot can be presented without waiting.
+  bool IsFrameReady() const {
+    return !source_.at(index()).isNull() || pending_.at(index())->IsDone();
+  }
+  // Presents the requested frame now, or with the next display frame if one
+  // was presented within the current one.
+  void PresentWhenDue();
+  // Hands the displayed slot's pixmap to the view.
+  void Present();
+  // Called on the GUI thread for every finished decode, and again once its
+  // statistics are in; converts it right away if its slot is still in the
+  // window.
+  void Materialize(decode_task_t const& task);
+  static QPixmap FromImage(QImage image);
   // Visible stand-in shown instead of a blank screen when an image cannot be
   // decoded (missing/corrupt file). Must be built on the GUI thread.
   static QPixmap ErrorPlaceholder();
@@ -67,52 +170,235 @@ class CachedImagesList : public Abstract::ImageCache<QString, QPixmap> {
   std::function<void()> save_scroll_position_;
   std::function<void()> restore_scroll_position_;
   std::function<bool()> can_save_scroll_position_;
+  std::function<void()> slot_ready_;
+  DecodeQueue decoder_;
   QList<QPixmap> source_;
-  QList<QFuture<QImage>> pending_;
+  QList<decode_task_t> pending_;
+  QHash<QString, Kept> kept_;
+  quint64 display_count_ = 0;
+  bool frame_requested_ = false;  // by DisplayImage(), not presented yet
+  bool frame_waited_ = false;     // ... and not decoded when requested
+  bool shown_ = false;            // the displayed slot is on screen
+  decode_task_t awaited_;         // its task, while frame_waited_
+  decode_task_t shown_task_;      // the task of the frame on screen
+  QElapsedTimer requested_;
+  std::function<qint64()> now_ms_ = [] {
+    return std::chrono::duration_cast<std::chrono::milliseconds>(
+               std::chrono::steady_clock::now().time_since_epoch())
+        .count();
+  };
+  std::optional<qint64> presented_ms_;  // by now_ms_, of the last present
+  QTimer present_;  // defers a frame to the next display frame
+  QSize target_;
+  SlotResolve last_resolve_ = SlotResolve::Ready;
+  double last_wait_ms_ = 0;
 };
 
 inline CachedImagesList::CachedImagesList(std::size_t capacity,
                                           info_t const& image,
                                           update_image_t update_image)
-    : ImageCache(image, capacity), UpdateImage(update_image) {}
+    : ImageCache(image, capacity), UpdateImage(update_image) {
+  QObject::connect(&decoder_, &DecodeQueue::taskFinished, this,
+                   [this](decode_task_t const& task) { Materialize(task); });
+  present_.setSingleShot(true);
+  present_.setTimerType(Qt::PreciseTimer);
+  present_.callOnTimeout(this, [this] {
+    if (frame_requested_ && IsFrameReady()) Present();
+  });
+}
 
 inline void CachedImagesList::Clear() {
+  frame_requested_ = false;
+  shown_ = false;
+  awaited_.reset();
+  kept_.clear();
+  for (int i = 0; i < pending_.size(); ++i) {
+    decode_task_t const& task = pending_.at(i);
+    if (task->IsDone() && !task->IsStale())
+      kept_.insert(task->Path(), Kept{task, source_.at(i)});
+  }
+  // The next window is built before control returns to the event loop; what
+  // it did not take is dropped then, so that two windows never pile up.
+  if (!kept_.isEmpty()) QTimer::singleShot(0, this, [this] { kept_.clear(); });
   source_.clear();
-  // Outstanding decodes are simply dropped; their results are pulled by slot
-  // index, so a discarded future can never land in a stale slot.
+  // Outstanding decodes are cancelled; finished ones are matched to slots by
+  // task identity, so a discarded task can never land in a stale slot.
+  for (decode_task_t const& task : pending_) task->Cancel();
   pending_.clear();
 }
 
+inline decode_task_t CachedImagesList::Submit(QString const& path,
+                                              QPixmap* pixmap) {
+  const auto kept = kept_.find(path);
+  if (kept == kept_.end()) return decoder_.Submit(path);
+  // Used as it is; should the file turn out to have changed, the slot is
+  // decoded again (see Materialize()).
+  *pixmap = kept->pixmap;
+  decode_task_t task = kept->task;
+  kept_.erase(kept);
+  decoder_.Revalidate(task);
+  return task;
+}
+
 inline void CachedImagesList::DisplayImage() {
-  qDebug() << "-- Displaying";
-  qDebug() << "Image:" << CurrentImageLocation();
-  qDebug() << "Image index in cache:" << index();
-  qDebug() << "Size of cache:" << source_.size();
-  // Held by value (QPixmap is copy-on-write): processEvents() below may run
-  // navigation that mutates the cache, which would dangle a reference here.
+  trace::Scope scope("display", "slot", index());
+  ++display_count_;
+  decode_task_t const& task = pending_.at(index());
+  // Stepped past before its decode even started: the slots still ahead
+  // come first.
+  if (frame_requested_ && awaited_ && awaited_ != task)
+    decoder_.Defer(awaited_);
+  awaited_.reset();
+  frame_requested_ = true;
+  frame_waited_ = false;
+  requested_.start();
+  if (IsFrameReady()) {
+    PresentWhenDue();
+    return;
+  }
+  // Presented by Materialize() once decoded; the view keeps the previous
+  // image until then, and a newer request takes this one's place.
+  frame_waited_ = true;
+  awaited_ = task;
+  decoder_.Expedite(task);
+}
+
+inline void CachedImagesList::PresentWhenDue() {
+  constexpr qint64 kFrameMs = 16;
+  const qint64 since = presented_ms_ ? now_ms_() - *presented_ms_ : kFrameMs;
+  if (since >= kFrameMs) return Present();
+  if (!present_.isActive()) present_.start(int(kFrameMs - since));
+}
+
+inline void CachedImagesList::Present() {
+  trace::Scope scope("present", "slot", index());
+  frame_requested_ = false;
+  shown_ = true;
+  awaited_.reset();
+  present_.stop();
+  presented_ms_ = now_ms_();
+  shown_task_ = pending_.at(index());
+  // Held by value: the view's callbacks may convert other slots.
   QPixmap const image = ResolvedSource(index());
+  if (frame_waited_) {
+    last_resolve_ = SlotResolve::Blocked;
+    last_wait_ms_ = requested_.nsecsElapsed() / 1e6;
+  }
   if (!can_save_scroll_position_ || can_save_scroll_position_()) {
     save_scroll_position_();
   }
   UpdateImage(image);
   restore_scroll_position_();
-  QCoreApplication::processEvents(QEventLoop::AllEvents, 10);
+  Retarget(pending_.at(index()));
 }
 
 inline void CachedImagesList::HideImage() {
+  frame_requested_ = false;
+  shown_ = false;
+  awaited_.reset();
+  shown_task_.reset();
   save_scroll_position_();
   UpdateImage(QPixmap{});
 }
 
+inline CacheStats CachedImagesList::Stats() const {
+  CacheStats stats;
+  stats.size = source_.size();
+  for (QPixmap const& pixmap : source_) {
+    if (pixmap.isNull()) continue;
+    ++stats.ready;
+    stats.bytes +=
+        qint64(pixmap.width()) * pixmap.height() * pixmap.depth() / 8;
+  }
+  for (decode_task_t const& task : pending_) stats.decoding += !task->IsDone();
+  return stats;
+}
+
 inline const QPixmap& CachedImagesList::ResolvedSource(int index) {
-  if (source_.at(index).isNull()) {
-    QImage image = pending_.at(index).result();
-    source_[index] =
-        image.isNull() ? ErrorPlaceholder() : QPixmap::fromImage(image);
+  last_resolve_ = SlotResolve::Ready;
+  last_wait_ms_ = 0;
+  decode_task_t const& task = pending_.at(index);
+  if (source_.at(index).isNull() || task->HasFrame()) {
+    last_resolve_ = SlotResolve::Converted;
+    source_[index] = Prepared(task);
   }
   return source_.at(index);
 }
 
+inline QPixmap CachedImagesList::Prepared(decode_task_t const& task) {
+  // Decoded for an earlier target and never converted: fitted here, as
+  // re-targeting in the background would only delay it.
+  if (!task->FrameFits(target_) || !task->HasFrame())
+    DecodeQueue::PrepareFrame(*task, target_);
+  return FromImage(task->TakeFrame());
+}
+
+inline void CachedImagesList::Retarget(decode_task_t const& task) {
+  if (task->IsDone() && !task->FrameFits(target_))
+    decoder_.Retarget(task);
+}
+
+inline void CachedImagesList::SetFrameTarget(QSize target) {
+  if (target == target_) return;
+  target_ = target;
+  decoder_.SetFrameTarget(target);
+  if (shown_) Retarget(pending_.at(index()));
+}
+
+inline void CachedImagesList::Materialize(decode_task_t const& task) {
+  const int index = pending_.indexOf(task);
+  if (index < 0) return;
+  if (task->IsStale()) return Redecode(index);
+  // Also a re-targeted frame, which replaces the one shown if it is current.
+  const bool replaced = !source_.at(index).isNull() && task->HasFrame();
+  if (source_.at(index).isNull() || task->HasFrame())
+    source_[index] = Prepared(task);
+  if (index == this->index() && replaced && shown_ && !frame_requested_) {
+    frame_requested_ = true;
+    frame_waited_ = false;
+  }
+  if (frame_requested_ && index == this->index()) PresentWhenDue();
+  if (slot_ready_) slot_ready_();
+}
+
+inline void CachedImagesList::Redecode(int slot) {
+  pending_[slot] = decoder_.Submit(pending_.at(slot)->Path());
+  source_[slot] = QPixmap();
+  if (slot != index() || !(shown_ || frame_requested_)) return;
+  frame_requested_ = true;
+  awaited_ = pending_.at(slot);
+  decoder_.Expedite(awaited_);
+}
+
+inline QPixmap CachedImagesList::SlotPixmap(int offset, QString* path) {
+  const int slot = index() + offset;
+  if (slot < 0 || slot >= source_.size()) {
+    if (path) path->clear();
+    return QPixmap();
+  }
+  decode_task_t const& task = pending_.at(slot);
+  if (path) *path = task->Path();
+  if (source_.at(slot).isNull() && task->IsDone())
+    source_[slot] = Prepared(task);
+  Retarget(task);
+  return source_.at(slot);
+}
+
+inline bool CachedImagesList::PrepareSlot(int offset) {
+  const int slot = index() + offset;
+  if (slot < 0 || slot >= source_.size()) return true;
+  if (!SlotPixmap(offset).isNull()) return true;
+  decoder_.Prefetch(pending_.at(slot));
+  return false;
+}
+
+inline QPixmap CachedImagesList::FromImage(QImage image) {
+  trace::Scope scope("convert");
+  // A frame of its own is handed over rather than copied.
+  return image.isNull() ? ErrorPlaceholder()
+                        : QPixmap::fromImage(std::move(image));
+}
+
 inline QPixmap CachedImagesList::ErrorPlaceholder() {
   QPixmap placeholder(640, 360);
   placeholder.fill(QColor(32, 32, 32));
@@ -0,0 +1,181 @@
+#pragma once
+
+#include <QDateTime>
+#include <QImage>
+#include <QMutex>
+#include <QObject>
+#include <QSemaphore>
+#include <QSize>
+#include <QString>
+#include <QThreadPool>
+#include <QThread>
+#include <QWaitCondition>
+#include <atomic>
+#include <cstdint>
+#include <deque>
+#include <memory>
+#include <optional>
+#include <vector>
+
+#include "bounded_queue.hpp"
+#include "image_stats.hpp"
+
+/*
+ * One image to decode. Shared between the cache slot that wants the image and
+ * whichever thread ends up decoding it: a worker, or the GUI thread itself if
+ * it needs the image before any worker got to it.
+ */
+class DecodeTask {
+ public:
+  enum class State { Queued, Running, Done, Cancelled };
+
+  explicit DecodeTask(QString path) : path_(std::move(path)) {}
+  QString const& Path() const { return path_; }
+  // Tags the task's trace events.
+  std::int64_t Id() const { return id_; }
+  // Queued -> Running. Exactly one thread wins; it must then call Finish().
+  bool Claim() {
+    State expected = State::Queued;
+    return state_.compare_exchange_strong(expected, State::Running);
+  }
+  // Queued -> Cancelled, so that no worker wastes time on an evicted slot.
+  void Cancel() {
+    State expected = State::Queued;
+    state_.compare_exchange_strong(expected, State::Cancelled);
+  }
+  // `modified` is the file's modification time, taken before it was read.
+  void Finish(QImage image, QDateTime modified = {});
+  bool IsQueued() const { return state_.load() == State::Queued; }
+  // A deferred task is only decoded once no other request is waiting.
+  void SetDeferred(bool deferred) { deferred_.store(deferred); }
+  bool IsDeferred() const { return deferred_.load(); }
+  bool IsDone() const { return state_.load() == State::Done; }
+  // Blocks until the task is done. Only valid once it has been claimed.
+  QImage const& Wait();
+  // What the decoded image reflects; only valid once the task is done.
+  QDateTime const& Modified() const { return modified_; }
+  // The frame is the image fitted to a frame target (see frame_target.hpp),
+  // prepared by whoever decoded it and left here until the GUI thread takes
+  // it. The target stays behind as the tag of the pixmap made from it.
+  void SetFrame(QImage frame, QSize target);
+  QSize FrameTarget() const;
+  // Whether the frame for FrameTarget() is also the one for `target`, so that
+  // re-targeting would change nothing. Only valid once the task is done.
+  bool FrameFits(QSize target) const;
+  bool HasFrame() const;
+  QImage TakeFrame();
+  // Tonal statistics of the decoded image; null until a worker has computed
+  // them, which happens after the image itself was announced.
+  std::shared_ptr<const ImageStats> Stats() const;
+  void SetStats(ImageStats stats);
+  // Exactly one thread wins the right to compute the statistics.
+  bool ClaimStats() { return !stats_claimed_.exchange(true); }
+  // Asks for a check whether the file changed since it was read; the one
+  // thread that claims it does the check.
+  void RequestCheck() { check_requested_.store(true); }
+  bool ClaimCheck() { return check_requested_.exchange(false); }
+  // The file changed since it was read, so the image is out of date.
+  void SetStale() { stale_.store(true); }
+  bool IsStale() const { return stale_.load(); }
+
+ private:
+  static std::int64_t NextId();
+
+  const QString path_;
+  const std::int64_t id_ = NextId();
+  std::atomic<State> state_{State::Queued};
+  std::atomic<bool> deferred_{false};
+  QImage image_;
+  QDateTime modified_;
+  QImage frame_;
+  QSize frame_target_;
+  std::shared_ptr<const ImageStats> stats_;
+  std::atomic<bool> stats_claimed_{false};
+  std::atomic<bool> check_requested_{false};
+  std::atomic<bool> stale_{false};
+  mutable QMutex mutex_;
+  QWaitCondition done_;
+};
+
+using decode_task_t = std::shared_ptr<DecodeTask>;
+
+/*
+ * Feeds a fixed set of decode threads through a lock-free request ring and
+ * hands finished tasks back through a second ring. Submit() never blocks: if
+ * the request ring is full the task goes to an overflow list behind it, which
+ * takes a lock but is only used while the workers are that far behind, so
+ * every task is still decoded off the GUI thread. Finished tasks are
+ * announced on the GUI thread with taskFinished(), batched into a single
+ * queued call however many workers complete in the meantime. Once a task's
+ * image is out, a worker computes its ImageStats and announces the task a
+ * second time. Deferred tasks are set aside in a ring of their own, which
+ * workers turn to only when no other request is left. Along with each image,
+ * its decoder prepares the frame for the current frame target.
+ */
+class DecodeQueue : public QObject {
+  Q_OBJECT
+ public:
+  explicit DecodeQueue(int workers = QThread::idealThreadCount(),
+                       QObject* parent = nullptr);
+  ~DecodeQueue() override;
+
+  decode_task_t Submit(QString path);
+  // The decoded image. If no worker has started on the task yet, it is decoded
+  // right here instead of waiting behind the rest of the queue, and handed
+  // back to the workers for its statistics.
+  QImage const& Result(decode_task_t const& task);
+  // Queues a still unclaimed `task` again, no longer deferred, for when it is
+  // about to be needed.
+  void Prefetch(decode_task_t const& task);
+  // Lets every other queued request go before a still unclaimed `task`, which
+  // is no longer wanted soon (the viewer stepped past it).
+  void Defer(decode_task_t const& task);
+  // Decodes a still unclaimed `task` on a thread of its own, ahead of the
+  // queue, because it is wanted on screen now, and hands it back to the
+  // workers for its statistics. Only the latest such task counts: one that
+  // has not started yet is dropped by the next.
+  void Expedite(decode_task_t const& task);
+  // What frames are prepared for from now on (device pixels; invalid for
+  // the full image).
+  void SetFrameTarget(QSize target);
+  QSize FrameTarget() const;
+  // Prepares a new frame for a done `task` whose frame was made for another
+  // target, on the expedited thread, and announces the task again.
+  void Retarget(decode_task_t const& task);
+  // Has a worker check whether the file of a done `task` changed since it
+  // was read; if it did, the task is marked stale and announced again.
+  void Revalidate(decode_task_t const& task);
+  // Prepares the frame of a done `task` for `target` on the calling thread.
+  static void PrepareFrame(DecodeTask& task, QSize target);
+
+ signals:
+  void taskFinished(decode_task_t task);
+
+ private:
+  // Decodes the claimed `task` on the calling thread, prepares its frame for
+  // `target` and finishes it.
+  static void Decode(DecodeTask& task, QSize target);
+  // Queues `task` for the workers: to be decoded, or, once done, for its
+  // statistics.
+  void Enqueue(decode_task_t const& task);
+  void Run(decode_task_t const& task);
+  // Queues `task` for taskFinished() on the GUI thread.
+  void Announce(decode_task_t const& task);
+  void WorkerLoop();
+  std::optional<decode_task_t> TakeOverflow();
+  void DrainCompletions();
+
+  BoundedQueue<decode_task_t> requests_;
+  BoundedQueue<decode_task_t> deferred_;
+  BoundedQueue<decode_task_t> completions_;
+  QMutex overflow_mutex_;
+  std::deque<decode_task_t> overflow_;  // requests that found the ring full
+  std::atomic<bool> overflowed_{false};  // overflow_ is not empty
+  QSemaphore available_;  // counts all three request lists, wakes workers
+  std::atomic<bool> stopping_{false};
+  std::atomic<bool> drain_scheduled_{false};
+  mutable QMutex target_mutex_;
+  QSize frame_target_;
+  std::vector<std::unique_ptr<QThread>> workers_;
+  QThreadPool expedited_;  // last, so that it is waited for first
+};
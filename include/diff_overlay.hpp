@@ -0,0 +1,41 @@
+#pragma once
+
+#include <QImage>
+#include <QObject>
+#include <QThreadPool>
+#include <atomic>
+
+#include "pixel_diff.hpp"
+
+/*
+ * Diff mode: compares each displayed image against a chosen reference off
+ * the GUI thread. Comparisons run one at a time; a Compare() made while
+ * another is queued or running supersedes it, so navigating quickly only
+ * ever reports the image that is on screen.
+ */
+class DiffOverlay : public QObject {
+  Q_OBJECT
+ public:
+  // Differences up to kThreshold (JPEG noise) do not count as changed, and
+  // the heatmap shows a difference of 255 / kGain as opaque.
+  static constexpr int kThreshold = 8;
+  static constexpr int kGain = 8;
+
+  explicit DiffOverlay(QObject* parent = nullptr);
+
+  void SetReference(QString path, QImage image);
+  QString const& ReferencePath() const { return reference_path_; }
+  bool HasReference() const { return !reference_.isNull(); }
+  void Compare(QImage image);
+  // Drops the outstanding comparison, if any.
+  void Cancel() { ++generation_; }
+
+ signals:
+  void ready(QImage heatmap, DiffStats stats);
+
+ private:
+  QString reference_path_;
+  QImage reference_;
+  std::atomic<quint64> generation_{0};
+  QThreadPool pool_;
+};
@@ -0,0 +1,64 @@
+#pragma once
+
+#include <QHash>
+#include <QObject>
+#include <QThreadPool>
+#include <atomic>
+
+#include "perceptual_hash.hpp"
+#include "preview_cache.hpp"
+
+/*
+ * Finds the near-duplicates in a list of images in the background. Every
+ * image is hashed on all cores, from the preview cache where it can be
+ * (see perceptual_hash.hpp), and the hashes are grouped into clusters.
+ * Hashes are remembered in a store on disk, keyed by path and checked
+ * against the file's size and modification time, so looking again at a
+ * large collection only decodes what is new or changed.
+ */
+class DuplicateFinder : public QObject {
+  Q_OBJECT
+ public:
+  // Hashes at most this many bits apart count as near-duplicates.
+  static constexpr int kMaxDistance = 6;
+
+  explicit DuplicateFinder(QString store_path = DefaultStorePath(),
+                           PreviewCache cache = PreviewCache(),
+                           QObject* parent = nullptr);
+  ~DuplicateFinder() override;
+
+  // Under the user's cache location, e.g. ~/.cache/pviewer/hashes.
+  static QString DefaultStorePath();
+
+  // Supersedes any search still under way.
+  void Find(QVector<QString> paths);
+  // Drops the search under way, if any: it emits nothing.
+  void Cancel() { ++generation_; }
+  // A search that has not been superseded or cancelled is under way.
+  bool IsRunning() const { return running_ != 0 && running_ == generation_; }
+
+ signals:
+  // `clusters` index into `paths`, the list given to Find().
+  void found(QVector<QString> paths, clusters_t clusters,
+             qint64 elapsed_ms);
+
+ private:
+  struct Stored {
+    qint64 size = -1;
+    qint64 modified = 0;  // ms since the epoch
+    quint64 hash = 0;
+  };
+
+  // Runs on the worker: the store is only touched there.
+  clusters_t Search(QVector<QString> const& paths, quint64 generation);
+  void LoadStore();
+  void SaveStore() const;
+
+  const QString store_path_;
+  const PreviewCache cache_;
+  QHash<QString, Stored> store_;
+  bool store_loaded_ = false;
+  std::atomic<quint64> generation_{0};
+  quint64 running_ = 0;  // generation of the last search started, until done
+  QThreadPool pool_;
+};
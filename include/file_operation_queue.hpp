@@ -0,0 +1,67 @@
+#pragma once
+
+#include <QObject>
+#include <QString>
+#include <QThreadPool>
+#include <QVector>
+#include <memory>
+
+/*
+ * Runs file operations (trash, move to folder, copy to folder) on a single
+ * background thread, in submission order, so a slow trash directory or network
+ * mount never stalls the GUI thread. Callers update their own state up front
+ * and react to `failed` if an operation could not be carried out.
+ *
+ * Every submitted operation is recorded on an undo stack of the last
+ * kUndoDepth. Undo() reverts the most recent one; since the queue is serial,
+ * that works even if the operation itself has not finished yet.
+ */
+class FileOperationQueue : public QObject {
+  Q_OBJECT
+ public:
+  static constexpr int kUndoDepth = 100;
+
+  enum class Kind { Trash, Move, Copy };
+  struct Operation {
+    int id = 0;
+    Kind kind = Kind::Trash;
+    QString source;
+    QString destination;  // known once the operation has finished
+    bool succeeded = false;
+  };
+
+  explicit FileOperationQueue(QObject* parent = nullptr);
+  ~FileOperationQueue() override;
+
+  // Each returns the id of the queued operation, as reported by the signals.
+  int Trash(QString path);
+  int MoveTo(QString path, QString directory);
+  int CopyTo(QString path, QString directory);
+  bool Undo();
+  bool CanUndo() const { return !undo_stack_.isEmpty(); }
+  int Pending() const { return pending_; }
+
+ signals:
+  void failed(FileOperationQueue::Operation operation, QString reason);
+  void undone(FileOperationQueue::Operation operation);
+  void undoFailed(FileOperationQueue::Operation operation, QString reason);
+  // The operation fell off the undo stack and can no longer be undone.
+  void expired(int id);
+
+ private:
+  using operation_t = std::shared_ptr<Operation>;
+  struct Result {
+    bool ok = true;
+    QString reason;
+  };
+
+  int Submit(Kind kind, QString source, QString destination);
+  void Run(operation_t const& operation, bool undo);
+  static Result Perform(Operation& operation);
+  static Result Revert(Operation const& operation);
+
+  QThreadPool pool_;
+  QVector<operation_t> undo_stack_;
+  int next_id_ = 1;
+  int pending_ = 0;
+};
@@ -0,0 +1,33 @@
+#pragma once
+
+#include <QImage>
+#include <QSize>
+
+class QScreen;
+class QWidget;
+
+/*
+ * Decoded images are kept at full resolution (for zoom, diff and statistics),
+ * but what the decode window turns into pixmaps and shows is a frame: the
+ * image scaled down to fit a target in device pixels. The target follows the
+ * view the image is shown in, its devicePixelRatio and the zoom level, so
+ * every screen gets one image pixel per device pixel and no more. Images
+ * smaller than the target are their own frame.
+ */
+
+// The frame target for `view` at `zoom` times the fit-to-view scale. The
+// zoom is rounded up to a power of two, so that zooming step by step only
+// re-targets the displayed image once in a while; below 1 it counts as 1.
+// Invalid if there is no view.
+QSize ViewFrameTarget(QWidget const* view, double zoom = 1);
+// The same for the whole of `screen`, for when there is no view yet.
+QSize ScreenFrameTarget(QScreen const* screen, double zoom = 1);
+// The same for a screen of `size` logical pixels at `device_pixel_ratio`.
+QSize ScreenFrameTarget(QSize size, double device_pixel_ratio, double zoom = 1);
+
+// `image` scaled down, keeping its aspect ratio, to fit `target`. Smaller
+// images, and any image if `target` is invalid, are returned as they are.
+QImage FitToTarget(QImage const& image, QSize target);
+// Whether `a` and `b` fit an image of `size` to the same frame: they are the
+// same target, or the image fits both as it is.
+bool SameFrame(QSize size, QSize a, QSize b);
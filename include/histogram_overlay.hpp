@@ -0,0 +1,30 @@
+#pragma once
+
+#include <QWidget>
+#include <memory>
+
+#include "image_stats.hpp"
+
+/*
+ * Translucent overlay in the top-right corner of the viewer with the
+ * histograms of the displayed image, per channel and for luma, their
+ * min/max/mean and how much of the image is clipped to black or white. Only
+ * paints statistics it is given; it never looks at pixels itself.
+ */
+class HistogramOverlay : public QWidget {
+  Q_OBJECT
+ public:
+  explicit HistogramOverlay(QWidget* parent = nullptr);
+
+  // Null while the displayed image's statistics are still being computed.
+  void SetStats(std::shared_ptr<const ImageStats> stats);
+  // Keeps the overlay in the top-right corner of `area`.
+  void Place(QRect const& area);
+  void Toggle(QRect const& area);
+
+ protected:
+  void paintEvent(QPaintEvent*) override;
+
+ private:
+  std::shared_ptr<const ImageStats> stats_;
+};
@@ -1,22 +1,44 @@
 #pragma once
 
+#include <QSet>
 #include <QString>
 #include <QVector>
+#include <algorithm>
 #include <utility>
 
+#include "path_store.hpp"
+
+// Entries name their image by its id in PathStore::Shared().
 struct ImageEntry {
-  QString path;
+  PathId id = kNoPath;
   bool enabled = true;
+
+  QString Path() const {
+    return id == kNoPath ? QString() : PathStore::Shared().Path(id);
+  }
+};
+
+// A single incremental change to the comparison list, as produced by the
+// panel. Applying edits one at a time lets MainWindow patch the active list and
+// its decode window locally instead of rebuilding them from scratch. Edits name
+// the path itself, since session files record and replay them.
+struct EntryEdit {
+  enum class Kind { Enable, Disable, Move, Remove, Insert };
+  Kind kind;
+  QString path;
+  int to = -1;  // destination row, Kind::Move and Kind::Insert only
 };
 
 class ImageComparisonModel {
  public:
-  void SetImages(QVector<QString> paths) {
+  void SetImages(QVector<QString> const& paths) {
+    SetImages(PathStore::Shared().Intern(paths));
+  }
+
+  void SetImages(QVector<PathId> const& ids) {
     entries_.clear();
-    entries_.reserve(paths.size());
-    for (QString& path : paths) {
-      entries_.push_back(ImageEntry{std::move(path), true});
-    }
+    entries_.reserve(ids.size());
+    for (PathId id : ids) entries_.push_back(ImageEntry{id, true});
   }
 
   void SetEntries(QVector<ImageEntry> entries) {
@@ -25,12 +47,12 @@ class ImageComparisonModel {
 
   const QVector<ImageEntry>& Entries() const { return entries_; }
 
-  QVector<QString> EnabledPaths() const {
-    QVector<QString> paths;
+  QVector<PathId> EnabledIds() const {
+    QVector<PathId> ids;
     for (const ImageEntry& entry : entries_) {
-      if (entry.enabled) paths.push_back(entry.path);
+      if (entry.enabled) ids.push_back(entry.id);
     }
-    return paths;
+    return ids;
   }
 
   bool SetEnabled(int row, bool enabled) {
@@ -66,6 +88,51 @@ class ImageComparisonModel {
     return true;
   }
 
+  // Inserts an entry for a path that is not in the list yet, e.g. to restore a
+  // removed one. `row` is clamped, since the list may have shrunk meanwhile.
+  bool Insert(int row, ImageEntry entry) {
+    if (entry.id == kNoPath || RowOf(entry.id) >= 0) return false;
+    entries_.insert(std::clamp(row, 0, int(entries_.size())), std::move(entry));
+    return true;
+  }
+
+  bool ApplyEdit(EntryEdit const& edit) {
+    switch (edit.kind) {
+      case EntryEdit::Kind::Enable:
+        return SetPathEnabled(edit.path, true);
+      case EntryEdit::Kind::Disable:
+        return SetPathEnabled(edit.path, false);
+      case EntryEdit::Kind::Move:
+        return Move(RowOf(edit.path), edit.to);
+      case EntryEdit::Kind::Remove:
+        return RemovePath(edit.path);
+      case EntryEdit::Kind::Insert:
+        return Insert(edit.to,
+                      ImageEntry{PathStore::Shared().Intern(edit.path), true});
+    }
+    return false;
+  }
+
+  int RowOf(QString const& path) const {
+    const std::optional<PathId> id = PathStore::Shared().Find(path);
+    return id ? RowOf(*id) : -1;
+  }
+
+  int RowOf(PathId id) const {
+    for (int i = 0; i < entries_.size(); ++i) {
+      if (entries_[i].id == id) return i;
+    }
+    return -1;
+  }
+
+  // Zero-based index of `path` among the enabled entries, i.e. its position in
+  // EnabledIds(); -1 if it is unknown or disabled.
+  int ActiveIndexOf(QString const& path) const {
+    const int row = RowOf(path);
+    if (row < 0 || !entries_[row].enabled) return -1;
+    return EnabledPositionForRow(row) - 1;
+  }
+
   int EnabledPositionFor(QString const& path) const {
     if (entries_.isEmpty()) return 0;
 
@@ -94,13 +161,6 @@ class ImageComparisonModel {
  private:
   bool IsValidRow(int row) const { return 0 <= row && row < entries_.size(); }
 
-  int RowOf(QString const& path) const {
-    for (int i = 0; i < entries_.size(); ++i) {
-      if (entries_[i].path == path) return i;
-    }
-    return -1;
-  }
-
   int EnabledPositionForRow(int row) const {
     int position = 0;
     for (int i = 0; i <= row; ++i) {
@@ -111,3 +171,37 @@ class ImageComparisonModel {
 
   QVector<ImageEntry> entries_;
 };
+
+// The edits that turn the list `before` into `after`: removals first, then
+// row by row the insertions, moves and checks. Applied in order they give
+// `after`, so a wholesale change can be recorded, and replayed, as edits.
+inline QVector<EntryEdit> EditsBetween(QVector<ImageEntry> const& before,
+                                       QVector<ImageEntry> const& after) {
+  QVector<EntryEdit> edits;
+  ImageComparisonModel model;
+  model.SetEntries(before);
+  auto apply = [&](EntryEdit edit) {
+    model.ApplyEdit(edit);
+    edits.push_back(std::move(edit));
+  };
+  QSet<PathId> kept;
+  for (ImageEntry const& entry : after) kept.insert(entry.id);
+  for (ImageEntry const& entry : before) {
+    if (!kept.contains(entry.id))
+      apply(EntryEdit{EntryEdit::Kind::Remove, entry.Path()});
+  }
+  for (int row = 0; row < after.size(); ++row) {
+    ImageEntry const& entry = after[row];
+    const int from = model.RowOf(entry.id);
+    if (from < 0)
+      apply(EntryEdit{EntryEdit::Kind::Insert, entry.Path(), row});
+    else if (from != row)
+      apply(EntryEdit{EntryEdit::Kind::Move, entry.Path(), row});
+    if (model.Entries()[row].enabled != entry.enabled) {
+      apply(EntryEdit{entry.enabled ? EntryEdit::Kind::Enable
+                                    : EntryEdit::Kind::Disable,
+                      entry.Path()});
+    }
+  }
+  return edits;
+}
@@ -1,8 +1,11 @@
 #pragma once
 
+#include <QCollator>
+#include <QDir>
 #include <QLatin1Char>
 #include <QString>
 #include <QStringList>
+#include <algorithm>
 
 /*
  * Single source of truth for the image formats the viewer understands.
@@ -28,3 +31,15 @@ inline QStringList SupportedImageNameFilters() {
     filters << (QStringLiteral("*.") + suffix);
   return filters;
 }
+
+// Absolute paths of the supported images directly inside `directory`, in
+// natural order ("img2" before "img10").
+inline QList<QString> ImagesInDirectory(QDir directory) {
+  directory.setNameFilters(SupportedImageNameFilters());
+  QList<QString> images = directory.entryList(QDir::Files);
+  QCollator collator;
+  collator.setNumericMode(true);
+  std::sort(images.begin(), images.end(), collator);
+  for (QString &path : images) path = directory.absoluteFilePath(path);
+  return images;
+}
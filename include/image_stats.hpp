@@ -0,0 +1,33 @@
+#pragma once
+
+#include <QImage>
+#include <QtGlobal>
+#include <array>
+
+#include "simd_level.hpp"
+
+/*
+ * Tonal statistics of an image for the histogram overlay: red, green, blue
+ * and luma histograms, and how many pixels are clipped to black or white.
+ * Computed once per decoded image on a decode worker (see DecodeQueue), so
+ * showing them never costs the GUI thread more than a lookup.
+ */
+struct ImageStats {
+  enum Channel { Red, Green, Blue, Luma };
+  static constexpr int kChannels = 4;
+  using histogram_t = std::array<quint32, 256>;
+
+  std::array<histogram_t, kChannels> histograms{};
+  qint64 pixels = 0;
+  qint64 black = 0;  // pixels with every colour channel at 0
+  qint64 white = 0;  // ... with any colour channel at 255
+
+  // Lowest and highest level in use; -1 for an empty image.
+  int Min(Channel channel) const;
+  int Max(Channel channel) const;
+  double Mean(Channel channel) const;
+};
+
+// Luma is Rec. 601, (77 R + 150 G + 29 B + 128) / 256. Alpha is ignored.
+ImageStats ComputeImageStats(QImage const& image,
+                             SimdLevel level = BestSimdLevel());
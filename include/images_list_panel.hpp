@@ -1,7 +1,10 @@
 #pragma once
 
+#include <QCheckBox>
 #include <QDialog>
+#include <QHash>
 #include <QListWidget>
+#include <optional>
 
 #include "image_comparison_model.hpp"
 
@@ -11,28 +14,40 @@ class ImagesListPanel : public QDialog {
   explicit ImagesListPanel(QWidget* parent = nullptr);
 
   void SetEntries(QVector<ImageEntry> entries);
-  void SetCurrentPath(QString path);
+  void SetCurrentPath(QString const& path);
+  // Near-duplicate groups, by image: the 0-based group of each one that has
+  // near-duplicates, and the size of each group. Collapsing the list hides
+  // all but the first image of every group.
+  void SetClusters(QHash<PathId, int> cluster_of, QVector<int> sizes);
   QVector<ImageEntry> Entries() const { return entries_; }
 
  signals:
   void entriesChanged(QVector<ImageEntry> entries);
+  void entryEdited(EntryEdit edit);
   void imageActivated(QString path);
   void imageDeleteRequested(QString path);
   void previousImageRequested();
   void nextImageRequested();
   void zoomInRequested();
   void zoomOutRequested();
+  // Collapsing was asked for before any groups were set.
+  void clustersRequested();
 
  private:
   void RebuildList();
+  QVector<ImageEntry> EntriesFromList() const;
   void SyncEntriesFromList();
+  void SyncCheckState(int row);
   void MoveSelectedRow(int offset);
   void ScheduleEntriesSync();
   void EmitEntriesChanged();
 
   QListWidget* list_;
+  QCheckBox* collapse_;
+  QHash<PathId, int> cluster_of_;
+  QVector<int> cluster_sizes_;
   QVector<ImageEntry> entries_;
-  QString current_path_;
+  std::optional<PathId> current_;
   bool updating_ = false;
   bool sync_scheduled_ = false;
 };
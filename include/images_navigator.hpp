@@ -1,5 +1,6 @@
 #pragma once
 
+#include <algorithm>
 #include <ostream>
 
 #include "abstract_image_cache.hpp"
@@ -131,6 +132,136 @@ struct BeginOfTheListImpl : public ImageNumberImpl<In, Im> {
   }
 };
 
+// Shared bookkeeping for editing the location list in place. Instead of
+// rebuilding the whole cache (as ImageNumberImpl does), the window keeps its
+// decoded slots: an edit outside the window only shifts the edges, an edit
+// inside it removes/inserts a single slot, and Commit() then tops the window up
+// (or trims it) back to min(capacity, size) around the current image.
+template <typename In, typename Im>
+class WindowEdit : public ImageNumberImpl<In, Im> {
+  using pointer_t = void (QList<Im>::*)(const Im&);
+  static constexpr pointer_t Back = &QList<Im>::push_back;
+  static constexpr pointer_t Front = &QList<Im>::push_front;
+
+ protected:
+  WindowEdit(Abstract::ImageLocation<In, Im>& images,
+             Abstract::ImageCache<In, Im>& cache)
+      : images_(images), cache_(cache), left_(-1), right_(-1) {
+    if (cache.isEmpty()) return;
+    left_ = std::distance(images.Begin(), cache.LeftEdge());
+    right_ = std::distance(images.Begin(), cache.RightEdge());
+  }
+  bool HasWindow() const { return left_ >= 0; }
+  bool InWindow(int position) const {
+    return HasWindow() && left_ <= position && position <= right_;
+  }
+  int SlotOf(int position) const { return position - left_; }
+  // Must be called before the item at `position` is taken out of the list.
+  void DropSlot(int position) {
+    if (!HasWindow()) return;
+    if (position < left_) {
+      --left_;
+      --right_;
+    } else if (position <= right_) {
+      cache_.RemoveSlot(SlotOf(position));
+      --right_;
+    }
+  }
+  // Must be called after an item has been inserted into the list.
+  void AddSlot(int position) {
+    if (!HasWindow()) return;
+    if (position <= left_) {
+      ++left_;
+      ++right_;
+    } else if (position <= right_) {
+      ++right_;
+      auto value = std::next(images_.Begin(), position);
+      cache_.InsertSlot(SlotOf(position), value);
+    }
+  }
+  void Commit() {
+    if (!HasWindow()) return;
+    if (images_.isEmpty()) return cache_.Clear();
+    const int current = images_.Pos();
+    const bool current_valid = 0 <= current && current < images_.size();
+    if (right_ < left_ || (current_valid && !InWindow(current))) {
+      // The window lost its last slot, or the current image was moved away
+      // from it: nothing worth keeping, so start over around the current one.
+      const int position = std::clamp(current, 0, images_.size() - 1);
+      return ImageNumberImpl<In, Im>::Process(images_, cache_, position);
+    }
+    cache_.SetEdges(std::next(images_.Begin(), left_),
+                    std::next(images_.Begin(), right_));
+    Abstract::TaskQueue<In, Im>& task_queue = images_.TaskQueueObject();
+    const int wanted = std::min<int>(cache_.Capacity(), images_.size());
+    while (static_cast<int>(cache_.Size()) < wanted) {
+      if (right_ + 1 < images_.size())
+        task_queue.template Push<Back>(std::next(images_.Begin(), ++right_));
+      else
+        task_queue.template Push<Front>(std::next(images_.Begin(), --left_));
+      cache_.ProcessTaskItem(task_queue);
+    }
+    while (cache_.Size() > cache_.Capacity()) {
+      // Evict from the side farther from the current image.
+      const int direction =
+          current_valid && current - left_ > right_ - current ? 1 : -1;
+      cache_.RemoveOutdated(direction);
+      direction > 0 ? ++left_ : --right_;
+    }
+  }
+
+  Abstract::ImageLocation<In, Im>& images_;
+  Abstract::ImageCache<In, Im>& cache_;
+
+ private:
+  int left_;   // list position of the leftmost cached image, -1 if none
+  int right_;  // list position of the rightmost cached image
+};
+
+template <typename In, typename Im>
+struct RemoveImageImpl : public WindowEdit<In, Im> {
+  RemoveImageImpl(Abstract::ImageLocation<In, Im>& images,
+                  Abstract::ImageCache<In, Im>& cache, int position)
+      : WindowEdit<In, Im>(images, cache) {
+    if (position < 0 || position >= images.size()) return;
+    this->DropSlot(position);
+    images.RemoveItem(position);
+    this->Commit();
+  }
+};
+
+template <typename In, typename Im>
+struct InsertImageImpl : public WindowEdit<In, Im> {
+  InsertImageImpl(Abstract::ImageLocation<In, Im>& images,
+                  Abstract::ImageCache<In, Im>& cache, int position, In value)
+      : WindowEdit<In, Im>(images, cache) {
+    if (position < 0 || position > images.size()) return;
+    images.InsertItem(position, std::move(value));
+    this->AddSlot(position);
+    this->Commit();
+  }
+};
+
+template <typename In, typename Im>
+struct MoveImageImpl : public WindowEdit<In, Im> {
+  MoveImageImpl(Abstract::ImageLocation<In, Im>& images,
+                Abstract::ImageCache<In, Im>& cache, int from, int to)
+      : WindowEdit<In, Im>(images, cache) {
+    const int size = images.size();
+    if (from < 0 || from >= size || to < 0 || to >= size || from == to) return;
+    if (this->InWindow(from) && this->InWindow(to)) {
+      // A reorder inside the window keeps every decoded slot.
+      cache.MoveSlot(this->SlotOf(from), this->SlotOf(to));
+      images.MoveItem(from, to);
+    } else {
+      this->DropSlot(from);
+      images.MoveItem(from, to);
+      this->AddSlot(to);
+    }
+    this->Commit();
+  }
+};
+
 template <typename Order, typename In, typename Im>
 class ImageBase {
  private:
@@ -157,9 +288,12 @@ class ImageBase {
     }
     Abstract::TaskQueue<In, Im>& task_queue = location.TaskQueueObject();
     location.MoveIndex(direction);
-    if (int shift = cache.CheckCacheThreshold(direction); shift) {
-      auto iter = location.Index();
-      std::advance(iter, shift);
+    if (cache.CheckCacheThreshold(direction)) {
+      // Extend the window by the image adjacent to its edge. For a window
+      // built by InitialImageTask this is exactly Index() + threshold, and it
+      // stays contiguous after in-place edits (WindowEdit) shift the window.
+      auto iter = direction > 0 ? std::next(cache.RightEdge())
+                                : std::prev(cache.LeftEdge());
       if (location.Begin() <= iter && iter < location.End()) {
         result_ |= Step::Enqueue;
         direction > 0 ? task_queue.template Push<Back>(iter)
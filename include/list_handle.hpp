@@ -0,0 +1,91 @@
+#pragma once
+
+#include <compare>
+#include <cstddef>
+#include <iterator>
+#include <type_traits>
+
+/*
+ * A position in an image list, held as (list, index) instead of a raw
+ * container iterator. Appending to the list, or the list reallocating, leaves
+ * every handle valid, so the cache window keeps its slots while a directory
+ * scan streams paths in; insertions and removals in the middle are accounted
+ * for by WindowEdit (images_navigator.hpp). Handles are random-access
+ * iterators, so std::distance/next/prev work as before, and unlike a pointer a
+ * handle may legally sit one before the beginning -- the position the viewer
+ * uses for "nothing displayed yet".
+ */
+template <typename Container>
+class ListHandle {
+  using list_t = std::remove_const_t<Container>;
+
+ public:
+  using iterator_category = std::random_access_iterator_tag;
+  using value_type = typename list_t::value_type;
+  using difference_type = std::ptrdiff_t;
+  using reference = std::conditional_t<std::is_const_v<Container>,
+                                       value_type const&, value_type&>;
+  using pointer = std::remove_reference_t<reference>*;
+
+  ListHandle() = default;
+  ListHandle(Container* list, difference_type index)
+      : list_(list), index_(index) {}
+  // A handle into a mutable list converts to one into a const list, the same
+  // way an iterator converts to a const_iterator.
+  template <typename Other,
+            typename = std::enable_if_t<
+                std::is_same_v<Other const, Container> &&
+                !std::is_same_v<Other, Container>>>
+  ListHandle(ListHandle<Other> const& other)
+      : list_(other.List()), index_(other.Index()) {}
+
+  Container* List() const { return list_; }
+  difference_type Index() const { return index_; }
+
+  reference operator*() const { return (*list_)[index_]; }
+  pointer operator->() const { return &(*list_)[index_]; }
+  reference operator[](difference_type n) const {
+    return (*list_)[index_ + n];
+  }
+
+  ListHandle& operator++() { return *this += 1; }
+  ListHandle& operator--() { return *this -= 1; }
+  ListHandle operator++(int) {
+    ListHandle old = *this;
+    ++*this;
+    return old;
+  }
+  ListHandle operator--(int) {
+    ListHandle old = *this;
+    --*this;
+    return old;
+  }
+  ListHandle& operator+=(difference_type n) {
+    index_ += n;
+    return *this;
+  }
+  ListHandle& operator-=(difference_type n) {
+    index_ -= n;
+    return *this;
+  }
+  friend ListHandle operator+(ListHandle h, difference_type n) {
+    return h += n;
+  }
+  friend ListHandle operator+(difference_type n, ListHandle h) {
+    return h += n;
+  }
+  friend ListHandle operator-(ListHandle h, difference_type n) {
+    return h -= n;
+  }
+  friend difference_type operator-(ListHandle a, ListHandle b) {
+    return a.index_ - b.index_;
+  }
+  // Both compare the list first, then the index, so that a < b, a == b and
+  // a > b are exclusive even for handles into different lists.
+  friend bool operator==(ListHandle const&, ListHandle const&) = default;
+  friend auto operator<=>(ListHandle const&, ListHandle const&) = default;
+
+ private:
+  Container* list_ = nullptr;
+  difference_type index_ = 0;
+};
@@ -1,27 +1,47 @@
 #pragma once
 
+#include <QElapsedTimer>
 #include <QGraphicsPixmapItem>
 #include <QGraphicsScene>
 #include <QGraphicsView>
+#include <QHash>
+#include <algorithm>
+#include <optional>
 
 #include "arrow_keys_scroller.hpp"
+#include "blink_comparison.hpp"
+#include "diff_overlay.hpp"
+#include "duplicate_finder.hpp"
+#include "file_operation_queue.hpp"
 #include "image_comparison_model.hpp"
 #include "images_navigator.hpp"
+#include "performance_stats.hpp"
+#include "session_log.hpp"
+#include "startup_loader.hpp"
 
 class CachedImagesList;
+class HistogramOverlay;
 class ImagesSelectorDialog;
 class ImagesListPanel;
+class PerformanceHud;
+class QLabel;
+class RenderQuality;
 class QSystemTrayIcon;
+class SplitView;
+class Toast;
 
 class MainWindow : public QGraphicsView {
   Q_OBJECT
  private:
-  using BeginOfTheList = BeginOfTheListImpl<QString, QPixmap>;
-  using EndOfTheList = EndOfTheListImpl<QString, QPixmap>;
-  using ImageNumber = ImageNumberImpl<QString, QPixmap>;
-  using NextImage = ImageBase<NumericalOrder, QString, QPixmap>;
-  using PreviousImage = ImageBase<ReverseOrder, QString, QPixmap>;
-  using move_t = ImagesNavigator<QString, QPixmap>;
+  using BeginOfTheList = BeginOfTheListImpl<PathId, QPixmap>;
+  using EndOfTheList = EndOfTheListImpl<PathId, QPixmap>;
+  using ImageNumber = ImageNumberImpl<PathId, QPixmap>;
+  using NextImage = ImageBase<NumericalOrder, PathId, QPixmap>;
+  using PreviousImage = ImageBase<ReverseOrder, PathId, QPixmap>;
+  using RemoveImage = RemoveImageImpl<PathId, QPixmap>;
+  using InsertImage = InsertImageImpl<PathId, QPixmap>;
+  using MoveImage = MoveImageImpl<PathId, QPixmap>;
+  using move_t = ImagesNavigator<PathId, QPixmap>;
 
   class SlidersState;
   class WheelScrollingState;
@@ -31,14 +51,41 @@ class MainWindow : public QGraphicsView {
   MainWindow(QString = QString(), int = 1, QWidget* = nullptr);
   MainWindow(QList<QString>, QWidget* = nullptr);
 
+  // Takes over `loader` and shows what it loads: its preview as soon as it
+  // arrives, the full list once that preview has been painted. The time to
+  // that first painted image is shown in the performance overlay.
+  void openWhenLoaded(StartupLoader* loader);
+  // True from openWhenLoaded() until the loaded list is in place, which is
+  // announced by opened().
+  bool isOpening() const { return opening_; }
+  // True while the image a step asked for is still being decoded; it is
+  // shown as soon as it is ready, and the previous image stays until then.
+  bool isDisplayPending() const;
+  // Replaces the list and brings the window to the front. Images the old and
+  // new lists share are not decoded again.
+  void openImages(QList<QString> images, int position = 1);
+
+  // Appends key presses and comparison-list edits to a session file at `path`
+  // (see session_log.hpp). False if the file cannot be created.
+  bool startRecording(QString const& path);
+  // Performs one recorded event. Keys that would touch files, open dialogs or
+  // quit are not sent; deleting or moving an image only drops it from the
+  // list, so that the replayed list evolves as the recorded one did.
+  void replayEvent(SessionEvent const& event);
+  // Speed of autoscrolling (Q), in pixels per second.
+  void setAutoScrollSpeed(double pixels_per_second);
+
  protected:
   void moveEvent(QMoveEvent*) override;
   void resizeEvent(QResizeEvent*) override;
   void keyPressEvent(QKeyEvent*) override;
   void keyReleaseEvent(QKeyEvent*) override;
+  void focusOutEvent(QFocusEvent*) override;
   void mousePressEvent(QMouseEvent*) override;
   void wheelEvent(QWheelEvent*) override;
   void mouseDoubleClickEvent(QMouseEvent*) override;
+  void paintEvent(QPaintEvent*) override;
+  void customEvent(QEvent*) override;
 
  private:
   void Construct();
@@ -49,25 +96,92 @@ class MainWindow : public QGraphicsView {
   // fit_zoom_ * zoom_factor_ as the view transform. Single source of truth for
   // all zoom state changes.
   void applyZoom();
+  // Has the decode window prepare frames for the current screen and zoom.
+  void updateFrameTarget();
+  // Fits the image, the split view and the overlays to the viewport.
+  void relayout();
+  // Fast filtering while the view moves, smooth once it has settled.
+  void setSmoothRendering(bool smooth);
   void fitToView();
   void zoomBy(double factor);
   void toggleFitNative();
   void toggleImagesListPanel();
+  // The list panel and the selector dialog are only built when first needed,
+  // so that they stay off the startup path.
+  ImagesListPanel* imagesPanel();
+  ImagesSelectorDialog* selector();
+  void syncPanelEntries();
+  void showStartupResult(StartupLoader::Result result);
+  void finishOpening(StartupLoader::Result result);
   void setComparisonImages(QList<QString> list, int position);
   void rebuildActiveImages(QString const& preferred_path,
                            int fallback_position);
   void applyPanelEntries(QVector<ImageEntry> entries);
+  // Applies one comparison-list edit to the model, then patches the active list
+  // and its decode window in place. Returns false if the model rejected it.
+  bool applyEntryEdit(EntryEdit const& edit);
   void activatePanelImage(QString path);
   void deletePanelImage(QString path);
   void deleteCurrentImage();
+  void moveCurrentImageToFolder();
+  void copyCurrentImageToFolder();
+  void chooseTargetFolder();
+  QString const& targetFolder();
+  // Drops `path` from the comparison list at once and queues the trash/move
+  // of its file; the entry comes back if the operation fails or is undone.
+  void removeImageFile(QString const& path, FileOperationQueue::Kind kind);
+  void restoreRemovedEntry(int operation_id);
   void hideCurrentImage();
   void navigateToPreviousImage();
   void navigateToNextImage();
+  // Whether the next image is decoded and converted; if not, hurries its
+  // decode along.
+  bool prepareNextImage();
   void moveCurrentImage(int offset);
   void copyCurrentImageToClipboard();
-  void showCopyNotification(QString const& path);
+  // Diff mode shades where the displayed image differs from a reference
+  // image, recomputed after every step.
+  void toggleDiffMode();
+  void setDiffReference();
+  void requestDiff();
+  void showDiff(QImage heatmap, DiffStats stats);
+  void placeDiffLabel();
+  // Blinks between the displayed image and the pinned partner: the image
+  // pinned with pinBlinkPartner() or, failing that, the next one.
+  void toggleBlink();
+  void pinBlinkPartner();
+  // False if there is no partner and the next image is not decoded yet.
+  bool ensureBlinkPartner();
+  // Groups the list into near-duplicates in the background; once they are
+  // known, jumpToCluster() steps over a whole group at a time.
+  void findNearDuplicates();
+  void showNearDuplicates(QVector<QString> paths, clusters_t clusters,
+                          qint64 elapsed_ms);
+  void jumpToCluster(int direction);
+  // Split view shows the images that follow the current one beside it; the
+  // main view narrows to the first of `count` equal panes.
+  void setSplitPanes(int count);
+  void updateSplitView();
+  // Shows the statistics of the displayed image on the histogram overlay.
+  void updateHistogram();
+  void showNotification(QString const& title, QString const& text,
+                        QString const& image_path = QString());
   void updatePanelCurrentImage();
+  void noteKeyPress();
+  // Writes a comparison-list edit to the session being recorded, if any.
+  void recordEdit(EntryEdit const& edit);
+  // Disarms the latency measurement of a key press that scheduled neither a
+  // frame nor a repaint; posted behind the repaint a key press causes.
+  void settleKeyPress();
+  QString pathForFileName(QString const& name) const;
+  // Reports the time since the last key press as stepMeasured(). Called once
+  // the frame that followed it has been painted.
+  void recordInputLatency();
   QString currentImagePath() const;
+  // The image on screen, which actions on "the current image" act on: while
+  // a step's frame is pending it is still the previous image, not the one the
+  // list index already points to. Empty if no list image is shown.
+  QString shownImagePath() const;
   bool hasActiveImages() const;
 
   // zoom_factor_ is [kMinZoom, kMaxZoom] relative to fit-to-view.
@@ -75,79 +189,143 @@ class MainWindow : public QGraphicsView {
   static constexpr double kMinZoom = 0.01;
   static constexpr double kMaxZoom = 32.0;
 
+  struct RemovedEntry {
+    int row;
+    ImageEntry entry;
+  };
+
   std::unique_ptr<move_t> move;
   std::unique_ptr<SlidersState> sliders_state;
   std::unique_ptr<WheelScrollingState> wheel_scrolling;
   std::unique_ptr<AutoScrolling> auto_scrolling;
+  double auto_scroll_speed_;
   std::shared_ptr<ImagePath> images_;
   std::shared_ptr<CachedImagesList> cache_;
   std::shared_ptr<FolderPath> folders_;
   ImageComparisonModel comparison_model_;
   ArrowKeysScroller* arrows_scroller_;
-  ImagesSelectorDialog* m_psd;
-  ImagesListPanel* images_panel_;
+  ImagesSelectorDialog* m_psd = nullptr;
+  ImagesListPanel* images_panel_ = nullptr;
   QSystemTrayIcon* tray_icon_;
-  QScreen* currentScreen;
+  FileOperationQueue* file_operations_;
+  // Keyed by file operation id, for as long as the operation can be undone.
+  QHash<int, RemovedEntry> removed_entries_;
+  QString target_folder_;  // destination of move/copy to folder
+  PerformanceHud* hud_;
+  QElapsedTimer key_pressed_;        // valid from a key press to its frame
+  quint64 displays_at_key_press_ = 0;
+  std::unique_ptr<SessionRecorder> recorder_;
+  StartupLoader* startup_ = nullptr;  // until the first image is painted
+  std::optional<StartupLoader::Result> startup_list_;  // behind its preview
+  bool opening_ = false;
   QGraphicsScene* scene_;
   QGraphicsPixmapItem* item_;
+  std::optional<PathId> shown_id_;  // the list image in item_, if any
+  QGraphicsPixmapItem* diff_item_;  // heatmap over item_, in image pixels
+  DiffOverlay* diff_;
+  QLabel* diff_label_;
+  bool diff_mode_ = false;
+  BlinkComparison* blink_;
+  HistogramOverlay* histogram_;
+  Toast* toast_;  // shows MessageBox::inform() messages
+  RenderQuality* render_quality_;
+  QTimer* relayout_;  // throttles relayout() to once per frame
+  bool relayout_pending_ = false;
+  DuplicateFinder* duplicates_ = nullptr;  // built on first use
+  QHash<PathId, int> cluster_of_;          // near-duplicate group by image
+  QVector<int> cluster_sizes_;
+  bool clusters_ready_ = false;
+  SplitView* split_view_;
+  int split_panes_ = 1;       // 1 when split view is off
+  int last_split_panes_ = 2;  // restored when split view is turned back on
   double fit_zoom_ = 1.0;  // scale that fits the current image in the viewport
   double zoom_factor_ =
       1.0;  // user multiplier relative to fit; shared across images
   bool is_fitted_ = true;
 
  signals:
-  void repaintImage();
   void chooseFilesToOpen();
   void displayImageNumber();
+  void stepMeasured(StepSample sample);
+  void opened();
 };
 
+// Scrolls down through the image at a steady speed, dwells at the bottom,
+// moves on to the next image and dwells at its top before scrolling again.
+// Positions follow the time elapsed, not the number of ticks, so a late
+// tick catches up instead of slowing the scroll; a tick that would not move
+// a whole pixel changes nothing, and one that does lets the view blit its
+// contents and paint only the exposed strip. The bottom dwell doubles as a
+// prefetch: it lasts until the next image is decoded and converted, so the
+// step to it never blocks.
 class MainWindow::AutoScrolling : public QObject {
  public:
-  AutoScrolling(MainWindow& main_window)
-      : scrolling_(true),
-        pixels_to_scroll_away_(1),
-        scroll_tick_(15),
-        delay_before_scrolling_(2000),
-        main_window_(main_window),
-        timer_(new QTimer(&main_window_)) {
-    timer_->callOnTimeout(this, &AutoScrolling::Process);
-    timer_->start(delay_before_scrolling_);
-    ToggleState(scroll_tick_);
+  static constexpr double kDefaultSpeed = 60;  // pixels per second
+  static constexpr int kDwellMs = 2000;
+  static constexpr int kTickMs = 16;
+
+  AutoScrolling(MainWindow& main_window, double pixels_per_second)
+      : main_window_(main_window), speed_(pixels_per_second) {
+    timer_.setTimerType(Qt::PreciseTimer);
+    timer_.callOnTimeout(this, &AutoScrolling::Process);
+    StartScrolling();
   }
 
  private:
+  enum class Phase { Scrolling, Bottom, Top };
+
   void Process() {
-    if (scrolling_) {
-      if (!isScrolledToBottom()) {
-        int value =
-            main_window_.verticalScrollBar()->value() + pixels_to_scroll_away_;
-        main_window_.verticalScrollBar()->setValue(value);
-        return;
-      }
-      ToggleState(delay_before_scrolling_);
-    } else {
-      if (isScrolledToBottom()) {
-        main_window_.navigateToNextImage();
-        return;
-      }
-      ToggleState(scroll_tick_);
+    switch (phase_) {
+      case Phase::Scrolling:
+        return Scroll();
+      case Phase::Bottom:
+        return LeaveBottom();
+      case Phase::Top:
+        return isScrolledToBottom() ? LeaveBottom() : StartScrolling();
     }
   }
-  bool isScrolledToBottom() {
-    QScrollBar* sb = main_window_.verticalScrollBar();
-    return sb->value() == sb->maximum();
+  void StartScrolling() {
+    phase_ = Phase::Scrolling;
+    start_value_ = last_value_ = bar()->value();
+    clock_.start();
+    timer_.start(kTickMs);
+  }
+  void Scroll() {
+    // Someone else moved the view: carry on from where it is now.
+    if (bar()->value() != last_value_) StartScrolling();
+    const int value = std::min(
+        bar()->maximum(), start_value_ + int(speed_ * clock_.elapsed() / 1000));
+    if (value != bar()->value()) bar()->setValue(value);
+    last_value_ = bar()->value();
+    if (!isScrolledToBottom()) return;
+    phase_ = Phase::Bottom;
+    main_window_.prepareNextImage();
+    timer_.start(kDwellMs);
+  }
+  void LeaveBottom() {
+    phase_ = Phase::Bottom;
+    // Until the next image is ready; it is checked again every tick.
+    if (!main_window_.prepareNextImage()) {
+      timer_.start(kTickMs);
+      return;
+    }
+    main_window_.navigateToNextImage();
+    phase_ = Phase::Top;
+    main_window_.prepareNextImage();
+    timer_.start(kDwellMs);
   }
-  void ToggleState(int timeout) {
-    scrolling_ = !scrolling_;
-    timer_->start(timeout);
+  QScrollBar* bar() const { return main_window_.verticalScrollBar(); }
+  bool isScrolledToBottom() const {
+    return bar()->value() == bar()->maximum();
   }
 
-  bool scrolling_;
-  const int pixels_to_scroll_away_;
-  const int scroll_tick_;
-  const int delay_before_scrolling_;
   MainWindow& main_window_;
-  QTimer* timer_;
+  const double speed_;
+  Phase phase_ = Phase::Scrolling;
+  int start_value_ = 0;
+  int last_value_ = 0;
+  QElapsedTimer clock_;
+  QTimer timer_;
 };
 
 // Saves and restores the scene point at the centre of the viewport as a
@@ -1,21 +1,24 @@
 #pragma once
 
-#include <QMessageBox>
-#include <QTimer>
+#include <QString>
+#include <functional>
 
+/*
+ * Brief messages from code without a widget of its own, such as the name of
+ * the folder just switched to. They are handed to the sink installed with
+ * SetSink() (the main window's toast) and never block or run an event loop,
+ * so input that follows is handled at once and in order. Without a sink
+ * they are dropped.
+ */
 class MessageBox {
-private:
-  MessageBox() {
-    mb_->setIcon(QMessageBox::NoIcon);
-  }
-  inline static QMessageBox* mb_;
-public:
+ public:
+  using sink_t = std::function<void(QString const& info, int for_time_ms)>;
+
+  static void SetSink(sink_t sink) { sink_ = std::move(sink); }
   static void inform(QString info, int forTime) {
-    if (mb_ == nullptr) {
-      mb_ = new QMessageBox();
-    }
-    mb_->setText(info);
-    QTimer::singleShot(forTime, mb_, &QMessageBox::accept);
-    mb_->exec();
+    if (sink_) sink_(info, forTime);
   }
-};
\ No newline at end of file
+
+ private:
+  inline static sink_t sink_;
+};
@@ -0,0 +1,67 @@
+#pragma once
+
+#include <QByteArray>
+#include <QHash>
+#include <QString>
+#include <QVector>
+#include <QtGlobal>
+#include <optional>
+#include <utility>
+#include <vector>
+
+// A path interned in PathStore::Shared(); equal paths have equal ids.
+using PathId = quint32;
+// Names no path; never returned by PathStore::Intern().
+inline constexpr PathId kNoPath = ~PathId(0);
+
+/*
+ * Interned image paths, for lists of up to millions of files. Such lists live
+ * in a few directories, so a path is stored as a directory id into a small
+ * prefix table plus its file name, UTF-8 encoded, in one growing arena: 12 to
+ * 16 bytes and the length of the name per path, against a heap-allocated
+ * UTF-16 QString of the full path. The comparison model, the list of active
+ * images and the panel all hold ids, and compare them instead of strings.
+ *
+ * Paths are never removed: an id stays valid, and keeps its path, for the
+ * lifetime of the store. Not thread-safe; the shared store belongs to the GUI
+ * thread, and anything handed to a worker is resolved to a QString first.
+ */
+class PathStore {
+ public:
+  // The store the whole viewer shares.
+  static PathStore& Shared();
+
+  // The id of `path`, added if it is new.
+  PathId Intern(QString const& path);
+  // The id of `path` if it has been interned.
+  std::optional<PathId> Find(QString const& path) const;
+  QString Path(PathId id) const;
+  QString FileName(PathId id) const;
+  int Size() const { return int(dir_of_.size()); }
+  // Bytes held by the store, including spare capacity.
+  qint64 MemoryBytes() const;
+
+  QVector<PathId> Intern(QVector<QString> const& paths);
+  QVector<QString> Paths(QVector<PathId> const& ids) const;
+
+ private:
+  static constexpr PathId kEmpty = kNoPath;
+
+  // The directory part of `path` (up to and including the last '/') and the
+  // file name's bytes.
+  static std::pair<QString, QByteArray> Split(QString const& path);
+  static std::size_t Hash(quint32 dir, const char* name, int size);
+  // Where the name of `id` ends in names_.
+  quint32 NameEnd(PathId id) const;
+  // The table slot holding the id of (`dir`, `name`), or the empty slot
+  // where it would go.
+  std::size_t Slot(quint32 dir, QByteArray const& name) const;
+  void Grow();
+
+  QVector<QString> dirs_;
+  QHash<QString, quint32> dir_ids_;
+  std::vector<char> names_;       // every file name, back to back
+  std::vector<quint32> dir_of_;   // by id
+  std::vector<quint32> name_at_;  // by id; the name ends where the next starts
+  std::vector<PathId> table_;     // open addressing, kEmpty for a free slot
+};
@@ -0,0 +1,39 @@
+#pragma once
+
+#include <QImage>
+#include <QString>
+#include <QVector>
+#include <bit>
+#include <optional>
+
+#include "preview_cache.hpp"
+
+/*
+ * Perceptual hashes for finding near-duplicates, e.g. the shots of a burst.
+ * The 64-bit difference hash (dHash) records, for a 9x8 grey thumbnail,
+ * whether each pixel is darker than its right neighbour, so it survives
+ * rescaling, recompression and small exposure changes; similar images have
+ * hashes a small Hamming distance apart.
+ */
+
+// Near-duplicate groups: each cluster holds the indices of two or more
+// hashes, ascending; clusters are ordered by their first index.
+using clusters_t = QVector<QVector<int>>;
+
+quint64 DifferenceHash(QImage const& image);
+
+inline int HammingDistance(quint64 a, quint64 b) {
+  return std::popcount(a ^ b);
+}
+
+// Hashes the image at `path`, from its preview in `cache` if there is an
+// up-to-date one; nothing if the image cannot be read.
+std::optional<quint64> HashImage(QString const& path,
+                                 PreviewCache const& cache);
+
+// Groups hashes that are within `max_distance` of each other, transitively.
+// Pairs are found by multi-index hashing: split into max_distance + 1 bit
+// blocks, two hashes that close agree on at least one whole block, so only
+// hashes sharing a block are ever compared. Missing hashes join no cluster.
+clusters_t NearDuplicateClusters(
+    QVector<std::optional<quint64>> const& hashes, int max_distance);
@@ -0,0 +1,36 @@
+#pragma once
+
+#include <QTimer>
+#include <QWidget>
+#include <functional>
+
+#include "performance_stats.hpp"
+
+/*
+ * Translucent overlay in the corner of the viewer with live performance
+ * numbers: key-press-to-paint latency (percentiles and a histogram over the
+ * last StepStats::kWindow steps), how many steps found their image ready or
+ * had to wait for its decode, the state of the decode window and how long
+ * startup took to paint the first image. Refreshes itself only while visible.
+ */
+class PerformanceHud : public QWidget {
+  Q_OBJECT
+ public:
+  explicit PerformanceHud(QWidget* parent = nullptr);
+
+  void SetCacheStatsSource(std::function<CacheStats()> source);
+  void RecordStep(StepSample const& sample);
+  void SetStartupTime(qint64 first_image_ms);
+  void Toggle();
+
+ protected:
+  void paintEvent(QPaintEvent*) override;
+
+ private:
+  QStringList Lines() const;
+
+  StepStats steps_;
+  std::function<CacheStats()> cache_stats_;
+  qint64 first_image_ms_ = -1;
+  QTimer refresh_;
+};
@@ -0,0 +1,105 @@
+#pragma once
+
+#include <QtGlobal>
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <optional>
+#include <utility>
+#include <vector>
+
+// How the frame shown for a CachedImagesList::DisplayImage() got its pixmap.
+enum class SlotResolve {
+  Ready,      // already converted in the background
+  Converted,  // decoded, converted on demand
+  Blocked,    // decode still running, the frame waited for it
+};
+
+// Snapshot of the decode window.
+struct CacheStats {
+  int size = 0;      // images in the window
+  int ready = 0;     // ... already converted to pixmaps
+  int decoding = 0;  // ... whose decode has not finished
+  qint64 bytes = 0;  // memory held by the ready pixmaps
+};
+
+// One input step: the time from a key press to the next painted frame and,
+// if the step displayed another image, how that image was resolved and how
+// long the GUI thread waited for its decode.
+struct StepSample {
+  double latency_ms = 0;
+  std::optional<SlotResolve> resolve;
+  double wait_ms = 0;
+};
+
+// Nearest-rank percentile of `values`, `p` in [0, 1]; 0 when empty.
+inline double Percentile(std::vector<double> values, double p) {
+  if (values.empty()) return 0;
+  const int count = values.size();
+  const int rank = std::clamp(int(std::ceil(p * count)) - 1, 0, count - 1);
+  std::nth_element(values.begin(), values.begin() + rank, values.end());
+  return values[rank];
+}
+
+/*
+ * Rolling record of the last kWindow input steps: the time from a key press to
+ * the next painted frame, and, when the step displayed another image, how that
+ * image was resolved. Backs the performance overlay.
+ */
+class StepStats {
+ public:
+  static constexpr int kWindow = 128;
+  // Upper bounds (ms) of the histogram buckets; one more open-ended bucket
+  // collects everything slower.
+  static constexpr std::array<double, 7> kBucketLimits{8,   16,  33, 50,
+                                                       100, 250, 500};
+  using histogram_t = std::array<int, kBucketLimits.size() + 1>;
+
+  void Record(double latency_ms, std::optional<SlotResolve> resolve = {},
+              double wait_ms = 0) {
+    Record(StepSample{latency_ms, resolve, wait_ms});
+  }
+  void Record(StepSample const& sample) {
+    steps_[next_] = sample;
+    next_ = (next_ + 1) % kWindow;
+    count_ = std::min(count_ + 1, kWindow);
+  }
+  int Count() const { return count_; }
+
+  double Percentile(double p) const {
+    std::vector<double> latencies;
+    latencies.reserve(count_);
+    for (int i = 0; i < count_; ++i) latencies.push_back(steps_[i].latency_ms);
+    return ::Percentile(std::move(latencies), p);
+  }
+  int CountOf(SlotResolve resolve) const {
+    return std::count_if(steps_.begin(), steps_.begin() + count_,
+                         [resolve](StepSample const& step) {
+                           return step.resolve == resolve;
+                         });
+  }
+  // Mean time the blocked steps spent waiting for their decode.
+  double MeanBlockedWaitMs() const {
+    double total = 0;
+    for (int i = 0; i < count_; ++i)
+      if (steps_[i].resolve == SlotResolve::Blocked) total += steps_[i].wait_ms;
+    const int blocked = CountOf(SlotResolve::Blocked);
+    return blocked == 0 ? 0 : total / blocked;
+  }
+  histogram_t Histogram() const {
+    histogram_t histogram{};
+    for (int i = 0; i < count_; ++i) {
+      const auto bucket =
+          std::lower_bound(kBucketLimits.begin(), kBucketLimits.end(),
+                           steps_[i].latency_ms) -
+          kBucketLimits.begin();
+      ++histogram[bucket];
+    }
+    return histogram;
+  }
+
+ private:
+  std::array<StepSample, kWindow> steps_{};
+  int next_ = 0;
+  int count_ = 0;
+};
@@ -0,0 +1,27 @@
+#pragma once
+
+#include <QImage>
+#include <QtGlobal>
+
+#include "simd_level.hpp"
+
+/*
+ * Per-pixel comparison of two images for the diff overlay. The difference of
+ * a pixel is its largest absolute channel difference (alpha is ignored). The
+ * rows are split into bands that run on all cores, and each row goes through
+ * the widest vector kernel the CPU has.
+ */
+
+struct DiffStats {
+  qint64 pixels = 0;   // compared: the area the two images have in common
+  qint64 changed = 0;  // ... whose difference is above the threshold
+  int max_delta = 0;   // largest difference of any pixel
+};
+
+// Compares `a` and `b` over their common top-left area. If `heatmap` is
+// given it receives, for that area, a premultiplied red overlay whose alpha
+// is each pixel's difference times `gain` (1 to 127), capped at opaque.
+// `threshold` is 0 to 255.
+DiffStats PixelDiff(QImage const& a, QImage const& b, int threshold, int gain,
+                    QImage* heatmap = nullptr,
+                    SimdLevel level = BestSimdLevel());
@@ -0,0 +1,66 @@
+#pragma once
+
+#include <QImage>
+#include <QSize>
+#include <QString>
+#include <QStringList>
+#include <functional>
+#include <optional>
+
+/*
+ * Screen-sized previews of images, kept on disk between sessions. Each entry
+ * holds the preview together with the image's full size and the size and
+ * modification time of the file it was made from; an entry whose file has
+ * changed since is never returned. Entries are written atomically, so any
+ * number of threads and processes may share one cache directory.
+ */
+class PreviewCache {
+ public:
+  // Previews fit in this box: a 1080p screen in either orientation. Larger
+  // screens skip the cache at startup rather than show a blurry preview.
+  static constexpr QSize kBound{1920, 1920};
+
+  struct Entry {
+    QImage preview;
+    QSize image_size;  // of the full image
+  };
+
+  explicit PreviewCache(QString directory = DefaultDirectory());
+
+  // Under the user's cache location, e.g. ~/.cache/pviewer/previews.
+  static QString DefaultDirectory();
+  QString const& Directory() const { return directory_; }
+
+  // Whether an up-to-date entry for `path` exists; cheaper than Find().
+  bool Contains(QString const& path) const;
+  // With a valid `bound` the preview is decoded no larger than that, which
+  // for a JPEG entry skips most of the work.
+  std::optional<Entry> Find(QString const& path, QSize bound = QSize()) const;
+  // Decodes `path` to a preview no larger than `bound` and stores it. False
+  // if the image cannot be read or the entry cannot be written.
+  bool Store(QString const& path, QSize bound = kBound) const;
+
+ private:
+  QString EntryPath(QString const& path) const;
+
+  QString directory_;
+};
+
+// Progress of Prefetch(), also its final report.
+struct PrefetchStats {
+  int images = 0;   // found in the walked folders
+  int done = 0;     // ... handled so far
+  int stored = 0;   // ... given a new preview
+  int fresh = 0;    // ... whose preview was already up to date
+  int failed = 0;   // ... that could not be read or stored
+  qint64 bytes = 0;  // read from the images given new previews
+  qint64 elapsed_ms = 0;
+};
+
+// Walks `directories` and their subfolders and stores a preview for every
+// supported image that has no up-to-date one, on all cores. `progress` is
+// called on the calling thread every `interval_ms` while that runs.
+PrefetchStats Prefetch(QStringList const& directories,
+                       PreviewCache const& cache,
+                       std::function<void(PrefetchStats const&)> progress = {},
+                       int interval_ms = 500);
@@ -0,0 +1,28 @@
+#pragma once
+
+#include <QObject>
+#include <QTimer>
+
+/*
+ * Trades image quality for speed while the view is in motion. Every
+ * Interact() (a scroll step, a resize) switches to fast, nearest-neighbour
+ * filtering; once none has come for kIdleMs the view is told to repaint
+ * with smooth filtering. Bursts of interaction cost one switch each way.
+ */
+class RenderQuality : public QObject {
+  Q_OBJECT
+ public:
+  static constexpr int kIdleMs = 100;
+
+  explicit RenderQuality(QObject* parent = nullptr);
+
+  void Interact();
+  bool IsSmooth() const { return smooth_; }
+
+ signals:
+  void changed(bool smooth);
+
+ private:
+  QTimer idle_;
+  bool smooth_ = true;
+};
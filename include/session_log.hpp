@@ -0,0 +1,49 @@
+#pragma once
+
+#include <QElapsedTimer>
+#include <QFile>
+#include <QString>
+#include <QVector>
+#include <optional>
+
+#include "image_comparison_model.hpp"
+
+/*
+ * A recorded viewing session: key presses and releases, comparison-list edits
+ * and activations, each stamped with the time since recording started. Stored
+ * as one JSON object per line, so a session cut short by a crash is still
+ * readable up to its last event.
+ *
+ * Images are referred to by file name only, which lets a session recorded on
+ * one copy of a folder be replayed against another.
+ */
+struct SessionEvent {
+  enum class Type { KeyPress, KeyRelease, Edit, Activate };
+
+  qint64 time_ms = 0;
+  Type type = Type::KeyPress;
+  int key = 0;           // KeyPress / KeyRelease
+  int modifiers = 0;     // KeyPress / KeyRelease, a Qt::KeyboardModifiers
+  bool repeat = false;   // KeyPress / KeyRelease, auto-repeated
+  EntryEdit edit{};      // Edit; edit.path is a file name
+  QString name{};        // Activate: file name of the activated image
+};
+
+QByteArray ToJsonLine(SessionEvent const& event);
+std::optional<SessionEvent> FromJsonLine(QByteArray const& line);
+
+// Reads a whole session file. Lines that do not parse are skipped.
+QVector<SessionEvent> ReadSession(QString const& path, QString* error);
+
+class SessionRecorder {
+ public:
+  // Starts the clock; check IsOpen() for whether `path` could be created.
+  explicit SessionRecorder(QString const& path);
+  bool IsOpen() const { return file_.isOpen(); }
+  // Stamps `event` with the current session time and appends it.
+  void Record(SessionEvent event);
+
+ private:
+  QFile file_;
+  QElapsedTimer clock_;
+};
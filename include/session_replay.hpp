@@ -0,0 +1,45 @@
+#pragma once
+
+#include <QObject>
+#include <QTimer>
+#include <QVector>
+#include <vector>
+
+#include "performance_stats.hpp"
+#include "session_log.hpp"
+
+class MainWindow;
+
+/*
+ * Drives a MainWindow through a recorded session with the recorded timing and
+ * measures every step, for reproducing "it stutters on this folder" reports
+ * headless. Idle gaps are capped at kMaxGapMs, so a session with long pauses
+ * still replays in reasonable time (the decode window gets less time to fill
+ * during those pauses than it had originally).
+ */
+class SessionReplay : public QObject {
+  Q_OBJECT
+ public:
+  static constexpr qint64 kMaxGapMs = 2000;
+  // Time left after the last event for its frame to be painted.
+  static constexpr int kSettleMs = 500;
+
+  SessionReplay(QVector<SessionEvent> events, MainWindow* window,
+                QObject* parent = nullptr);
+  void Start();
+  // Step latency percentiles, how the steps resolved their images, and the
+  // peak resident memory of the process.
+  QString Report() const;
+
+ signals:
+  void finished();
+
+ private:
+  void ScheduleNext();
+
+  QVector<SessionEvent> events_;
+  int next_ = 0;
+  MainWindow* window_;
+  std::vector<StepSample> samples_;
+  QTimer timer_;
+};
@@ -0,0 +1,38 @@
+#pragma once
+
+/*
+ * Run-time choice between the scalar and x86 vector versions of a kernel.
+ * Vector kernels are compiled with per-function target attributes, so the
+ * build needs no special flags and the same binary runs on any x86 CPU.
+ */
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#define PVIEWER_X86_SIMD
+#endif
+
+enum class SimdLevel { Scalar, Sse2, Avx2 };
+
+inline bool IsSupported(SimdLevel level) {
+  switch (level) {
+    case SimdLevel::Scalar:
+      return true;
+#ifdef PVIEWER_X86_SIMD
+    case SimdLevel::Sse2:
+      return __builtin_cpu_supports("sse2");
+    case SimdLevel::Avx2:
+      return __builtin_cpu_supports("avx2");
+#endif
+    default:
+      return false;
+  }
+}
+
+// The widest level this CPU supports.
+inline SimdLevel BestSimdLevel() {
+  static const SimdLevel best = [] {
+    for (SimdLevel level : {SimdLevel::Avx2, SimdLevel::Sse2})
+      if (IsSupported(level)) return level;
+    return SimdLevel::Scalar;
+  }();
+  return best;
+}
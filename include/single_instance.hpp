@@ -0,0 +1,42 @@
+#pragma once
+
+#include <QObject>
+#include <QString>
+#include <QStringList>
+
+class QLocalServer;
+
+/*
+ * Lets repeated launches reuse one running viewer. The running viewer
+ * Listen()s on a per-user local socket; a later launch Forward()s its
+ * arguments there and exits instead of starting Qt's GUI, fonts and plugins
+ * and decoding everything again. Forwarded arguments must not depend on the
+ * sender's working directory, i.e. paths have to be absolute.
+ */
+class SingleInstance : public QObject {
+  Q_OBJECT
+ public:
+  static constexpr int kForwardTimeoutMs = 1000;
+
+  explicit SingleInstance(QObject* parent = nullptr);
+
+  // Per-user socket name, so that users never open each other's images.
+  static QString DefaultName();
+  // Hands `arguments` to the viewer listening on `name`. True once that
+  // viewer has acknowledged them; false if none is running or it does not
+  // answer in time. Needs no QCoreApplication, so it can run before one is
+  // created.
+  static bool Forward(QString const& name, QStringList const& arguments,
+                      int timeout_ms = kForwardTimeoutMs);
+  // Starts accepting forwarded arguments. A socket left behind by a viewer
+  // that crashed is taken over; one that still accepts connections is not.
+  bool Listen(QString const& name);
+
+ signals:
+  void argumentsReceived(QStringList arguments);
+
+ private:
+  void Accept();
+
+  QLocalServer* server_;
+};
@@ -0,0 +1,50 @@
+#pragma once
+
+#include <QPixmap>
+#include <QVector>
+#include <QWidget>
+
+/*
+ * The extra panes of split view, shown beside the main view. Each pane
+ * shows one of the images that follow the current one, straight from the
+ * decode window. All panes mirror the main view: the same zoom factor
+ * relative to fit-to-pane and the same centre as a fraction of the image,
+ * so panning or zooming moves every image together. Painting scales only
+ * the part of each image that is visible in its pane.
+ */
+class SplitView : public QWidget {
+  Q_OBJECT
+ public:
+  static constexpr int kMaxPanes = 4;  // including the main view
+
+  struct Pane {
+    QString name;
+    QPixmap pixmap;  // null while the image is still being decoded
+  };
+
+  explicit SplitView(QWidget* parent = nullptr);
+
+  // `panes` are laid out left to right; an empty name leaves a pane blank.
+  void SetPanes(QVector<Pane> panes);
+  // `center` is a fraction of the image, (0.5, 0.5) being its middle.
+  void SetView(double zoom_factor, QPointF center);
+  // Smooth (bilinear) scaling, the default, or fast nearest-neighbour.
+  void SetSmooth(bool smooth);
+  int PaneCount() const { return panes_.size(); }
+
+  // The part of an `image`-sized picture that is visible in a `pane` when
+  // it is scaled by `scale` and centred on `center`, limited like a
+  // scrolled view: a picture smaller than the pane is centred in it.
+  // `target`, if given, receives where that part lands within the pane.
+  static QRectF VisibleSource(QSizeF image, QSizeF pane, double scale,
+                              QPointF center, QRectF* target = nullptr);
+
+ protected:
+  void paintEvent(QPaintEvent*) override;
+
+ private:
+  QVector<Pane> panes_;
+  double zoom_factor_ = 1.0;
+  QPointF center_{0.5, 0.5};
+  bool smooth_ = true;
+};
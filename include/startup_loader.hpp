@@ -0,0 +1,59 @@
+#pragma once
+
+#include <QElapsedTimer>
+#include <QImage>
+#include <QObject>
+#include <QSize>
+#include <QThreadPool>
+#include <functional>
+
+#include "preview_cache.hpp"
+
+/*
+ * Gets the first image on screen as early as possible. The image list is
+ * built (for a directory: listed and sorted) on a worker thread while the
+ * window is still being constructed. The start image then comes from the
+ * preview cache (see `pviewer --prefetch`) or, failing that, is decoded
+ * scaled down to the screen, which for JPEG skips most of the work. A target
+ * larger than PreviewCache::kBound, as on a HiDPI screen, always decodes: a
+ * cached preview would be scaled up on screen. The full list arrives
+ * together with that preview; the window shows the preview first and hands
+ * the list to the decode window afterwards.
+ *
+ * The clock behind ElapsedMs() starts with the loader, so the window can
+ * report the time to its first painted image.
+ */
+class StartupLoader : public QObject {
+  Q_OBJECT
+ public:
+  struct Result {
+    QList<QString> images;
+    int position = 1;  // of the start image, 1-based, within `images`
+    QImage preview;    // the start image, scaled to fit the target size
+    QSize image_size;  // full size of the start image
+  };
+
+  // `target` is the preview bound in device pixels, usually the screen.
+  explicit StartupLoader(QSize target, PreviewCache cache = PreviewCache(),
+                         QObject* parent = nullptr);
+
+  void LoadDirectory(QString path, int position);
+  void LoadImages(QList<QString> images, int position = 1);
+  qint64 ElapsedMs() const { return clock_.elapsed(); }
+
+  // Decodes `path` no larger than `target`; never scales up.
+  static QImage Preview(QString const& path, QSize target,
+                        QSize* image_size = nullptr);
+
+ signals:
+  // Emitted once on the GUI thread; `images` is empty if nothing was found.
+  void loaded(StartupLoader::Result result);
+
+ private:
+  void Start(std::function<QList<QString>()> list, int position);
+
+  const QSize target_;
+  const PreviewCache cache_;
+  QElapsedTimer clock_;
+  QThreadPool pool_;
+};
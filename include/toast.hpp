@@ -0,0 +1,24 @@
+#pragma once
+
+#include <QLabel>
+#include <QTimer>
+
+/*
+ * A message laid over the view for a while, centred near its top: the
+ * folder switched to, the image number, a failed operation. Showing one is
+ * instant and takes no input away from the view; a new message replaces
+ * the one on screen and restarts its time.
+ */
+class Toast : public QLabel {
+  Q_OBJECT
+ public:
+  explicit Toast(QWidget* parent = nullptr);
+
+  void Show(QString const& text, int duration_ms);
+  // Keeps the toast centred on `area`, e.g. the viewport after a resize.
+  void Place(QRect const& area);
+
+ private:
+  QTimer expiry_;
+  QRect area_;
+};
@@ -0,0 +1,91 @@
+#pragma once
+
+#include <QString>
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+/*
+ * Timestamped trace events for the navigation and decode paths. Each thread
+ * records into its own fixed-size ring, so a trace point never takes a lock
+ * and never allocates after the first one on a thread; once a ring is full
+ * its oldest events are overwritten. A ring goes with its thread, unless it
+ * holds events still to be exported. While tracing is stopped a trace point
+ * costs one relaxed load, and nothing at all in builds without
+ * PVIEWER_TRACING.
+ *
+ * The rings export as Chrome trace JSON, which chrome://tracing and
+ * ui.perfetto.dev open directly. Event and argument names are stored as
+ * pointers, so they must be string literals.
+ */
+namespace trace {
+
+constexpr std::size_t kEventsPerThread = std::size_t{1} << 13;
+
+namespace detail {
+
+extern std::atomic<bool> enabled;
+
+inline std::int64_t Now() {
+  return std::chrono::duration_cast<std::chrono::nanoseconds>(
+             std::chrono::steady_clock::now().time_since_epoch())
+      .count();
+}
+// `duration` < 0 records an instant event.
+void Record(const char* name, std::int64_t start, std::int64_t duration,
+            const char* arg_name, std::int64_t arg);
+
+}  // namespace detail
+
+inline bool Enabled() {
+#ifdef PVIEWER_TRACING
+  return detail::enabled.load(std::memory_order_relaxed);
+#else
+  return false;
+#endif
+}
+
+void Start();
+void Stop();
+// Drops every recorded event, and the threads that have ended; the names of
+// the others are kept.
+void Clear();
+// Label for the calling thread in the exported trace. Ignored while tracing
+// is stopped, so name threads where they start working.
+void NameThread(const char* name);
+
+std::string ChromeJson();
+bool WriteChromeJson(QString const& path);
+
+// A point in time, e.g. a key press.
+inline void Instant(const char* name, const char* arg_name = nullptr,
+                    std::int64_t arg = 0) {
+  if (Enabled()) detail::Record(name, detail::Now(), -1, arg_name, arg);
+}
+
+// A span covering the lifetime of the object.
+class Scope {
+ public:
+  explicit Scope(const char* name, const char* arg_name = nullptr,
+                 std::int64_t arg = 0)
+      : name_(Enabled() ? name : nullptr),
+        arg_name_(arg_name),
+        arg_(arg),
+        start_(name_ ? detail::Now() : 0) {}
+  ~Scope() {
+    if (name_)
+      detail::Record(name_, start_, detail::Now() - start_, arg_name_, arg_);
+  }
+  Scope(Scope const&) = delete;
+  Scope& operator=(Scope const&) = delete;
+
+ private:
+  const char* const name_;
+  const char* const arg_name_;
+  const std::int64_t arg_;
+  const std::int64_t start_;
+};
+
+}  // namespace trace
@@ -1,37 +1,59 @@
 #include "arrow_keys_scroller.hpp"
 
-ArrowKeysScroller::ArrowKeysScroller(QScrollBar* h, QScrollBar* v)
-    : horizontal_(h), vertical_(v) {
-  k.emplace(Qt::Key_Down,
-            std::bind(scroll, increment, &QAbstractSlider::maximum, vertical_));
-  k.emplace(Qt::Key_Right, std::bind(scroll, increment,
-                                     &QAbstractSlider::maximum, horizontal_));
-  k.emplace(Qt::Key_Left, std::bind(scroll, decrement,
-                                    &QAbstractSlider::minimum, horizontal_));
-  k.emplace(Qt::Key_Up,
-            std::bind(scroll, decrement, &QAbstractSlider::minimum, vertical_));
-  connect(&timer, &QTimer::timeout, this, &ArrowKeysScroller::Scroll);
-  timer.setInterval(5);
-}
-
-int ArrowKeysScroller::increment(int a, int b) { return a + b; }
-int ArrowKeysScroller::decrement(int a, int b) { return a - b; }
-
-void ArrowKeysScroller::scroll(std::function<int(int, int)> op,
-                       int (QAbstractSlider::*f)() const,
-                       QAbstractSlider* slider) {
-  int sliderShift = 5;
-  if (slider->value() != (slider->*f)()) {
-    slider->setValue(op(slider->value(), sliderShift));
+#include <QScreen>
+#include <algorithm>
+#include <cmath>
+
+ArrowKeysScroller::ArrowKeysScroller(QScrollBar* h, QScrollBar* v,
+                                     Profile profile)
+    : profile_(profile), horizontal_(h), vertical_(v) {
+  timer_.setTimerType(Qt::PreciseTimer);
+  connect(&timer_, &QTimer::timeout, this, &ArrowKeysScroller::Scroll);
+}
+
+double ArrowKeysScroller::Speed(Profile const& profile, double held_ms) {
+  const double progress =
+      profile.ramp_ms > 0 ? std::clamp(held_ms / profile.ramp_ms, 0.0, 1.0)
+                          : 1.0;
+  double ramp = 0;
+  switch (profile.curve) {
+    case Curve::Constant:
+      ramp = 0;
+      break;
+    case Curve::Linear:
+      ramp = progress;
+      break;
+    case Curve::EaseIn:
+      ramp = progress * progress;
+      break;
   }
+  return profile.initial_speed +
+         (profile.max_speed - profile.initial_speed) * ramp;
+}
+
+int ArrowKeysScroller::FrameIntervalMs() const {
+  QScreen* screen = vertical_->screen();
+  const qreal rate = screen ? screen->refreshRate() : 60;
+  return std::max(1, qRound(1000 / std::max<qreal>(rate, 1)));
+}
+
+void ArrowKeysScroller::Step(QScrollBar* bar, double distance,
+                             double* remainder) {
+  *remainder += distance;
+  const double whole = std::trunc(*remainder);
+  *remainder -= whole;
+  if (whole != 0) bar->setValue(bar->value() + int(whole));
 }
 
 void ArrowKeysScroller::Scroll() {
-  for (auto i = k.begin(); i != k.end(); ++i) {
-    if (i->second.pressed) {
-      i->second.func();
-    }
-  }
+  const int x = held_[Right] - held_[Left];
+  const int y = held_[Down] - held_[Up];
+  const double seconds = last_step_.nsecsElapsed() / 1e9;
+  last_step_.restart();
+  const double distance = Speed(profile_, held_for_.elapsed()) * seconds;
+  if (x != 0) Step(horizontal_, x * distance, &remainder_x_);
+  if (y != 0) Step(vertical_, y * distance, &remainder_y_);
+  emit scrolled();
 }
 
 bool ArrowKeysScroller::isNoModifier(const QKeyEvent* const event) {
@@ -44,12 +66,40 @@ bool ArrowKeysScroller::isArrowKeys(const QKeyEvent* const event) {
 }
 
 void ArrowKeysScroller::setKeyState(QKeyEvent* event) {
-  Qt::Key key = static_cast<Qt::Key>(event->key());
-  if (event->type() == QEvent::KeyPress) {
-    k.find(key)->second.pressed = true;
+  Direction direction;
+  switch (event->key()) {
+    case Qt::Key_Up:
+      direction = Up;
+      break;
+    case Qt::Key_Down:
+      direction = Down;
+      break;
+    case Qt::Key_Left:
+      direction = Left;
+      break;
+    case Qt::Key_Right:
+      direction = Right;
+      break;
+    default:
+      return;
   }
   if (event->type() == QEvent::KeyRelease) {
-    k.find(key)->second.pressed = false;
+    held_[direction] = false;
+    if (std::none_of(std::begin(held_), std::end(held_),
+                     [](bool held) { return held; }))
+      releaseAll();
+    return;
   }
-  timer.start();
-}
\ No newline at end of file
+  if (event->type() != QEvent::KeyPress || held_[direction]) return;
+  held_[direction] = true;
+  if (timer_.isActive()) return;
+  held_for_.start();
+  last_step_.start();
+  remainder_x_ = remainder_y_ = 0;
+  timer_.start(FrameIntervalMs());
+}
+
+void ArrowKeysScroller::releaseAll() {
+  std::fill(std::begin(held_), std::end(held_), false);
+  timer_.stop();
+}
@@ -0,0 +1,55 @@
+#include "blink_comparison.hpp"
+
+BlinkComparison::BlinkComparison(QGraphicsPixmapItem* base, QObject* parent)
+    : QObject(parent), base_(base), partner_(new QGraphicsPixmapItem(base)) {
+  partner_->setTransformationMode(base_->transformationMode());
+  partner_->hide();
+  timer_.setTimerType(Qt::PreciseTimer);
+  timer_.setInterval(kIntervalMs);
+  timer_.callOnTimeout(this, [this] { ShowPartner(!IsPartnerShown()); });
+}
+
+void BlinkComparison::Pin(QPixmap partner) {
+  partner_->setPixmap(std::move(partner));
+  BaseChanged();
+}
+
+void BlinkComparison::Start() {
+  if (!HasPartner() || base_->pixmap().isNull()) return;
+  SetCaching(true);
+  timer_.start();
+  ShowPartner(true);
+}
+
+void BlinkComparison::Stop() {
+  timer_.stop();
+  ShowPartner(false);
+  SetCaching(false);
+}
+
+void BlinkComparison::ShowPartner(bool shown) {
+  partner_->setVisible(shown && HasPartner() && !base_->pixmap().isNull());
+}
+
+void BlinkComparison::BaseChanged() {
+  if (base_->pixmap().isNull() || !HasPartner()) {
+    Stop();
+    return;
+  }
+  // Partners of another size are matched by width, like a preview that
+  // stands in for its image.
+  partner_->setScale(qreal(base_->pixmap().width()) /
+                     partner_->pixmap().width());
+}
+
+void BlinkComparison::SetTransformationMode(Qt::TransformationMode mode) {
+  base_->setTransformationMode(mode);
+  partner_->setTransformationMode(mode);
+}
+
+void BlinkComparison::SetCaching(bool caching) {
+  const auto mode = caching ? QGraphicsItem::DeviceCoordinateCache
+                            : QGraphicsItem::NoCache;
+  base_->setCacheMode(mode);
+  partner_->setCacheMode(mode);
+}
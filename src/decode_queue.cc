@@ -0,0 +1,260 @@
+#include "decode_queue.hpp"
+
+#include <QDebug>
+#include <QFileInfo>
+#include <QMutexLocker>
+#include <utility>
+
+#include "frame_target.hpp"
+#include "trace.hpp"
+
+namespace {
+
+constexpr std::size_t kRingCapacity = 64;
+
+}  // namespace
+
+std::int64_t DecodeTask::NextId() {
+  static std::atomic<std::int64_t> next{0};
+  return ++next;
+}
+
+void DecodeTask::SetFrame(QImage frame, QSize target) {
+  QMutexLocker locker(&mutex_);
+  frame_ = std::move(frame);
+  frame_target_ = target;
+}
+
+QSize DecodeTask::FrameTarget() const {
+  QMutexLocker locker(&mutex_);
+  return frame_target_;
+}
+
+bool DecodeTask::FrameFits(QSize target) const {
+  QMutexLocker locker(&mutex_);
+  return SameFrame(image_.size(), frame_target_, target);
+}
+
+bool DecodeTask::HasFrame() const {
+  QMutexLocker locker(&mutex_);
+  return !frame_.isNull();
+}
+
+QImage DecodeTask::TakeFrame() {
+  QMutexLocker locker(&mutex_);
+  return std::exchange(frame_, QImage());
+}
+
+void DecodeTask::Finish(QImage image, QDateTime modified) {
+  QMutexLocker locker(&mutex_);
+  image_ = std::move(image);
+  modified_ = std::move(modified);
+  state_.store(State::Done);
+  done_.wakeAll();
+}
+
+std::shared_ptr<const ImageStats> DecodeTask::Stats() const {
+  QMutexLocker locker(&mutex_);
+  return stats_;
+}
+
+void DecodeTask::SetStats(ImageStats stats) {
+  auto shared = std::make_shared<const ImageStats>(std::move(stats));
+  QMutexLocker locker(&mutex_);
+  stats_ = std::move(shared);
+}
+
+QImage const& DecodeTask::Wait() {
+  QMutexLocker locker(&mutex_);
+  while (state_.load() != State::Done) done_.wait(&mutex_);
+  return image_;
+}
+
+DecodeQueue::DecodeQueue(int workers, QObject* parent)
+    : QObject(parent),
+      requests_(kRingCapacity),
+      deferred_(kRingCapacity),
+      completions_(kRingCapacity) {
+  expedited_.setMaxThreadCount(1);
+  for (int i = 0; i < std::max(workers, 1); ++i) {
+    workers_.emplace_back(QThread::create([this] { WorkerLoop(); }));
+    workers_.back()->start();
+  }
+}
+
+DecodeQueue::~DecodeQueue() {
+  stopping_.store(true);
+  available_.release(static_cast<int>(workers_.size()));
+  for (auto& worker : workers_) worker->wait();
+}
+
+decode_task_t DecodeQueue::Submit(QString path) {
+  auto task = std::make_shared<DecodeTask>(std::move(path));
+  trace::Instant("enqueue", "task", task->Id());
+  Enqueue(task);
+  return task;
+}
+
+QImage const& DecodeQueue::Result(decode_task_t const& task) {
+  if (task->Claim()) {
+    Decode(*task, FrameTarget());
+    Enqueue(task);
+  } else if (!task->IsDone()) {
+    trace::Scope scope("wait for decode", "task", task->Id());
+    return task->Wait();
+  }
+  return task->Wait();
+}
+
+void DecodeQueue::Prefetch(decode_task_t const& task) {
+  // A second entry for a task that is queued already is harmless: whichever
+  // worker gets to it last finds it claimed.
+  task->SetDeferred(false);
+  if (task->IsQueued()) Enqueue(task);
+}
+
+void DecodeQueue::Defer(decode_task_t const& task) {
+  // Takes effect when a worker takes the task's entry from the requests.
+  if (task->IsQueued()) task->SetDeferred(true);
+}
+
+void DecodeQueue::Expedite(decode_task_t const& task) {
+  task->SetDeferred(false);
+  if (!task->IsQueued()) return;
+  expedited_.clear();
+  expedited_.start([this, task] {
+    trace::NameThread("expedited decode");
+    // The image alone: the statistics go to the workers, so that the next
+    // expedited decode never waits behind them.
+    if (!task->Claim()) return;
+    Decode(*task, FrameTarget());
+    Announce(task);
+    Enqueue(task);
+  });
+}
+
+void DecodeQueue::Revalidate(decode_task_t const& task) {
+  task->RequestCheck();
+  Enqueue(task);
+}
+
+void DecodeQueue::SetFrameTarget(QSize target) {
+  QMutexLocker locker(&target_mutex_);
+  frame_target_ = target;
+}
+
+QSize DecodeQueue::FrameTarget() const {
+  QMutexLocker locker(&target_mutex_);
+  return frame_target_;
+}
+
+void DecodeQueue::Retarget(decode_task_t const& task) {
+  if (!task->IsDone() || task->FrameFits(FrameTarget())) return;
+  expedited_.start([this, task] {
+    trace::NameThread("expedited decode");
+    // The target may have moved on again while this was waiting.
+    const QSize target = FrameTarget();
+    if (task->FrameFits(target)) return;
+    PrepareFrame(*task, target);
+    Announce(task);
+  });
+}
+
+void DecodeQueue::PrepareFrame(DecodeTask& task, QSize target) {
+  task.SetFrame(FitToTarget(task.Wait(), target), target);
+}
+
+void DecodeQueue::Decode(DecodeTask& task, QSize target) {
+  trace::Scope scope("decode", "task", task.Id());
+  // Taken first, so that a change made while decoding is never missed.
+  QDateTime modified = QFileInfo(task.Path()).lastModified();
+  QImage image(task.Path());
+  if (image.isNull()) qWarning() << "Failed to load image:" << task.Path();
+  task.SetFrame(FitToTarget(image, target), target);
+  task.Finish(std::move(image), std::move(modified));
+}
+
+void DecodeQueue::WorkerLoop() {
+  trace::NameThread("decode worker");
+  for (;;) {
+    available_.acquire();
+    if (stopping_.load()) return;
+    std::optional<decode_task_t> task = requests_.TryPop();
+    if (!task) task = TakeOverflow();
+    if (task) {
+      // Set aside with its wakeup, to be picked up once nothing else waits.
+      // Should the ring be full, it is simply decoded now.
+      if ((*task)->IsDeferred() && (*task)->IsQueued() &&
+          deferred_.TryPush(*task)) {
+        available_.release();
+        continue;
+      }
+      Run(*task);
+    } else if (std::optional<decode_task_t> deferred = deferred_.TryPop()) {
+      Run(*deferred);
+    }
+  }
+}
+
+std::optional<decode_task_t> DecodeQueue::TakeOverflow() {
+  if (!overflowed_.load()) return std::nullopt;
+  QMutexLocker locker(&overflow_mutex_);
+  if (overflow_.empty()) return std::nullopt;
+  decode_task_t task = std::move(overflow_.front());
+  overflow_.pop_front();
+  overflowed_.store(!overflow_.empty());
+  return task;
+}
+
+void DecodeQueue::Enqueue(decode_task_t const& task) {
+  // Once anything overflowed, later requests line up behind it.
+  if (overflowed_.load() || !requests_.TryPush(task)) {
+    QMutexLocker locker(&overflow_mutex_);
+    overflow_.push_back(task);
+    overflowed_.store(true);
+  }
+  available_.release();
+}
+
+void DecodeQueue::Run(decode_task_t const& task) {
+  // Not claimed if cancelled (evicted), taken over by the GUI thread or the
+  // expedited thread, or handed back by them for the statistics alone.
+  if (task->Claim()) {
+    Decode(*task, FrameTarget());
+    Announce(task);
+  }
+  if (task->IsDone() && task->ClaimCheck() &&
+      QFileInfo(task->Path()).lastModified() != task->Modified()) {
+    task->SetStale();
+    Announce(task);
+    return;
+  }
+  // Statistics come second, so that they never hold up the image itself.
+  if (!task->IsDone() || !task->ClaimStats()) return;
+  {
+    trace::Scope scope("image stats", "task", task->Id());
+    task->SetStats(ComputeImageStats(task->Wait()));
+  }
+  Announce(task);
+}
+
+void DecodeQueue::Announce(decode_task_t const& task) {
+  // A frame may be waiting for this very task, so it must be announced even
+  // when the ring is full, if at the cost of a call of its own.
+  if (!completions_.TryPush(task)) {
+    QMetaObject::invokeMethod(
+        this, [this, task] { emit taskFinished(task); },
+        Qt::QueuedConnection);
+    return;
+  }
+  if (!drain_scheduled_.exchange(true)) {
+    QMetaObject::invokeMethod(this, [this] { DrainCompletions(); },
+                              Qt::QueuedConnection);
+  }
+}
+
+void DecodeQueue::DrainCompletions() {
+  drain_scheduled_.store(false);
+  while (std::optional<decode_task_t> task = completions_.TryPop())
+    emit taskFinished(std::move(*task));
+}
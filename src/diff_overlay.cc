@@ -0,0 +1,49 @@
+#include "diff_overlay.hpp"
+
+#include <QFutureWatcher>
+#include <QtConcurrent>
+
+#include "trace.hpp"
+
+namespace {
+
+struct Comparison {
+  QImage heatmap;
+  DiffStats stats;
+  bool done = false;  // false if superseded before it ran
+};
+
+}  // namespace
+
+DiffOverlay::DiffOverlay(QObject* parent) : QObject(parent) {
+  pool_.setMaxThreadCount(1);
+}
+
+void DiffOverlay::SetReference(QString path, QImage image) {
+  Cancel();
+  reference_path_ = std::move(path);
+  reference_ = std::move(image);
+}
+
+void DiffOverlay::Compare(QImage image) {
+  const quint64 generation = ++generation_;
+  if (!HasReference() || image.isNull()) return;
+  auto* watcher = new QFutureWatcher<Comparison>(this);
+  connect(watcher, &QFutureWatcher<Comparison>::finished, this,
+          [this, watcher, generation] {
+            Comparison comparison = watcher->result();
+            watcher->deleteLater();
+            if (comparison.done && generation == generation_)
+              emit ready(std::move(comparison.heatmap), comparison.stats);
+          });
+  watcher->setFuture(QtConcurrent::run(
+      &pool_, [this, generation, reference = reference_, image] {
+        Comparison comparison;
+        if (generation != generation_) return comparison;
+        trace::Scope scope("pixel diff");
+        comparison.stats = PixelDiff(image, reference, kThreshold, kGain,
+                                     &comparison.heatmap);
+        comparison.done = true;
+        return comparison;
+      }));
+}
@@ -0,0 +1,146 @@
+#include "duplicate_finder.hpp"
+
+#include <QDataStream>
+#include <QDateTime>
+#include <QDir>
+#include <QElapsedTimer>
+#include <QFile>
+#include <QFileInfo>
+#include <QFutureWatcher>
+#include <QMutex>
+#include <QSaveFile>
+#include <QStandardPaths>
+#include <QtConcurrent>
+#include <algorithm>
+#include <numeric>
+
+#include "trace.hpp"
+
+namespace {
+
+constexpr quint32 kMagic = 0x50564853;  // "PVHS"
+constexpr quint32 kVersion = 1;
+// The smallest stored entry: an empty path's length, size, time and hash.
+constexpr qint64 kMinEntryBytes = 4 + 3 * 8;
+
+struct Outcome {
+  clusters_t clusters;
+  bool done = false;  // false if superseded before it finished
+};
+
+}  // namespace
+
+DuplicateFinder::DuplicateFinder(QString store_path, PreviewCache cache,
+                                 QObject* parent)
+    : QObject(parent),
+      store_path_(std::move(store_path)),
+      cache_(std::move(cache)) {
+  pool_.setMaxThreadCount(1);
+}
+
+DuplicateFinder::~DuplicateFinder() {
+  ++generation_;
+  pool_.waitForDone();
+}
+
+QString DuplicateFinder::DefaultStorePath() {
+  return QStandardPaths::writableLocation(
+             QStandardPaths::GenericCacheLocation) +
+         QStringLiteral("/pviewer/hashes");
+}
+
+void DuplicateFinder::Find(QVector<QString> paths) {
+  const quint64 generation = ++generation_;
+  running_ = generation;
+  QElapsedTimer clock;
+  clock.start();
+  auto* watcher = new QFutureWatcher<Outcome>(this);
+  connect(watcher, &QFutureWatcher<Outcome>::finished, this,
+          [this, watcher, paths, clock, generation] {
+            Outcome outcome = watcher->result();
+            watcher->deleteLater();
+            if (running_ == generation) running_ = 0;
+            if (outcome.done && generation == generation_)
+              emit found(paths, std::move(outcome.clusters), clock.elapsed());
+          });
+  watcher->setFuture(QtConcurrent::run(&pool_, [this, paths, generation] {
+    Outcome outcome;
+    if (generation != generation_) return outcome;
+    outcome.clusters = Search(paths, generation);
+    outcome.done = generation == generation_;
+    return outcome;
+  }));
+}
+
+clusters_t DuplicateFinder::Search(QVector<QString> const& paths,
+                                   quint64 generation) {
+  trace::Scope scope("find near-duplicates", "images", paths.size());
+  if (!store_loaded_) LoadStore();
+
+  QVector<std::optional<quint64>> hashes(paths.size());
+  QVector<Stored> fresh(paths.size());
+  QVector<int> indices(paths.size());
+  std::iota(indices.begin(), indices.end(), 0);
+  std::atomic<int> hashed{0};  // decoded rather than found in the store
+  QtConcurrent::blockingMap(indices, [&](int i) {
+    if (generation != generation_) return;
+    const QFileInfo info(paths[i]);
+    Stored entry{info.size(), info.lastModified().toMSecsSinceEpoch()};
+    const auto stored = store_.constFind(paths[i]);
+    if (stored != store_.cend() && stored->size == entry.size &&
+        stored->modified == entry.modified) {
+      hashes[i] = stored->hash;
+      return;
+    }
+    hashes[i] = HashImage(paths[i], cache_);
+    if (!hashes[i]) return;
+    entry.hash = *hashes[i];
+    fresh[i] = entry;
+    ++hashed;
+  });
+  if (generation != generation_) return {};
+
+  if (hashed > 0) {
+    for (int i = 0; i < paths.size(); ++i) {
+      if (fresh[i].size >= 0) store_.insert(paths[i], fresh[i]);
+    }
+    SaveStore();
+  }
+  return NearDuplicateClusters(hashes, kMaxDistance);
+}
+
+void DuplicateFinder::LoadStore() {
+  store_loaded_ = true;
+  QFile file(store_path_);
+  if (!file.open(QIODevice::ReadOnly)) return;
+  QDataStream stream(&file);
+  stream.setVersion(QDataStream::Qt_5_12);
+  quint32 magic = 0, version = 0;
+  qint32 count = 0;
+  stream >> magic >> version >> count;
+  if (magic != kMagic || version != kVersion) return;
+  // `count` is read from the file, so it is only trusted as far as the file
+  // can hold that many entries.
+  store_.reserve(
+      int(std::clamp<qint64>(count, 0, file.size() / kMinEntryBytes)));
+  for (qint32 i = 0; i < count && stream.status() == QDataStream::Ok; ++i) {
+    QString path;
+    Stored entry;
+    stream >> path >> entry.size >> entry.modified >> entry.hash;
+    store_.insert(path, entry);
+  }
+  if (stream.status() != QDataStream::Ok) store_.clear();
+}
+
+void DuplicateFinder::SaveStore() const {
+  QDir().mkpath(QFileInfo(store_path_).absolutePath());
+  QSaveFile file(store_path_);
+  if (!file.open(QIODevice::WriteOnly)) return;
+  QDataStream stream(&file);
+  stream.setVersion(QDataStream::Qt_5_12);
+  stream << kMagic << kVersion << qint32(store_.size());
+  for (auto it = store_.cbegin(); it != store_.cend(); ++it) {
+    stream << it.key() << it->size << it->modified << it->hash;
+  }
+  if (stream.status() == QDataStream::Ok) file.commit();
+}
@@ -0,0 +1,132 @@
+#include "file_operation_queue.hpp"
+
+#include <QDir>
+#include <QFile>
+#include <QFileInfo>
+#include <QFutureWatcher>
+#include <QtConcurrent>
+
+namespace {
+
+QString TargetPath(QString const& source, QString const& directory) {
+  return QDir(directory).filePath(QFileInfo(source).fileName());
+}
+
+// QFile::moveToTrash on freedesktop systems writes <trash>/files/<name> plus a
+// <trash>/info/<name>.trashinfo record; the record must go when restoring.
+void RemoveTrashInfo(QString const& trashed_path) {
+  QFileInfo trashed(trashed_path);
+  QDir files_dir = trashed.dir();
+  if (files_dir.dirName() != QStringLiteral("files")) return;
+  const QString info = files_dir.absoluteFilePath(
+      QStringLiteral("../info/") + trashed.fileName() +
+      QStringLiteral(".trashinfo"));
+  QFile::remove(info);
+}
+
+}  // namespace
+
+FileOperationQueue::FileOperationQueue(QObject* parent) : QObject(parent) {
+  // One worker keeps operations (and their undos) strictly ordered.
+  pool_.setMaxThreadCount(1);
+}
+
+FileOperationQueue::~FileOperationQueue() { pool_.waitForDone(); }
+
+int FileOperationQueue::Trash(QString path) {
+  return Submit(Kind::Trash, std::move(path), QString());
+}
+
+int FileOperationQueue::MoveTo(QString path, QString directory) {
+  QString destination = TargetPath(path, directory);
+  return Submit(Kind::Move, std::move(path), std::move(destination));
+}
+
+int FileOperationQueue::CopyTo(QString path, QString directory) {
+  QString destination = TargetPath(path, directory);
+  return Submit(Kind::Copy, std::move(path), std::move(destination));
+}
+
+bool FileOperationQueue::Undo() {
+  if (undo_stack_.isEmpty()) return false;
+  Run(undo_stack_.takeLast(), /*undo=*/true);
+  return true;
+}
+
+int FileOperationQueue::Submit(Kind kind, QString source,
+                               QString destination) {
+  auto operation = std::make_shared<Operation>();
+  operation->id = next_id_++;
+  operation->kind = kind;
+  operation->source = std::move(source);
+  operation->destination = std::move(destination);
+  undo_stack_.push_back(operation);
+  if (undo_stack_.size() > kUndoDepth)
+    emit expired(undo_stack_.takeFirst()->id);
+  Run(operation, /*undo=*/false);
+  return operation->id;
+}
+
+void FileOperationQueue::Run(operation_t const& operation, bool undo) {
+  ++pending_;
+  auto* watcher = new QFutureWatcher<Result>(this);
+  connect(watcher, &QFutureWatcher<Result>::finished, this,
+          [this, watcher, operation, undo] {
+            --pending_;
+            const Result result = watcher->result();
+            watcher->deleteLater();
+            if (undo) {
+              // Undoing an operation that failed anyway: already reported.
+              if (!operation->succeeded) return;
+              if (result.ok) {
+                emit undone(*operation);
+              } else {
+                emit undoFailed(*operation, result.reason);
+              }
+            } else if (!result.ok) {
+              undo_stack_.removeOne(operation);
+              emit failed(*operation, result.reason);
+            }
+          });
+  // The operation record is only touched by the single worker thread while a
+  // job is in flight; the GUI thread reads it after `finished`.
+  watcher->setFuture(QtConcurrent::run(&pool_, [operation, undo] {
+    return undo ? Revert(*operation) : Perform(*operation);
+  }));
+}
+
+FileOperationQueue::Result FileOperationQueue::Perform(Operation& operation) {
+  QFile file(operation.source);
+  if (operation.kind != Kind::Trash && QFile::exists(operation.destination))
+    return {false, QStringLiteral("destination already exists")};
+  switch (operation.kind) {
+    case Kind::Trash:
+      operation.succeeded = file.moveToTrash();
+      if (operation.succeeded) operation.destination = file.fileName();
+      break;
+    case Kind::Move:
+      operation.succeeded = file.rename(operation.destination);
+      break;
+    case Kind::Copy:
+      operation.succeeded = file.copy(operation.destination);
+      break;
+  }
+  if (operation.succeeded) return {};
+  return {false, file.errorString()};
+}
+
+FileOperationQueue::Result FileOperationQueue::Revert(
+    Operation const& operation) {
+  if (!operation.succeeded) return {};
+  if (operation.kind == Kind::Copy) {
+    QFile copy(operation.destination);
+    if (copy.remove()) return {};
+    return {false, copy.errorString()};
+  }
+  if (QFile::exists(operation.source))
+    return {false, QStringLiteral("original location is occupied")};
+  QFile file(operation.destination);
+  if (!file.rename(operation.source)) return {false, file.errorString()};
+  if (operation.kind == Kind::Trash) RemoveTrashInfo(operation.destination);
+  return {};
+}
@@ -0,0 +1,44 @@
+#include "frame_target.hpp"
+
+#include <QScreen>
+#include <QWidget>
+#include <cmath>
+
+#include "trace.hpp"
+
+namespace {
+
+bool Fits(QSize size, QSize target) {
+  return !target.isValid() ||
+         (size.width() <= target.width() && size.height() <= target.height());
+}
+
+}  // namespace
+
+QSize ViewFrameTarget(QWidget const* view, double zoom) {
+  if (view == nullptr) return QSize();
+  return ScreenFrameTarget(view->size(), view->devicePixelRatioF(), zoom);
+}
+
+QSize ScreenFrameTarget(QScreen const* screen, double zoom) {
+  if (screen == nullptr) return QSize();
+  return ScreenFrameTarget(screen->size(), screen->devicePixelRatio(), zoom);
+}
+
+QSize ScreenFrameTarget(QSize size, double device_pixel_ratio, double zoom) {
+  double scale = device_pixel_ratio;
+  if (zoom > 1) scale *= std::exp2(std::ceil(std::log2(zoom)));
+  return QSize(int(std::ceil(size.width() * scale)),
+               int(std::ceil(size.height() * scale)));
+}
+
+QImage FitToTarget(QImage const& image, QSize target) {
+  if (image.isNull() || Fits(image.size(), target)) return image;
+  trace::Scope scope("fit frame");
+  return image.scaled(image.size().scaled(target, Qt::KeepAspectRatio),
+                      Qt::IgnoreAspectRatio, Qt::SmoothTransformation);
+}
+
+bool SameFrame(QSize size, QSize a, QSize b) {
+  return a == b || (Fits(size, a) && Fits(size, b));
+}
@@ -0,0 +1,111 @@
+#include "histogram_overlay.hpp"
+
+#include <QFontDatabase>
+#include <QFontMetrics>
+#include <QPainter>
+#include <QPainterPath>
+#include <algorithm>
+
+namespace {
+
+constexpr int kMargin = 8;
+constexpr int kHistogramHeight = 80;
+constexpr int kLineCharacters = 34;
+
+const char* const kChannelNames[ImageStats::kChannels] = {"R", "G", "B", "Y"};
+
+const QColor kChannelColors[ImageStats::kChannels] = {
+    QColor(230, 70, 70, 140), QColor(70, 200, 70, 140),
+    QColor(80, 120, 240, 140), QColor(230, 230, 230, 110)};
+
+QString Percent(qint64 part, qint64 whole) {
+  return QString::number(whole > 0 ? 100.0 * part / whole : 0.0, 'f', 2) +
+         QLatin1Char('%');
+}
+
+}  // namespace
+
+HistogramOverlay::HistogramOverlay(QWidget* parent) : QWidget(parent) {
+  setAttribute(Qt::WA_TransparentForMouseEvents);
+  setFont(QFontDatabase::systemFont(QFontDatabase::FixedFont));
+  const QFontMetrics metrics(font());
+  const int lines = ImageStats::kChannels + 1;
+  resize(metrics.horizontalAdvance(QString(kLineCharacters, QLatin1Char('0'))) +
+             2 * kMargin,
+         kHistogramHeight + metrics.lineSpacing() * lines + 3 * kMargin);
+  hide();
+}
+
+void HistogramOverlay::SetStats(std::shared_ptr<const ImageStats> stats) {
+  if (stats == stats_) return;
+  stats_ = std::move(stats);
+  if (isVisible()) update();
+}
+
+void HistogramOverlay::Place(QRect const& area) {
+  move(area.right() - width() - kMargin + 1, area.top() + kMargin);
+  raise();
+}
+
+void HistogramOverlay::Toggle(QRect const& area) {
+  if (isVisible()) {
+    hide();
+    return;
+  }
+  Place(area);
+  show();
+}
+
+void HistogramOverlay::paintEvent(QPaintEvent*) {
+  QPainter painter(this);
+  painter.setRenderHint(QPainter::Antialiasing);
+  painter.setPen(Qt::NoPen);
+  painter.setBrush(QColor(0, 0, 0, 170));
+  painter.drawRoundedRect(rect(), 6, 6);
+
+  const QFontMetrics metrics(font());
+  painter.setPen(QColor(230, 230, 230));
+  if (!stats_) {
+    painter.drawText(rect(), Qt::AlignCenter, QStringLiteral("computing..."));
+    return;
+  }
+
+  // Each histogram is scaled to its tallest inner bin: the clipped ends
+  // would otherwise flatten everything else. They are capped instead.
+  const QRectF plot(kMargin, kMargin, width() - 2 * kMargin, kHistogramHeight);
+  const qreal bin_width = plot.width() / 256;
+  painter.setPen(Qt::NoPen);
+  for (int channel = 0; channel < ImageStats::kChannels; ++channel) {
+    ImageStats::histogram_t const& histogram = stats_->histograms[channel];
+    const quint32 tallest = std::max<quint32>(
+        1, *std::max_element(histogram.begin() + 1, histogram.end() - 1));
+    QPainterPath path(plot.bottomLeft());
+    for (int level = 0; level < 256; ++level) {
+      const qreal height =
+          plot.height() * std::min(1.0, double(histogram[level]) / tallest);
+      path.lineTo(plot.left() + level * bin_width, plot.bottom() - height);
+      path.lineTo(plot.left() + (level + 1) * bin_width,
+                  plot.bottom() - height);
+    }
+    path.lineTo(plot.bottomRight());
+    painter.setBrush(kChannelColors[channel]);
+    painter.drawPath(path);
+  }
+
+  painter.setPen(QColor(230, 230, 230));
+  int y = int(plot.bottom()) + kMargin + metrics.ascent();
+  for (int channel = 0; channel < ImageStats::kChannels; ++channel) {
+    const auto which = static_cast<ImageStats::Channel>(channel);
+    painter.drawText(kMargin, y,
+                     QStringLiteral("%1  min %2  max %3  mean %4")
+                         .arg(QLatin1String(kChannelNames[channel]))
+                         .arg(stats_->Min(which), 3)
+                         .arg(stats_->Max(which), 3)
+                         .arg(stats_->Mean(which), 5, 'f', 1));
+    y += metrics.lineSpacing();
+  }
+  painter.drawText(kMargin, y,
+                   QStringLiteral("clipped  black %1  white %2")
+                       .arg(Percent(stats_->black, stats_->pixels),
+                            Percent(stats_->white, stats_->pixels)));
+}
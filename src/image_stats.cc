@@ -0,0 +1,206 @@
+#include "image_stats.hpp"
+
+#include <QtConcurrent>
+#include <algorithm>
+#include <vector>
+
+#ifdef PVIEWER_X86_SIMD
+#include <immintrin.h>
+#endif
+
+namespace {
+
+// Bands of rows are counted in parallel, each into its own tables.
+constexpr int kBandRows = 256;
+
+using tables_t = std::array<ImageStats::histogram_t, ImageStats::kChannels>;
+
+// Histogram updates are scattered stores, which no vector unit does well.
+// The kernels below vectorize everything else, luma and the clipping tests,
+// and leave the counting to plain stores.
+struct RowState {
+  tables_t tables{};
+  qint64 black = 0;
+  qint64 white = 0;
+};
+
+void Count(quint32 pixel, int luma, tables_t& tables) {
+  ++tables[ImageStats::Red][pixel >> 16 & 0xff];
+  ++tables[ImageStats::Green][pixel >> 8 & 0xff];
+  ++tables[ImageStats::Blue][pixel & 0xff];
+  ++tables[ImageStats::Luma][luma];
+}
+
+void StatsRowScalar(const quint32* line, int n, RowState& state) {
+  for (int i = 0; i < n; ++i) {
+    const quint32 pixel = line[i];
+    const int red = pixel >> 16 & 0xff;
+    const int green = pixel >> 8 & 0xff;
+    const int blue = pixel & 0xff;
+    Count(pixel, (77 * red + 150 * green + 29 * blue + 128) >> 8,
+          state.tables);
+    state.black += (pixel & 0x00ffffff) == 0;
+    state.white += red == 255 || green == 255 || blue == 255;
+  }
+}
+
+#ifdef PVIEWER_X86_SIMD
+
+// Luma of whole pixels in 32-bit lanes: the bytes are widened to 16 bits,
+// multiplied by their weights and summed pairwise by madd, the two pair
+// sums of a pixel are added, and the pixels are gathered back in order.
+
+__attribute__((target("sse2"))) void StatsRowSse2(const quint32* line, int n,
+                                                  RowState& state) {
+  const __m128i zero = _mm_setzero_si128();
+  const __m128i rgb = _mm_set1_epi32(0x00ffffff);
+  const __m128i weights = _mm_set_epi16(0, 77, 150, 29, 0, 77, 150, 29);
+  const __m128i rounding = _mm_set1_epi32(128);
+  alignas(16) int luma[4];
+  int i = 0;
+  for (; i + 4 <= n; i += 4) {
+    const __m128i pixels =
+        _mm_loadu_si128(reinterpret_cast<const __m128i*>(line + i));
+    const __m128i colour = _mm_and_si128(pixels, rgb);
+    state.black += __builtin_popcount(_mm_movemask_ps(
+        _mm_castsi128_ps(_mm_cmpeq_epi32(colour, zero))));
+    const __m128i full =
+        _mm_and_si128(_mm_cmpeq_epi8(pixels, _mm_set1_epi8(-1)), rgb);
+    state.white += 4 - __builtin_popcount(_mm_movemask_ps(
+                           _mm_castsi128_ps(_mm_cmpeq_epi32(full, zero))));
+
+    __m128i low = _mm_madd_epi16(_mm_unpacklo_epi8(pixels, zero), weights);
+    __m128i high = _mm_madd_epi16(_mm_unpackhi_epi8(pixels, zero), weights);
+    low = _mm_add_epi32(low, _mm_shuffle_epi32(low, _MM_SHUFFLE(2, 3, 0, 1)));
+    high =
+        _mm_add_epi32(high, _mm_shuffle_epi32(high, _MM_SHUFFLE(2, 3, 0, 1)));
+    const __m128i sums = _mm_castps_si128(
+        _mm_shuffle_ps(_mm_castsi128_ps(low), _mm_castsi128_ps(high),
+                       _MM_SHUFFLE(2, 0, 2, 0)));
+    _mm_store_si128(reinterpret_cast<__m128i*>(luma),
+                    _mm_srli_epi32(_mm_add_epi32(sums, rounding), 8));
+    for (int k = 0; k < 4; ++k)
+      Count(line[i + k], luma[k], state.tables);
+  }
+  StatsRowScalar(line + i, n - i, state);
+}
+
+__attribute__((target("avx2"))) void StatsRowAvx2(const quint32* line, int n,
+                                                  RowState& state) {
+  const __m256i zero = _mm256_setzero_si256();
+  const __m256i rgb = _mm256_set1_epi32(0x00ffffff);
+  const __m256i weights = _mm256_set_epi16(0, 77, 150, 29, 0, 77, 150, 29, 0,
+                                           77, 150, 29, 0, 77, 150, 29);
+  const __m256i rounding = _mm256_set1_epi32(128);
+  alignas(32) int luma[8];
+  int i = 0;
+  for (; i + 8 <= n; i += 8) {
+    const __m256i pixels =
+        _mm256_loadu_si256(reinterpret_cast<const __m256i*>(line + i));
+    const __m256i colour = _mm256_and_si256(pixels, rgb);
+    state.black += __builtin_popcount(_mm256_movemask_ps(
+        _mm256_castsi256_ps(_mm256_cmpeq_epi32(colour, zero))));
+    const __m256i full =
+        _mm256_and_si256(_mm256_cmpeq_epi8(pixels, _mm256_set1_epi8(-1)), rgb);
+    const __m256i partial = _mm256_cmpeq_epi32(full, zero);
+    state.white += 8 - __builtin_popcount(
+                           _mm256_movemask_ps(_mm256_castsi256_ps(partial)));
+
+    // Unpacking works within 128-bit halves, and so does the final
+    // shuffle, which puts the pixels back in order.
+    __m256i low =
+        _mm256_madd_epi16(_mm256_unpacklo_epi8(pixels, zero), weights);
+    __m256i high =
+        _mm256_madd_epi16(_mm256_unpackhi_epi8(pixels, zero), weights);
+    low = _mm256_add_epi32(low,
+                           _mm256_shuffle_epi32(low, _MM_SHUFFLE(2, 3, 0, 1)));
+    high = _mm256_add_epi32(
+        high, _mm256_shuffle_epi32(high, _MM_SHUFFLE(2, 3, 0, 1)));
+    const __m256i sums = _mm256_castps_si256(
+        _mm256_shuffle_ps(_mm256_castsi256_ps(low), _mm256_castsi256_ps(high),
+                          _MM_SHUFFLE(2, 0, 2, 0)));
+    _mm256_store_si256(reinterpret_cast<__m256i*>(luma),
+                       _mm256_srli_epi32(_mm256_add_epi32(sums, rounding), 8));
+    for (int k = 0; k < 8; ++k)
+      Count(line[i + k], luma[k], state.tables);
+  }
+  StatsRowScalar(line + i, n - i, state);
+}
+
+#endif
+
+using row_kernel_t = void (*)(const quint32* line, int n, RowState& state);
+
+row_kernel_t RowKernel(SimdLevel level) {
+  switch (level) {
+#ifdef PVIEWER_X86_SIMD
+    case SimdLevel::Sse2:
+      return StatsRowSse2;
+    case SimdLevel::Avx2:
+      return StatsRowAvx2;
+#endif
+    default:
+      return StatsRowScalar;
+  }
+}
+
+}  // namespace
+
+int ImageStats::Min(Channel channel) const {
+  histogram_t const& histogram = histograms[channel];
+  for (int level = 0; level < 256; ++level)
+    if (histogram[level]) return level;
+  return -1;
+}
+
+int ImageStats::Max(Channel channel) const {
+  histogram_t const& histogram = histograms[channel];
+  for (int level = 255; level >= 0; --level)
+    if (histogram[level]) return level;
+  return -1;
+}
+
+double ImageStats::Mean(Channel channel) const {
+  if (pixels == 0) return 0;
+  double sum = 0;
+  for (int level = 0; level < 256; ++level)
+    sum += double(level) * histograms[channel][level];
+  return sum / pixels;
+}
+
+ImageStats ComputeImageStats(QImage const& image, SimdLevel level) {
+  ImageStats stats;
+  if (image.isNull()) return stats;
+  const QImage source = image.format() == QImage::Format_RGB32 ||
+                                image.format() == QImage::Format_ARGB32
+                            ? image
+                            : image.convertToFormat(QImage::Format_ARGB32);
+  if (!IsSupported(level)) level = SimdLevel::Scalar;
+  const row_kernel_t stats_row = RowKernel(level);
+
+  struct Band {
+    int first_row;
+    RowState state;
+  };
+  std::vector<Band> bands;
+  for (int row = 0; row < source.height(); row += kBandRows)
+    bands.push_back({row, {}});
+  QtConcurrent::blockingMap(bands, [&](Band& band) {
+    const int end = std::min(band.first_row + kBandRows, source.height());
+    for (int row = band.first_row; row < end; ++row) {
+      stats_row(reinterpret_cast<const quint32*>(source.constScanLine(row)),
+                source.width(), band.state);
+    }
+  });
+
+  stats.pixels = qint64(source.width()) * source.height();
+  for (Band const& band : bands) {
+    for (int channel = 0; channel < ImageStats::kChannels; ++channel) {
+      for (int value = 0; value < 256; ++value)
+        stats.histograms[channel][value] += band.state.tables[channel][value];
+    }
+    stats.black += band.state.black;
+    stats.white += band.state.white;
+  }
+  return stats;
+}
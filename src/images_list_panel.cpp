@@ -7,10 +7,59 @@
 #include <QTimer>
 #include <QVBoxLayout>
 
+#include <optional>
 #include <utility>
 
+namespace {
+
+bool SameEntry(ImageEntry const& a, ImageEntry const& b) {
+  return a.id == b.id && a.enabled == b.enabled;
+}
+
+// Items keep the id of their entry, not its path.
+PathId ItemId(QListWidgetItem const* item) {
+  return item->data(Qt::UserRole).toUInt();
+}
+
+QString ItemPath(QListWidgetItem const* item) {
+  return PathStore::Shared().Path(ItemId(item));
+}
+
+// Recognizes `after` as `before` with a single row moved and returns that move.
+std::optional<EntryEdit> SingleMove(QVector<ImageEntry> const& before,
+                                    QVector<ImageEntry> const& after) {
+  if (before.size() != after.size()) return std::nullopt;
+  int first = 0;
+  int last = before.size() - 1;
+  while (first <= last && SameEntry(before[first], after[first])) ++first;
+  while (first <= last && SameEntry(before[last], after[last])) --last;
+  if (first >= last) return std::nullopt;
+
+  auto shifted = [&](int before_from, int after_from, int count) {
+    for (int i = 0; i < count; ++i) {
+      if (!SameEntry(before[before_from + i], after[after_from + i]))
+        return false;
+    }
+    return true;
+  };
+  const int span = last - first;
+  if (SameEntry(before[last], after[first]) &&
+      shifted(first, first + 1, span)) {
+    return EntryEdit{EntryEdit::Kind::Move, before[last].Path(), first};
+  }
+  if (SameEntry(before[first], after[last]) &&
+      shifted(first + 1, first, span)) {
+    return EntryEdit{EntryEdit::Kind::Move, before[first].Path(), last};
+  }
+  return std::nullopt;
+}
+
+}  // namespace
+
 ImagesListPanel::ImagesListPanel(QWidget* parent)
-    : QDialog(parent), list_(new QListWidget(this)) {
+    : QDialog(parent),
+      list_(new QListWidget(this)),
+      collapse_(new QCheckBox("&Collapse near-duplicates", this)) {
   setWindowTitle("Images");
   resize(520, 360);
 
@@ -24,22 +73,28 @@ ImagesListPanel::ImagesListPanel(QWidget* parent)
   auto* layout = new QVBoxLayout(this);
   layout->setContentsMargins(6, 6, 6, 6);
   layout->addWidget(list_);
+  layout->addWidget(collapse_);
 
-  connect(list_, &QListWidget::itemChanged, this, [this](QListWidgetItem*) {
-    if (updating_) return;
-    SyncEntriesFromList();
-    EmitEntriesChanged();
+  connect(collapse_, &QCheckBox::toggled, this, [this](bool collapsed) {
+    if (collapsed && cluster_sizes_.isEmpty()) emit clustersRequested();
+    RebuildList();
   });
 
+  connect(list_, &QListWidget::itemChanged, this,
+          [this](QListWidgetItem* item) {
+            if (updating_) return;
+            SyncCheckState(list_->row(item));
+          });
+
   connect(list_, &QListWidget::itemDoubleClicked, this,
           [this](QListWidgetItem* item) {
             if (!item || item->checkState() != Qt::Checked) return;
-            emit imageActivated(item->data(Qt::UserRole).toString());
+            emit imageActivated(ItemPath(item));
           });
   auto* delete_shortcut = new QShortcut(QKeySequence::Delete, list_);
   connect(delete_shortcut, &QShortcut::activated, this, [this] {
     QListWidgetItem* item = list_->currentItem();
-    if (item) emit imageDeleteRequested(item->data(Qt::UserRole).toString());
+    if (item) emit imageDeleteRequested(ItemPath(item));
   });
   auto* previous_shortcut =
       new QShortcut(QKeySequence(QStringLiteral("Ctrl+Left")), this);
@@ -81,22 +136,38 @@ void ImagesListPanel::SetEntries(QVector<ImageEntry> entries) {
   RebuildList();
 }
 
-void ImagesListPanel::SetCurrentPath(QString path) {
-  if (current_path_ == path) return;
-  current_path_ = std::move(path);
+void ImagesListPanel::SetCurrentPath(QString const& path) {
+  const std::optional<PathId> current = PathStore::Shared().Find(path);
+  if (current_ == current) return;
+  current_ = current;
+  RebuildList();
+}
+
+void ImagesListPanel::SetClusters(QHash<PathId, int> cluster_of,
+                                  QVector<int> sizes) {
+  cluster_of_ = std::move(cluster_of);
+  cluster_sizes_ = std::move(sizes);
   RebuildList();
 }
 
 void ImagesListPanel::RebuildList() {
   updating_ = true;
   list_->clear();
+  QVector<bool> cluster_listed(cluster_sizes_.size(), false);
   for (const ImageEntry& entry : entries_) {
-    const bool is_current = entry.path == current_path_;
-    QString text = entry.path;
+    const bool is_current = entry.id == current_;
+    const QString path = entry.Path();
+    QString text = path;
+    const int cluster = cluster_of_.value(entry.id, -1);
+    if (cluster >= 0) {
+      text += QStringLiteral("  [group %1 of %2]")
+                  .arg(cluster + 1)
+                  .arg(cluster_sizes_.at(cluster));
+    }
     if (is_current) text += QStringLiteral("  (Current)");
     auto* item = new QListWidgetItem(text);
-    item->setToolTip(entry.path);
-    item->setData(Qt::UserRole, entry.path);
+    item->setToolTip(path);
+    item->setData(Qt::UserRole, uint(entry.id));
     item->setCheckState(entry.enabled ? Qt::Checked : Qt::Unchecked);
     item->setFlags(Qt::ItemIsEnabled | Qt::ItemIsSelectable |
                    Qt::ItemIsUserCheckable | Qt::ItemIsDragEnabled);
@@ -104,21 +175,39 @@ void ImagesListPanel::RebuildList() {
       item->setForeground(QBrush(QColor(140, 140, 140)));
     }
     list_->addItem(item);
+    if (cluster >= 0) {
+      // Hidden rows keep their place, so edits still see the whole list.
+      item->setHidden(collapse_->isChecked() && cluster_listed[cluster]);
+      cluster_listed[cluster] = true;
+    }
   }
   updating_ = false;
 }
 
-void ImagesListPanel::SyncEntriesFromList() {
+QVector<ImageEntry> ImagesListPanel::EntriesFromList() const {
   QVector<ImageEntry> entries;
   entries.reserve(list_->count());
   for (int i = 0; i < list_->count(); ++i) {
     QListWidgetItem* item = list_->item(i);
     entries.push_back(ImageEntry{
-        item->data(Qt::UserRole).toString(),
+        ItemId(item),
         item->checkState() == Qt::Checked,
     });
   }
-  entries_ = std::move(entries);
+  return entries;
+}
+
+void ImagesListPanel::SyncEntriesFromList() { entries_ = EntriesFromList(); }
+
+void ImagesListPanel::SyncCheckState(int row) {
+  if (row < 0 || row >= entries_.size()) return;
+  const bool enabled = list_->item(row)->checkState() == Qt::Checked;
+  if (entries_[row].enabled == enabled) return;
+  entries_[row].enabled = enabled;
+  emit entryEdited(EntryEdit{
+      enabled ? EntryEdit::Kind::Enable : EntryEdit::Kind::Disable,
+      entries_[row].Path(),
+  });
 }
 
 void ImagesListPanel::MoveSelectedRow(int offset) {
@@ -133,7 +222,7 @@ void ImagesListPanel::MoveSelectedRow(int offset) {
   updating_ = false;
 
   SyncEntriesFromList();
-  EmitEntriesChanged();
+  emit entryEdited(EntryEdit{EntryEdit::Kind::Move, entries_[to].Path(), to});
 }
 
 void ImagesListPanel::ScheduleEntriesSync() {
@@ -142,8 +231,15 @@ void ImagesListPanel::ScheduleEntriesSync() {
   QTimer::singleShot(0, this, [this] {
     sync_scheduled_ = false;
     if (updating_) return;
-    SyncEntriesFromList();
-    EmitEntriesChanged();
+    QVector<ImageEntry> entries = EntriesFromList();
+    std::optional<EntryEdit> edit = SingleMove(entries_, entries);
+    entries_ = std::move(entries);
+    // A drag moves exactly one row; anything else is synced wholesale.
+    if (edit) {
+      emit entryEdited(*edit);
+    } else {
+      EmitEntriesChanged();
+    }
   });
 }
 
@@ -3,7 +3,6 @@
 #include "image_formats.hpp"
 
 #include <QApplication>
-#include <QCollator>
 #include <QFileDialog>
 #include <QGridLayout>
 #include <QKeyEvent>
@@ -78,11 +77,7 @@ void ImagesSelectorDialog::selectAllImagesInDirectory(GetDirectoryVia opt,
     return;
   }
 
-  directory.setNameFilters(SupportedImageNameFilters());
-  QList<QString> pixmap_list = directory.entryList(QDir::Files);
-  sortItems(pixmap_list);
-  convertPathsToAbsolute(directory, pixmap_list);
-  emit stringListPrepared(pixmap_list, pos);
+  emit stringListPrepared(ImagesInDirectory(directory), pos);
 }
 
 void ImagesSelectorDialog::selectAllImagesInSubdirectories() {
@@ -106,12 +101,6 @@ void ImagesSelectorDialog::selectAllImagesInSubdirectories() {
   }
 }
 
-void ImagesSelectorDialog::sortItems(QList<QString>& list) {
-  QCollator collator;
-  collator.setNumericMode(true);
-  std::sort(list.begin(), list.end(), collator);
-}
-
 void ImagesSelectorDialog::convertPathsToAbsolute(QDir dir, QList<QString>& list) {
   for (QString& path : list) {
     path = dir.absoluteFilePath(path);
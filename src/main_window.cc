@@ -2,50 +2,95 @@
 
 #include <QApplication>
 #include <QClipboard>
-#include <QFile>
+#include <QFileDialog>
 #include <QFileInfo>
+#include <QLabel>
 #include <QMimeData>
+#include <QPointer>
 #include <QProcess>
+#include <QScrollBar>
 #include <QStringList>
 #include <QStyle>
 #include <QSystemTrayIcon>
+#include <QTimer>
 #include <QUrl>
 #include <algorithm>
 
 #include "cached_images_list.hpp"
+#include "frame_target.hpp"
+#include "global_path.hpp"
+#include "histogram_overlay.hpp"
+#include "image_formats.hpp"
 #include "images_list_panel.hpp"
 #include "images_selector_dialog.hpp"
+#include "performance_hud.hpp"
+#include "render_quality.hpp"
+#include "split_view.hpp"
+#include "toast.hpp"
+#include "trace.hpp"
 
 namespace {
 
-constexpr int kCopyNotificationTimeoutMs = 1500;
+constexpr int kNotificationTimeoutMs = 1500;
+constexpr int kFrameMs = 16;
+// Posted by noteKeyPress(), see settleKeyPress().
+const QEvent::Type kSettleKeyPress = QEvent::Type(QEvent::registerEventType());
 
-bool ShowFlashNotifyNotification(QString const& path) {
+bool ShowFlashNotifyNotification(QString const& title, QString const& text,
+                                 QString const& image_path) {
 #ifdef Q_OS_LINUX
-  const QString file_name = QFileInfo(path).fileName();
-  const QStringList args{
+  QStringList args{
       QStringLiteral("--app"),
       QStringLiteral("Image Viewer"),
       QStringLiteral("--key"),
-      QStringLiteral("pviewer-copy"),
+      QStringLiteral("pviewer"),
       QStringLiteral("--timeout"),
-      QString::number(kCopyNotificationTimeoutMs / 1000.0, 'f', 1),
-      QStringLiteral("--image"),
-      path,
-      QStringLiteral("Copied to clipboard"),
-      file_name,
+      QString::number(kNotificationTimeoutMs / 1000.0, 'f', 1),
   };
+  if (!image_path.isEmpty()) args << QStringLiteral("--image") << image_path;
+  args << title << text;
   return QProcess::startDetached(QStringLiteral("flash-notify"), args) ||
          QProcess::startDetached(
              QStringLiteral("/home/user/.local/configs/bin/lib/notifications/"
                             "flash-notify.sh"),
              args);
 #else
-  Q_UNUSED(path);
+  Q_UNUSED(title);
+  Q_UNUSED(text);
+  Q_UNUSED(image_path);
   return false;
 #endif
 }
 
+QString OperationName(FileOperationQueue::Kind kind) {
+  switch (kind) {
+    case FileOperationQueue::Kind::Trash:
+      return QStringLiteral("delete");
+    case FileOperationQueue::Kind::Move:
+      return QStringLiteral("move");
+    case FileOperationQueue::Kind::Copy:
+      return QStringLiteral("copy");
+  }
+  return QString();
+}
+
+// False for keys a replay must not send as they are: they touch files, open
+// dialogs or leave the session.
+bool IsReplaySafe(int key, Qt::KeyboardModifiers modifiers) {
+  switch (key) {
+    case Qt::Key_Delete:
+    case Qt::Key_M:
+    case Qt::Key_Y:
+    case Qt::Key_O:
+    case Qt::Key_Escape:
+    case Qt::Key_Space:
+      return false;
+    case Qt::Key_Z:
+      return modifiers != Qt::ControlModifier;
+  }
+  return true;
+}
+
 }  // namespace
 
 void MainWindow::formatWidget() {
@@ -61,12 +106,39 @@ void MainWindow::formatWidget() {
 
 void MainWindow::applyZoom() {
   if (item_->pixmap().isNull()) return;
-  const QSize pixmap_size = item_->pixmap().size();
+  // A startup preview is scaled up to the size of the image it stands for.
+  const QSizeF pixmap_size = QSizeF(item_->pixmap().size()) * item_->scale();
   if (pixmap_size.width() <= 0 || pixmap_size.height() <= 0) return;
-  fit_zoom_ = std::min(viewport()->width() / qreal(pixmap_size.width()),
-                       viewport()->height() / qreal(pixmap_size.height()));
+  fit_zoom_ = std::min(viewport()->width() / pixmap_size.width(),
+                       viewport()->height() / pixmap_size.height());
   const double s = fit_zoom_ * zoom_factor_;
   setTransform(QTransform::fromScale(s, s));
+  updateSplitView();
+  updateFrameTarget();
+}
+
+void MainWindow::updateFrameTarget() {
+  // Until the window is shown its viewport has no size of its own.
+  cache_->SetFrameTarget(isVisible()
+                             ? ViewFrameTarget(viewport(), zoom_factor_)
+                             : ScreenFrameTarget(screen(), zoom_factor_));
+}
+
+void MainWindow::relayout() {
+  updateFrameTarget();
+  if (split_panes_ > 1)
+    setSplitPanes(split_panes_);
+  else if (imageDisplayed())
+    applyZoom();
+  if (diff_label_->isVisible()) placeDiffLabel();
+  if (histogram_->isVisible()) histogram_->Place(viewport()->geometry());
+  toast_->Place(viewport()->geometry());
+}
+
+void MainWindow::setSmoothRendering(bool smooth) {
+  blink_->SetTransformationMode(smooth ? Qt::SmoothTransformation
+                                       : Qt::FastTransformation);
+  split_view_->SetSmooth(smooth);
 }
 
 void MainWindow::fitToView() {
@@ -95,8 +167,211 @@ void MainWindow::toggleFitNative() {
   }
 }
 
+void MainWindow::toggleBlink() {
+  if (blink_->IsRunning()) {
+    blink_->Stop();
+    return;
+  }
+  if (ensureBlinkPartner()) blink_->Start();
+}
+
+bool MainWindow::ensureBlinkPartner() {
+  if (!hasActiveImages() || !imageDisplayed()) return false;
+  if (!blink_->HasPartner()) {
+    const QPixmap next = cache_->SlotPixmap(1);
+    if (!next.isNull()) blink_->Pin(next);
+  }
+  return blink_->HasPartner();
+}
+
+void MainWindow::pinBlinkPartner() {
+  if (hasActiveImages() && imageDisplayed()) blink_->Pin(item_->pixmap());
+}
+
+void MainWindow::findNearDuplicates() {
+  if (duplicates_ == nullptr) {
+    duplicates_ = new DuplicateFinder();
+    duplicates_->setParent(this);
+    connect(duplicates_, &DuplicateFinder::found, this,
+            &MainWindow::showNearDuplicates);
+  }
+  if (duplicates_->IsRunning()) return;
+  QVector<QString> paths;
+  for (ImageEntry const& entry : comparison_model_.Entries())
+    paths.append(entry.Path());
+  if (paths.isEmpty()) return;
+  showNotification(QStringLiteral("Looking for near-duplicates"),
+                   QStringLiteral("%1 images").arg(paths.size()));
+  duplicates_->Find(std::move(paths));
+}
+
+void MainWindow::showNearDuplicates(QVector<QString> paths,
+                                    clusters_t clusters, qint64 elapsed_ms) {
+  cluster_of_.clear();
+  cluster_sizes_.clear();
+  const QVector<PathId> ids = PathStore::Shared().Intern(paths);
+  int images = 0;
+  for (QVector<int> const& cluster : clusters) {
+    for (int index : cluster)
+      cluster_of_.insert(ids[index], cluster_sizes_.size());
+    cluster_sizes_.append(cluster.size());
+    images += cluster.size();
+  }
+  clusters_ready_ = true;
+  if (images_panel_) images_panel_->SetClusters(cluster_of_, cluster_sizes_);
+  showNotification(
+      QStringLiteral("Near-duplicates"),
+      QStringLiteral("%1 groups of %2 images in all, found in %3 ms")
+          .arg(clusters.size())
+          .arg(images)
+          .arg(elapsed_ms));
+}
+
+void MainWindow::jumpToCluster(int direction) {
+  if (!clusters_ready_) {
+    findNearDuplicates();
+    return;
+  }
+  if (!hasActiveImages()) return;
+  const QVector<PathId> ids = comparison_model_.EnabledIds();
+  const int current = comparison_model_.ActiveIndexOf(currentImagePath());
+  if (current < 0) return;
+  // An image without near-duplicates is a group of its own.
+  auto group = [&](int i) { return cluster_of_.value(ids[i], -1 - i); };
+  int target = current;
+  if (direction > 0) {
+    while (target < ids.size() && group(target) == group(current)) ++target;
+    if (target == ids.size()) return;
+  } else {
+    while (target >= 0 && group(target) == group(current)) --target;
+    if (target < 0) return;
+    // Land on the first image of that group.
+    while (target > 0 && group(target - 1) == group(target)) --target;
+  }
+  move->moveTo<ImageNumber>(target + 1);
+  cache_->DisplayImage();
+  updatePanelCurrentImage();
+}
+
+void MainWindow::setSplitPanes(int count) {
+  split_panes_ = count;
+  if (count > 1) last_split_panes_ = count;
+  const int pane_width = width() / count;
+  setViewportMargins(0, 0, width() - pane_width, 0);
+  split_view_->setGeometry(pane_width, 0, width() - pane_width, height());
+  split_view_->setVisible(count > 1);
+  if (imageDisplayed()) applyZoom();
+  updateSplitView();
+  if (histogram_->isVisible()) histogram_->Place(viewport()->geometry());
+}
+
+void MainWindow::updateHistogram() {
+  if (!histogram_->isVisible()) return;
+  // A startup preview has no decode window, and so no statistics, behind it.
+  histogram_->SetStats(shown_id_ ? cache_->ShownStats() : nullptr);
+}
+
+void MainWindow::updateSplitView() {
+  if (split_panes_ < 2) return;
+  QVector<SplitView::Pane> panes;
+  for (int offset = 1; offset < split_panes_; ++offset) {
+    SplitView::Pane pane;
+    // A startup preview has no decode window behind it yet.
+    if (hasActiveImages() && imageDisplayed()) {
+      QString path;
+      pane.pixmap = cache_->SlotPixmap(offset, &path);
+      pane.name = QFileInfo(path).fileName();
+    }
+    panes.append(std::move(pane));
+  }
+  split_view_->SetPanes(std::move(panes));
+
+  QPointF center(0.5, 0.5);
+  const QRectF scene = sceneRect();
+  if (scene.width() > 0 && scene.height() > 0) {
+    const QPointF point = mapToScene(viewport()->rect().center());
+    center = QPointF((point.x() - scene.left()) / scene.width(),
+                     (point.y() - scene.top()) / scene.height());
+  }
+  split_view_->SetView(zoom_factor_, center);
+}
+
 void MainWindow::toggleImagesListPanel() {
-  images_panel_->isVisible() ? images_panel_->hide() : images_panel_->show();
+  ImagesListPanel* panel = imagesPanel();
+  panel->isVisible() ? panel->hide() : panel->show();
+}
+
+ImagesListPanel* MainWindow::imagesPanel() {
+  if (images_panel_) return images_panel_;
+  images_panel_ = new ImagesListPanel(this);
+  connect(images_panel_, &ImagesListPanel::entriesChanged, this,
+          [this](QVector<ImageEntry> entries) {
+            if (recorder_) {
+              for (EntryEdit const& edit :
+                   EditsBetween(comparison_model_.Entries(), entries))
+                recordEdit(edit);
+            }
+            applyPanelEntries(std::move(entries));
+          });
+  connect(images_panel_, &ImagesListPanel::entryEdited, this,
+          [this](EntryEdit edit) {
+            recordEdit(edit);
+            if (applyEntryEdit(edit)) updatePanelCurrentImage();
+          });
+  connect(images_panel_, &ImagesListPanel::imageActivated, this,
+          [this](QString path) {
+            if (recorder_) {
+              SessionEvent event{0, SessionEvent::Type::Activate};
+              event.name = path;
+              recorder_->Record(std::move(event));
+            }
+            activatePanelImage(std::move(path));
+          });
+  connect(images_panel_, &ImagesListPanel::imageDeleteRequested, this,
+          [this](QString path) {
+            // Replays drop the image from the list without touching files.
+            recordEdit(EntryEdit{EntryEdit::Kind::Remove, path});
+            deletePanelImage(std::move(path));
+          });
+  connect(images_panel_, &ImagesListPanel::previousImageRequested, this,
+          &MainWindow::navigateToPreviousImage);
+  connect(images_panel_, &ImagesListPanel::nextImageRequested, this,
+          &MainWindow::navigateToNextImage);
+  connect(images_panel_, &ImagesListPanel::zoomInRequested, this,
+          [this] { zoomBy(1.25); });
+  connect(images_panel_, &ImagesListPanel::zoomOutRequested, this,
+          [this] { zoomBy(0.8); });
+  connect(images_panel_, &ImagesListPanel::clustersRequested, this,
+          &MainWindow::findNearDuplicates);
+  syncPanelEntries();
+  updatePanelCurrentImage();
+  images_panel_->SetClusters(cluster_of_, cluster_sizes_);
+  return images_panel_;
+}
+
+ImagesSelectorDialog* MainWindow::selector() {
+  if (m_psd) return m_psd;
+  m_psd = new ImagesSelectorDialog(this);
+  connect(m_psd, &ImagesSelectorDialog::updateFolderList,
+          [this](QList<QString> list) {
+            if (!list.empty()) {
+              QVector<QString> vector;
+              std::move(list.begin(), list.end(), std::back_inserter(vector));
+              folders_->setNewList(std::move(vector));
+            }
+          });
+  connect(m_psd, &ImagesSelectorDialog::stringListPrepared,
+          [this](QList<QString> list, int pos) {
+            if (!list.empty()) {
+              setComparisonImages(std::move(list), pos);
+            }
+          });
+  m_psd->AssociateWith(folders_);
+  return m_psd;
+}
+
+void MainWindow::syncPanelEntries() {
+  if (images_panel_) images_panel_->SetEntries(comparison_model_.Entries());
 }
 
 QString MainWindow::currentImagePath() const {
@@ -104,6 +379,10 @@ QString MainWindow::currentImagePath() const {
   return images_->pathByIndex();
 }
 
+QString MainWindow::shownImagePath() const {
+  return shown_id_ ? PathStore::Shared().Path(*shown_id_) : QString();
+}
+
 bool MainWindow::hasActiveImages() const {
   return images_ && !images_->isEmpty();
 }
@@ -114,7 +393,12 @@ void MainWindow::setComparisonImages(QList<QString> list, int position) {
   std::move(list.begin(), list.end(), std::back_inserter(vector));
 
   comparison_model_.SetImages(std::move(vector));
-  images_panel_->SetEntries(comparison_model_.Entries());
+  if (duplicates_) duplicates_->Cancel();
+  clusters_ready_ = false;
+  cluster_of_.clear();
+  cluster_sizes_.clear();
+  if (images_panel_) images_panel_->SetClusters({}, {});
+  syncPanelEntries();
   rebuildActiveImages(QString(), position);
 }
 
@@ -124,37 +408,112 @@ void MainWindow::applyPanelEntries(QVector<ImageEntry> entries) {
   rebuildActiveImages(preferred_path, 1);
 }
 
+bool MainWindow::applyEntryEdit(EntryEdit const& edit) {
+  const QString current_path = currentImagePath();
+  const bool had_active_images = hasActiveImages();
+  const int from = comparison_model_.ActiveIndexOf(edit.path);
+  if (!comparison_model_.ApplyEdit(edit)) return false;
+  const int to = comparison_model_.ActiveIndexOf(edit.path);
+
+  if (!had_active_images) {
+    // Nothing is cached yet, so there is no decode window worth preserving.
+    rebuildActiveImages(current_path, 1);
+    return true;
+  }
+  if (from >= 0 && to >= 0) {
+    move->moveTo<MoveImage>(from, to);
+  } else if (from >= 0) {
+    move->moveTo<RemoveImage>(from);
+  } else if (to >= 0) {
+    move->moveTo<InsertImage>(to, PathStore::Shared().Intern(edit.path));
+  }
+
+  if (!hasActiveImages()) {
+    clearImage();
+  } else if (currentImagePath() != current_path) {
+    cache_->DisplayImage();
+  }
+  return true;
+}
+
 void MainWindow::activatePanelImage(QString path) {
   rebuildActiveImages(path, 1);
 }
 
 void MainWindow::deletePanelImage(QString path) {
-  const QString preferred_path = currentImagePath();
-  const int fallback_position = comparison_model_.EnabledPositionFor(path);
-
-  if (!QFile::moveToTrash(path)) {
-    MessageBox::inform(QString("Failed to delete: ") + path, 1500);
-    return;
-  }
-
-  comparison_model_.RemovePath(path);
-  images_panel_->SetEntries(comparison_model_.Entries());
-  rebuildActiveImages(preferred_path == path ? QString() : preferred_path,
-                      fallback_position);
+  removeImageFile(path, FileOperationQueue::Kind::Trash);
 }
 
 void MainWindow::deleteCurrentImage() {
-  const QString path = currentImagePath();
+  const QString path = shownImagePath();
   if (path.isEmpty()) return;
   deletePanelImage(path);
 }
 
+void MainWindow::moveCurrentImageToFolder() {
+  const QString path = shownImagePath();
+  if (path.isEmpty() || targetFolder().isEmpty()) return;
+  removeImageFile(path, FileOperationQueue::Kind::Move);
+}
+
+void MainWindow::copyCurrentImageToFolder() {
+  const QString path = shownImagePath();
+  if (path.isEmpty() || targetFolder().isEmpty()) return;
+  file_operations_->CopyTo(path, target_folder_);
+}
+
+void MainWindow::chooseTargetFolder() {
+  const QString folder = QFileDialog::getExistingDirectory(
+      this, QStringLiteral("Select target folder"),
+      target_folder_.isEmpty() ? g_basicPath : target_folder_);
+  if (!folder.isEmpty()) target_folder_ = folder;
+}
+
+QString const& MainWindow::targetFolder() {
+  if (target_folder_.isEmpty()) chooseTargetFolder();
+  return target_folder_;
+}
+
+void MainWindow::removeImageFile(QString const& path,
+                                 FileOperationQueue::Kind kind) {
+  const int row = comparison_model_.RowOf(path);
+  if (row < 0) return;
+  RemovedEntry removed{row, comparison_model_.Entries().at(row)};
+
+  // The image leaves the list right away; the file operation itself runs in
+  // the background and puts the entry back if it fails (or is undone).
+  if (!applyEntryEdit(EntryEdit{EntryEdit::Kind::Remove, path})) return;
+  const int id = kind == FileOperationQueue::Kind::Trash
+                     ? file_operations_->Trash(path)
+                     : file_operations_->MoveTo(path, target_folder_);
+  removed_entries_.insert(id, std::move(removed));
+  syncPanelEntries();
+  updatePanelCurrentImage();
+}
+
+void MainWindow::restoreRemovedEntry(int operation_id) {
+  const auto it = removed_entries_.constFind(operation_id);
+  if (it == removed_entries_.cend()) return;
+  const RemovedEntry removed = *it;
+  removed_entries_.erase(it);
+
+  const QString path = removed.entry.Path();
+  if (!applyEntryEdit(EntryEdit{EntryEdit::Kind::Insert, path, removed.row}))
+    return;
+  if (!removed.entry.enabled)
+    applyEntryEdit(EntryEdit{EntryEdit::Kind::Disable, path});
+  syncPanelEntries();
+  updatePanelCurrentImage();
+}
+
 void MainWindow::hideCurrentImage() {
-  const QString path = currentImagePath();
-  if (path.isEmpty() || !comparison_model_.SetPathEnabled(path, false)) return;
+  const QString path = shownImagePath();
+  if (path.isEmpty() ||
+      !applyEntryEdit(EntryEdit{EntryEdit::Kind::Disable, path}))
+    return;
 
-  images_panel_->SetEntries(comparison_model_.Entries());
-  rebuildActiveImages(path, 1);
+  syncPanelEntries();
+  updatePanelCurrentImage();
 }
 
 void MainWindow::navigateToPreviousImage() {
@@ -169,30 +528,45 @@ void MainWindow::navigateToNextImage() {
   updatePanelCurrentImage();
 }
 
+bool MainWindow::prepareNextImage() {
+  return !hasActiveImages() || cache_->PrepareSlot(1);
+}
+
+void MainWindow::setAutoScrollSpeed(double pixels_per_second) {
+  auto_scroll_speed_ = pixels_per_second;
+}
+
 void MainWindow::moveCurrentImage(int offset) {
-  const QString path = currentImagePath();
-  if (path.isEmpty() || !comparison_model_.MovePath(path, offset)) return;
+  const QString path = shownImagePath();
+  if (path.isEmpty()) return;
+  const int row = comparison_model_.RowOf(path);
+  if (!applyEntryEdit(EntryEdit{EntryEdit::Kind::Move, path, row + offset}))
+    return;
 
-  images_panel_->SetEntries(comparison_model_.Entries());
-  rebuildActiveImages(path, 1);
+  syncPanelEntries();
+  updatePanelCurrentImage();
 }
 
 void MainWindow::copyCurrentImageToClipboard() {
-  const QString path = currentImagePath();
+  const QString path = shownImagePath();
   if (path.isEmpty()) return;
 
   auto* mime_data = new QMimeData();
   mime_data->setUrls({QUrl::fromLocalFile(path)});
   mime_data->setText(path);
   QApplication::clipboard()->setMimeData(mime_data, QClipboard::Clipboard);
-  showCopyNotification(path);
+  showNotification(QStringLiteral("Copied to clipboard"),
+                   QFileInfo(path).fileName(), path);
 }
 
-void MainWindow::showCopyNotification(QString const& path) {
-  const QString file_name = QFileInfo(path).fileName();
-  if (ShowFlashNotifyNotification(path)) return;
+void MainWindow::showNotification(QString const& title, QString const& text,
+                                  QString const& image_path) {
+  if (ShowFlashNotifyNotification(title, text, image_path)) return;
 
-  if (!QSystemTrayIcon::supportsMessages()) return;
+  if (!QSystemTrayIcon::supportsMessages()) {
+    toast_->Show(title + QStringLiteral(": ") + text, kNotificationTimeoutMs);
+    return;
+  }
 
   if (tray_icon_ == nullptr) {
     tray_icon_ = new QSystemTrayIcon(this);
@@ -205,20 +579,38 @@ void MainWindow::showCopyNotification(QString const& path) {
     tray_icon_->show();
   }
 
-  tray_icon_->showMessage(QStringLiteral("Copied to clipboard"),
-                          file_name, QSystemTrayIcon::Information,
-                          kCopyNotificationTimeoutMs);
+  tray_icon_->showMessage(title, text, QSystemTrayIcon::Information,
+                          kNotificationTimeoutMs);
 }
 
 void MainWindow::updatePanelCurrentImage() {
-  images_panel_->SetCurrentPath(currentImagePath());
+  if (images_panel_) images_panel_->SetCurrentPath(currentImagePath());
+}
+
+bool MainWindow::isDisplayPending() const {
+  return cache_->HasPendingFrame();
+}
+
+void MainWindow::recordInputLatency() {
+  // A step is measured when its frame is painted, not an earlier one.
+  if (!key_pressed_.isValid() || cache_->HasPendingFrame()) return;
+  const double latency_ms = key_pressed_.nsecsElapsed() / 1e6;
+  key_pressed_.invalidate();
+  // Keys that did not change the image (zoom, panel, ...) still count
+  // towards latency, but say nothing about the decode window.
+  StepSample sample{latency_ms};
+  if (cache_->DisplayCount() != displays_at_key_press_) {
+    sample.resolve = cache_->LastResolve();
+    sample.wait_ms = cache_->LastWaitMs();
+  }
+  emit stepMeasured(sample);
 }
 
 void MainWindow::rebuildActiveImages(QString const& preferred_path,
                                      int fallback_position) {
-  QVector<QString> active_paths = comparison_model_.EnabledPaths();
-  if (active_paths.empty()) {
-    images_->setNewList(std::move(active_paths));
+  QVector<PathId> active_ids = comparison_model_.EnabledIds();
+  if (active_ids.empty()) {
+    images_->setNewList(std::move(active_ids));
     clearImage();
     updatePanelCurrentImage();
     return;
@@ -226,40 +618,123 @@ void MainWindow::rebuildActiveImages(QString const& preferred_path,
 
   int position = comparison_model_.EnabledPositionFor(preferred_path);
   if (position == 0) {
-    position = std::clamp(fallback_position, 1, active_paths.size());
+    position = std::clamp(fallback_position, 1, active_ids.size());
   }
 
-  images_->setNewList(std::move(active_paths));
+  images_->setNewList(std::move(active_ids));
   move->moveTo<ImageNumber>(position);
   cache_->DisplayImage();
   updatePanelCurrentImage();
 }
 
 void MainWindow::clearImage() {
+  shown_id_.reset();
+  item_->setScale(1);
   item_->setPixmap(QPixmap());
   setSceneRect(QRectF());
+  blink_->BaseChanged();
+  if (diff_mode_) requestDiff();
+  updateSplitView();
+  updateHistogram();
+}
+
+void MainWindow::toggleDiffMode() {
+  diff_mode_ = !diff_mode_;
+  if (diff_mode_ && !diff_->HasReference()) {
+    setDiffReference();
+    return;
+  }
+  requestDiff();
+}
+
+void MainWindow::setDiffReference() {
+  if (!shown_id_) return;
+  diff_->SetReference(shownImagePath(), cache_->ShownImage());
+  diff_mode_ = true;
+  requestDiff();
+}
+
+void MainWindow::requestDiff() {
+  // The heatmap of the previous image must not linger over this one.
+  diff_item_->setPixmap(QPixmap());
+  if (!diff_mode_ || !hasActiveImages() || !imageDisplayed()) {
+    diff_->Cancel();
+    diff_label_->hide();
+    return;
+  }
+  diff_label_->setText(
+      diff_->HasReference()
+          ? QStringLiteral("diff against %1 ...")
+                .arg(QFileInfo(diff_->ReferencePath()).fileName())
+          : QStringLiteral("diff: press R to pick the reference image"));
+  placeDiffLabel();
+  // What is on screen: never waits for a frame that is still pending.
+  diff_->Compare(cache_->ShownImage());
+}
+
+void MainWindow::showDiff(QImage heatmap, DiffStats stats) {
+  if (!diff_mode_) return;
+  diff_item_->setPixmap(QPixmap::fromImage(heatmap));
+  diff_label_->setText(
+      QStringLiteral("diff against %1: %2 of %3 pixels changed (%4%), max %5")
+          .arg(QFileInfo(diff_->ReferencePath()).fileName())
+          .arg(stats.changed)
+          .arg(stats.pixels)
+          .arg(stats.pixels ? 100.0 * stats.changed / stats.pixels : 0.0, 0,
+               'f', 2)
+          .arg(stats.max_delta));
+  placeDiffLabel();
+}
+
+void MainWindow::placeDiffLabel() {
+  constexpr int kMargin = 8;
+  diff_label_->adjustSize();
+  diff_label_->move(kMargin, height() - diff_label_->height() - kMargin);
+  diff_label_->raise();
+  diff_label_->show();
 }
 
 void MainWindow::Construct() {
-  currentScreen = screen();
   setFocusPolicy(Qt::StrongFocus);
 
   scene_ = new QGraphicsScene(this);
   item_ = new QGraphicsPixmapItem();
   item_->setTransformationMode(Qt::SmoothTransformation);
   scene_->addItem(item_);
+  // A child of item_, so it follows the image's scale and stays pixel-exact.
+  diff_item_ = new QGraphicsPixmapItem(item_);
+  blink_ = new BlinkComparison(item_, this);
+  histogram_ = new HistogramOverlay(this);
+  toast_ = new Toast(this);
+  // The latest window takes the messages; one that is gone drops them.
+  MessageBox::SetSink([toast = QPointer<Toast>(toast_)](QString const& info,
+                                                        int for_time_ms) {
+    if (toast) toast->Show(info, for_time_ms);
+  });
   setScene(scene_);
 
   // Dark background matching the original Viewer palette.
   setBackgroundBrush(QColor(32, 32, 32));
 
   wheel_scrolling = std::make_unique<WheelScrollingState>();
+  auto_scroll_speed_ = AutoScrolling::kDefaultSpeed;
   sliders_state = std::make_unique<SlidersState>(this);
 
   auto update_image = [this](QPixmap const& image) {
+    shown_id_ = image.isNull() ? std::nullopt
+                               : PathStore::Shared().Find(cache_->ShownPath());
     item_->setPixmap(image);
-    setSceneRect(item_->boundingRect());
+    // A frame stands in for the full image, like a startup preview, so zoom,
+    // native size and scroll positions stay in image pixels.
+    const QImage full = image.isNull() ? QImage() : cache_->ShownImage();
+    item_->setScale(full.isNull() ? 1 : qreal(full.width()) / image.width());
+    diff_item_->setScale(1 / item_->scale());
+    setSceneRect(full.isNull() ? item_->boundingRect()
+                               : QRectF(QPointF(0, 0), full.size()));
     if (!image.isNull()) applyZoom();
+    blink_->BaseChanged();
+    if (diff_mode_) requestDiff();
+    updateHistogram();
   };
   int initial_task_queue, cache_capacity;
   initial_task_queue = cache_capacity = 10;
@@ -267,105 +742,286 @@ void MainWindow::Construct() {
   images_->CreateTaskQueue<TaskQueue>(initial_task_queue);
   cache_ = images_->CreateCacheObject<CachedImagesList>(cache_capacity,
                                                         update_image);
+  updateFrameTarget();
 
+  cache_->SetSlotReadyCallback([this] {
+    updateSplitView();
+    updateHistogram();
+  });
   cache_->SetScrollCallbacks(
       std::bind(&SlidersState::SaveScrollPosition, sliders_state.get()),
       std::bind(&SlidersState::RestoreScrollPosition, sliders_state.get()),
       [this] { return imageDisplayed(); });
 
   folders_ = std::make_shared<FolderPath>();
-  auto is_null_image = [this] { return item_->pixmap().isNull(); };
+  // A frame still being decoded counts as shown: the step that requested it
+  // has been taken, so the next one moves on rather than redisplaying it.
+  auto is_null_image = [this] {
+    return item_->pixmap().isNull() && !cache_->HasPendingFrame();
+  };
   move = std::make_unique<move_t>(images_, cache_, folders_, is_null_image);
 
   arrows_scroller_ =
       new ArrowKeysScroller(horizontalScrollBar(), verticalScrollBar());
-  m_psd = new ImagesSelectorDialog(this);
-  images_panel_ = new ImagesListPanel(this);
   tray_icon_ = nullptr;
+  file_operations_ = new FileOperationQueue(this);
+  hud_ = new PerformanceHud(this);
+  hud_->SetCacheStatsSource([this] { return cache_->Stats(); });
+  connect(this, &MainWindow::stepMeasured, hud_, &PerformanceHud::RecordStep);
+  diff_ = new DiffOverlay(this);
+  connect(diff_, &DiffOverlay::ready, this, &MainWindow::showDiff);
+  diff_label_ = new QLabel(this);
+  diff_label_->setStyleSheet(QStringLiteral(
+      "background: rgba(0, 0, 0, 170); color: rgb(230, 230, 230);"
+      "padding: 4px; border-radius: 6px;"));
+  diff_label_->hide();
+  split_view_ = new SplitView(this);
+  split_view_->hide();
+  render_quality_ = new RenderQuality(this);
+  connect(render_quality_, &RenderQuality::changed, this,
+          &MainWindow::setSmoothRendering);
+  connect(arrows_scroller_, &ArrowKeysScroller::scrolled, render_quality_,
+          &RenderQuality::Interact);
+  relayout_ = new QTimer(this);
+  relayout_->setSingleShot(true);
+  relayout_->setTimerType(Qt::PreciseTimer);
+  relayout_->setInterval(kFrameMs);
+  relayout_->callOnTimeout(this, [this] {
+    if (!relayout_pending_) return;
+    relayout_pending_ = false;
+    relayout();
+    relayout_->start();
+  });
+  // Panning moves the main view's scroll bars; the other panes follow.
+  connect(horizontalScrollBar(), &QScrollBar::valueChanged, this,
+          &MainWindow::updateSplitView);
+  connect(verticalScrollBar(), &QScrollBar::valueChanged, this,
+          &MainWindow::updateSplitView);
   formatWidget();
 
-  connect(images_panel_, &ImagesListPanel::entriesChanged, this,
-          &MainWindow::applyPanelEntries);
-  connect(images_panel_, &ImagesListPanel::imageActivated, this,
-          &MainWindow::activatePanelImage);
-  connect(images_panel_, &ImagesListPanel::imageDeleteRequested, this,
-          &MainWindow::deletePanelImage);
-  connect(images_panel_, &ImagesListPanel::previousImageRequested, this,
-          &MainWindow::navigateToPreviousImage);
-  connect(images_panel_, &ImagesListPanel::nextImageRequested, this,
-          &MainWindow::navigateToNextImage);
-  connect(images_panel_, &ImagesListPanel::zoomInRequested, this,
-          [this] { zoomBy(1.25); });
-  connect(images_panel_, &ImagesListPanel::zoomOutRequested, this,
-          [this] { zoomBy(0.8); });
+  connect(file_operations_, &FileOperationQueue::failed, this,
+          [this](FileOperationQueue::Operation operation, QString reason) {
+            restoreRemovedEntry(operation.id);
+            showNotification(
+                QStringLiteral("Failed to ") + OperationName(operation.kind),
+                QFileInfo(operation.source).fileName() +
+                    QStringLiteral(": ") + reason);
+          });
+  connect(file_operations_, &FileOperationQueue::undone, this,
+          [this](FileOperationQueue::Operation operation) {
+            restoreRemovedEntry(operation.id);
+          });
+  connect(file_operations_, &FileOperationQueue::expired, this,
+          [this](int id) { removed_entries_.remove(id); });
+  connect(file_operations_, &FileOperationQueue::undoFailed, this,
+          [this](FileOperationQueue::Operation operation, QString reason) {
+            removed_entries_.remove(operation.id);
+            showNotification(
+                QStringLiteral("Failed to undo ") +
+                    OperationName(operation.kind),
+                QFileInfo(operation.source).fileName() +
+                    QStringLiteral(": ") + reason);
+          });
+
   connect(folders_.get(), &FolderPath::folderIsChanged, [this] {
     if (hasActiveImages()) move->moveTo<BeginOfTheList>();
     clearImage();
   });
   connect(this, &MainWindow::chooseFilesToOpen, [this] {
     clearImage();
-    m_psd->exec();
+    selector()->exec();
   });
   connect(this, &MainWindow::displayImageNumber, [this] {
-    MessageBox::inform(
+    toast_->Show(
         hasActiveImages() ? images_->imageNumber() : QString("0 / 0"), 1000);
   });
-  connect(this, &MainWindow::repaintImage, [this] {
-    if (imageDisplayed()) {
-      cache_.get()->DisplayImage();
-      applyZoom();
-      updatePanelCurrentImage();
-    }
-  });
-
-  connect(m_psd, &ImagesSelectorDialog::updateFolderList,
-          [this](QList<QString> list) {
-            if (!list.empty()) {
-              QVector<QString> vector;
-              std::move(list.begin(), list.end(), std::back_inserter(vector));
-              folders_->setNewList(std::move(vector));
-            }
-          });
-  connect(m_psd, &ImagesSelectorDialog::stringListPrepared,
-          [this](QList<QString> list, int pos) {
-            if (!list.empty()) {
-              setComparisonImages(std::move(list), pos);
-            }
-          });
-
-  m_psd->AssociateWith(folders_);
 }
 
 MainWindow::MainWindow(QString path, int pos, QWidget* parent)
     : QGraphicsView(parent) {
   Construct();
-  m_psd->setDirectory(path, pos);
+  if (!path.isEmpty()) {
+    QList<QString> images = ImagesInDirectory(QDir(path));
+    if (!images.empty()) setComparisonImages(std::move(images), pos);
+  }
 }
 
 MainWindow::MainWindow(QList<QString> images, QWidget* parent)
     : QGraphicsView(parent) {
   Construct();
-  m_psd->setImages(images);
+  if (!images.empty()) setComparisonImages(std::move(images), 1);
+}
+
+void MainWindow::openWhenLoaded(StartupLoader* loader) {
+  loader->setParent(this);
+  startup_ = loader;
+  opening_ = true;
+  connect(loader, &StartupLoader::loaded, this,
+          &MainWindow::showStartupResult);
+}
+
+void MainWindow::showStartupResult(StartupLoader::Result result) {
+  // Without a preview to put up first, or if something else was opened in
+  // the meantime, there is nothing to wait for.
+  if (hasActiveImages() || result.images.empty() || result.preview.isNull() ||
+      !isVisible()) {
+    finishOpening(std::move(result));
+    return;
+  }
+  // The preview stands in for the full image at its full size, so zoom and
+  // scroll position carry over when the real pixmap replaces it.
+  item_->setPixmap(QPixmap::fromImage(result.preview));
+  item_->setScale(result.image_size.isValid()
+                      ? qreal(result.image_size.width()) /
+                            result.preview.width()
+                      : 1);
+  setSceneRect(item_->sceneBoundingRect());
+  applyZoom();
+  result.preview = QImage();
+  startup_list_ = std::move(result);
+}
+
+void MainWindow::openImages(QList<QString> images, int position) {
+  trace::Scope scope("open images");
+  if (images.empty()) return;
+  setComparisonImages(std::move(images), position);
+  show();
+  raise();
+  activateWindow();
+}
+
+void MainWindow::finishOpening(StartupLoader::Result result) {
+  if (!hasActiveImages() && !result.images.empty())
+    setComparisonImages(std::move(result.images), result.position);
+  opening_ = false;
+  emit opened();
+}
+
+bool MainWindow::startRecording(QString const& path) {
+  recorder_ = std::make_unique<SessionRecorder>(path);
+  if (!recorder_->IsOpen()) recorder_.reset();
+  return recorder_ != nullptr;
+}
+
+void MainWindow::replayEvent(SessionEvent const& event) {
+  using Type = SessionEvent::Type;
+  switch (event.type) {
+    case Type::KeyPress:
+    case Type::KeyRelease: {
+      const auto modifiers = Qt::KeyboardModifiers(event.modifiers);
+      if (IsReplaySafe(event.key, modifiers)) {
+        QKeyEvent key(event.type == Type::KeyPress ? QEvent::KeyPress
+                                                   : QEvent::KeyRelease,
+                      event.key, modifiers, QString(), event.repeat);
+        QCoreApplication::sendEvent(this, &key);
+        break;
+      }
+      const bool removes_image =
+          event.type == Type::KeyPress && modifiers == Qt::NoModifier &&
+          (event.key == Qt::Key_Delete || event.key == Qt::Key_M);
+      const QString path = shownImagePath();
+      if (!removes_image || path.isEmpty()) break;
+      noteKeyPress();
+      if (applyEntryEdit(EntryEdit{EntryEdit::Kind::Remove, path})) {
+        syncPanelEntries();
+        updatePanelCurrentImage();
+      }
+      break;
+    }
+    case Type::Edit: {
+      EntryEdit edit = event.edit;
+      edit.path = pathForFileName(edit.path);
+      if (edit.path.isEmpty() || !applyEntryEdit(edit)) break;
+      syncPanelEntries();
+      updatePanelCurrentImage();
+      break;
+    }
+    case Type::Activate: {
+      const QString path = pathForFileName(event.name);
+      if (!path.isEmpty()) activatePanelImage(path);
+      break;
+    }
+  }
+}
+
+QString MainWindow::pathForFileName(QString const& name) const {
+  PathStore const& store = PathStore::Shared();
+  for (ImageEntry const& entry : comparison_model_.Entries()) {
+    if (store.FileName(entry.id) == name) return entry.Path();
+  }
+  return QString();
+}
+
+void MainWindow::recordEdit(EntryEdit const& edit) {
+  if (!recorder_) return;
+  SessionEvent event{0, SessionEvent::Type::Edit};
+  event.edit = edit;
+  recorder_->Record(std::move(event));
+}
+
+void MainWindow::noteKeyPress() {
+  if (key_pressed_.isValid()) return;
+  key_pressed_.start();
+  displays_at_key_press_ = cache_->DisplayCount();
+  // Repaints are requested at Qt::LowEventPriority, so this comes after the
+  // one the key caused, if any, within the same pass of the event loop.
+  QCoreApplication::postEvent(this, new QEvent(kSettleKeyPress),
+                              Qt::LowEventPriority - 1);
+}
+
+void MainWindow::settleKeyPress() {
+  // Painted already, or still waiting for its frame.
+  if (!key_pressed_.isValid() || cache_->HasPendingFrame() ||
+      cache_->DisplayCount() != displays_at_key_press_)
+    return;
+  // Nothing will be painted for it; left armed, it would time the next key
+  // from this one.
+  key_pressed_.invalidate();
+}
+
+void MainWindow::customEvent(QEvent* e) {
+  if (e->type() == kSettleKeyPress) return settleKeyPress();
+  QGraphicsView::customEvent(e);
 }
 
 void MainWindow::keyReleaseEvent(QKeyEvent* pe) {
   if (pe->isAutoRepeat()) return QWidget::keyReleaseEvent(pe);
+  if (recorder_) {
+    recorder_->Record(SessionEvent{0, SessionEvent::Type::KeyRelease, pe->key(),
+                                   int(pe->modifiers())});
+  }
   if (ArrowKeysScroller::isArrowKeys(pe)) {
     arrows_scroller_->setKeyState(pe);
   }
+  if (pe->key() == Qt::Key_X && !blink_->IsRunning()) {
+    blink_->ShowPartner(false);
+  }
   QWidget::keyReleaseEvent(pe);
 }
 
+void MainWindow::focusOutEvent(QFocusEvent* e) {
+  // Keys let go of elsewhere never send their release here.
+  arrows_scroller_->releaseAll();
+  QGraphicsView::focusOutEvent(e);
+}
+
 void MainWindow::keyPressEvent(QKeyEvent* pe) {
+  trace::Instant("key", "key", pe->key());
+  noteKeyPress();
+  if (recorder_) {
+    recorder_->Record(SessionEvent{0, SessionEvent::Type::KeyPress, pe->key(),
+                                   int(pe->modifiers()), pe->isAutoRepeat()});
+  }
   if (ArrowKeysScroller::isArrowKeys(pe) &&
       ArrowKeysScroller::isNoModifier(pe)) {
     arrows_scroller_->setKeyState(pe);
   }
   switch (pe->key()) {
     case Qt::Key_Q: {
-      auto_scrolling = (auto_scrolling == nullptr)
-                           ? std::make_unique<AutoScrolling>(*this)
-                           : nullptr;
+      auto_scrolling =
+          (auto_scrolling == nullptr)
+              ? std::make_unique<AutoScrolling>(*this, auto_scroll_speed_)
+              : nullptr;
       break;
     }
     case Qt::Key_BracketRight: {
@@ -441,6 +1097,26 @@ void MainWindow::keyPressEvent(QKeyEvent* pe) {
       }
       break;
     }
+    case Qt::Key_M: {
+      if (pe->modifiers() == Qt::NoModifier) {
+        moveCurrentImageToFolder();
+      } else if (pe->modifiers() == Qt::ControlModifier) {
+        chooseTargetFolder();
+      }
+      break;
+    }
+    case Qt::Key_Y: {
+      if (pe->modifiers() == Qt::NoModifier) {
+        copyCurrentImageToFolder();
+      }
+      break;
+    }
+    case Qt::Key_Z: {
+      if (pe->modifiers() == Qt::ControlModifier) {
+        file_operations_->Undo();
+      }
+      break;
+    }
     case Qt::Key_O: {
       emit chooseFilesToOpen();
       break;
@@ -485,6 +1161,61 @@ void MainWindow::keyPressEvent(QKeyEvent* pe) {
       }
       break;
     }
+    case Qt::Key_D: {
+      if (pe->modifiers() == Qt::NoModifier) {
+        toggleDiffMode();
+      }
+      break;
+    }
+    case Qt::Key_R: {
+      if (pe->modifiers() == Qt::NoModifier) {
+        setDiffReference();
+      }
+      break;
+    }
+    case Qt::Key_B: {
+      if (pe->modifiers() == Qt::NoModifier) {
+        toggleBlink();
+      } else if (pe->modifiers() == Qt::ShiftModifier) {
+        pinBlinkPartner();
+      }
+      break;
+    }
+    case Qt::Key_X: {
+      if (pe->modifiers() == Qt::NoModifier && !pe->isAutoRepeat() &&
+          !blink_->IsRunning() && ensureBlinkPartner()) {
+        blink_->ShowPartner(true);
+      }
+      break;
+    }
+    case Qt::Key_G: {
+      if (pe->modifiers() == Qt::NoModifier) {
+        jumpToCluster(1);
+      } else if (pe->modifiers() == Qt::ShiftModifier) {
+        jumpToCluster(-1);
+      }
+      break;
+    }
+    case Qt::Key_V: {
+      if (pe->modifiers() == Qt::NoModifier) {
+        setSplitPanes(split_panes_ > 1 ? 1 : last_split_panes_);
+      } else if (pe->modifiers() == Qt::ShiftModifier) {
+        setSplitPanes(split_panes_ < SplitView::kMaxPanes ? split_panes_ + 1
+                                                          : 2);
+      }
+      break;
+    }
+    case Qt::Key_I: {
+      if (pe->modifiers() == Qt::NoModifier) {
+        histogram_->Toggle(viewport()->geometry());
+        updateHistogram();
+      }
+      break;
+    }
+    case Qt::Key_F12: {
+      hud_->Toggle();
+      break;
+    }
     default: {
     }
   }
@@ -508,6 +1239,7 @@ void MainWindow::mousePressEvent(QMouseEvent* pe) {
 }
 
 void MainWindow::wheelEvent(QWheelEvent* pe) {
+  render_quality_->Interact();
   if (!wheel_scrolling->isHorizontal()) {
     QGraphicsView::wheelEvent(pe);
     return;
@@ -521,16 +1253,45 @@ void MainWindow::wheelEvent(QWheelEvent* pe) {
 }
 
 void MainWindow::moveEvent(QMoveEvent*) {
-  QCoreApplication::processEvents();
-  if (currentScreen->geometry() != screen()->geometry()) {
-    currentScreen = screen();
-    emit repaintImage();
-  }
+  // Checked once the move has been handled and screen() is up to date,
+  // rather than pumping the event loop in here. Moving to a screen of
+  // another pixel ratio re-targets the displayed image.
+  QTimer::singleShot(0, this, [this] { updateFrameTarget(); });
 }
 
 void MainWindow::resizeEvent(QResizeEvent* e) {
   QGraphicsView::resizeEvent(e);
-  if (imageDisplayed()) applyZoom();
+  render_quality_->Interact();
+  // Resizing a window by hand sends a storm of resizes: the first one is laid
+  // out at once, the rest at most once per frame.
+  if (relayout_->isActive()) {
+    relayout_pending_ = true;
+    return;
+  }
+  relayout();
+  relayout_->start();
+}
+
+void MainWindow::paintEvent(QPaintEvent* e) {
+  {
+    trace::Scope scope("paint");
+    QGraphicsView::paintEvent(e);
+  }
+  recordInputLatency();
+  if (startup_ && imageDisplayed()) {
+    const qint64 elapsed_ms = startup_->ElapsedMs();
+    trace::Instant("first image painted", "ms", elapsed_ms);
+    hud_->SetStartupTime(elapsed_ms);
+    startup_ = nullptr;
+  }
+  if (startup_list_) {
+    // The preview is on screen; now fill the decode window, starting with
+    // the full-size start image.
+    QTimer::singleShot(0, this, [this, result = *startup_list_] {
+      finishOpening(result);
+    });
+    startup_list_.reset();
+  }
 }
 
 void MainWindow::mouseDoubleClickEvent(QMouseEvent* pe) {
@@ -0,0 +1,129 @@
+#include "path_store.hpp"
+
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+
+PathStore& PathStore::Shared() {
+  static PathStore store;
+  return store;
+}
+
+std::pair<QString, QByteArray> PathStore::Split(QString const& path) {
+  const int slash = path.lastIndexOf(QLatin1Char('/'));
+  return {path.left(slash + 1), path.mid(slash + 1).toUtf8()};
+}
+
+std::size_t PathStore::Hash(quint32 dir, const char* name, int size) {
+  // FNV-1a, seeded with the directory.
+  std::uint64_t hash = 14695981039346656037ull ^ dir;
+  for (int i = 0; i < size; ++i) {
+    hash ^= static_cast<unsigned char>(name[i]);
+    hash *= 1099511628211ull;
+  }
+  return std::size_t(hash ^ (hash >> 32));
+}
+
+quint32 PathStore::NameEnd(PathId id) const {
+  return id + 1 < name_at_.size() ? name_at_[id + 1] : quint32(names_.size());
+}
+
+std::size_t PathStore::Slot(quint32 dir, QByteArray const& name) const {
+  const std::size_t mask = table_.size() - 1;
+  for (std::size_t slot = Hash(dir, name.constData(), name.size()) & mask;;
+       slot = (slot + 1) & mask) {
+    const PathId id = table_[slot];
+    if (id == kEmpty) return slot;
+    const quint32 begin = name_at_[id];
+    const quint32 end = NameEnd(id);
+    if (dir_of_[id] == dir && end - begin == quint32(name.size()) &&
+        std::memcmp(names_.data() + begin, name.constData(), name.size()) == 0)
+      return slot;
+  }
+}
+
+void PathStore::Grow() {
+  table_.assign(std::max<std::size_t>(table_.size() * 2, 1024), kEmpty);
+  const std::size_t mask = table_.size() - 1;
+  for (PathId id = 0; id < dir_of_.size(); ++id) {
+    const quint32 begin = name_at_[id];
+    const quint32 end = NameEnd(id);
+    std::size_t slot =
+        Hash(dir_of_[id], names_.data() + begin, int(end - begin)) & mask;
+    while (table_[slot] != kEmpty) slot = (slot + 1) & mask;
+    table_[slot] = id;
+  }
+}
+
+PathId PathStore::Intern(QString const& path) {
+  const auto [dir, name] = Split(path);
+  quint32 dir_id = dir_ids_.value(dir, kEmpty);
+  if (dir_id == kEmpty) {
+    dir_id = quint32(dirs_.size());
+    dirs_.push_back(dir);
+    dir_ids_.insert(dir, dir_id);
+  }
+  // At most half full, so that probe sequences stay short.
+  if (2 * (dir_of_.size() + 1) > table_.size()) Grow();
+  const std::size_t slot = Slot(dir_id, name);
+  if (table_[slot] != kEmpty) return table_[slot];
+
+  const PathId id = PathId(dir_of_.size());
+  dir_of_.push_back(dir_id);
+  name_at_.push_back(quint32(names_.size()));
+  names_.insert(names_.end(), name.constData(), name.constData() + name.size());
+  table_[slot] = id;
+  return id;
+}
+
+std::optional<PathId> PathStore::Find(QString const& path) const {
+  if (table_.empty()) return std::nullopt;
+  const auto [dir, name] = Split(path);
+  const quint32 dir_id = dir_ids_.value(dir, kEmpty);
+  if (dir_id == kEmpty) return std::nullopt;
+  const PathId id = table_[Slot(dir_id, name)];
+  if (id == kEmpty) return std::nullopt;
+  return id;
+}
+
+QString PathStore::FileName(PathId id) const {
+  const quint32 begin = name_at_[id];
+  return QString::fromUtf8(names_.data() + begin, int(NameEnd(id) - begin));
+}
+
+QString PathStore::Path(PathId id) const {
+  return dirs_.at(dir_of_[id]) + FileName(id);
+}
+
+qint64 PathStore::MemoryBytes() const {
+  qint64 bytes = qint64(names_.capacity()) +
+                 qint64(dir_of_.capacity() + name_at_.capacity() +
+                        table_.capacity()) *
+                     sizeof(quint32);
+  // Directories are few: a header and the characters each.
+  for (QString const& dir : dirs_) bytes += 32 + 2 * dir.capacity();
+  return bytes;
+}
+
+QVector<PathId> PathStore::Intern(QVector<QString> const& paths) {
+  // Room for the new paths only: listing a folder again adds nothing, and
+  // must not grow the store either.
+  const auto added = std::count_if(
+      paths.begin(), paths.end(),
+      [this](QString const& path) { return !Find(path); });
+  if (added > 0) {
+    dir_of_.reserve(dir_of_.size() + added);
+    name_at_.reserve(name_at_.size() + added);
+  }
+  QVector<PathId> ids;
+  ids.reserve(paths.size());
+  for (QString const& path : paths) ids.push_back(Intern(path));
+  return ids;
+}
+
+QVector<QString> PathStore::Paths(QVector<PathId> const& ids) const {
+  QVector<QString> paths;
+  paths.reserve(ids.size());
+  for (PathId id : ids) paths.push_back(Path(id));
+  return paths;
+}
@@ -0,0 +1,107 @@
+#include "perceptual_hash.hpp"
+
+#include <QHash>
+#include <QImageReader>
+#include <algorithm>
+#include <numeric>
+#include <vector>
+
+namespace {
+
+// Hashing needs only a thumbnail; JPEG readers decode straight to it.
+constexpr QSize kHashSource{64, 64};
+
+class DisjointSets {
+ public:
+  explicit DisjointSets(int size) : parent_(size) {
+    std::iota(parent_.begin(), parent_.end(), 0);
+  }
+  int Find(int item) {
+    while (parent_[item] != item) {
+      parent_[item] = parent_[parent_[item]];
+      item = parent_[item];
+    }
+    return item;
+  }
+  void Join(int a, int b) {
+    a = Find(a);
+    b = Find(b);
+    if (a != b) parent_[std::max(a, b)] = std::min(a, b);
+  }
+
+ private:
+  std::vector<int> parent_;
+};
+
+}  // namespace
+
+quint64 DifferenceHash(QImage const& image) {
+  const QImage grey = image.scaled(9, 8, Qt::IgnoreAspectRatio,
+                                   Qt::SmoothTransformation)
+                          .convertToFormat(QImage::Format_Grayscale8);
+  quint64 hash = 0;
+  for (int y = 0; y < 8; ++y) {
+    const uchar* line = grey.constScanLine(y);
+    for (int x = 0; x < 8; ++x) hash = hash << 1 | (line[x] < line[x + 1]);
+  }
+  return hash;
+}
+
+std::optional<quint64> HashImage(QString const& path,
+                                 PreviewCache const& cache) {
+  QImage image;
+  if (std::optional<PreviewCache::Entry> entry = cache.Find(path, kHashSource))
+    image = std::move(entry->preview);
+  if (image.isNull()) {
+    QImageReader reader(path);
+    const QSize size = reader.size();
+    if (size.isValid())
+      reader.setScaledSize(size.scaled(kHashSource, Qt::KeepAspectRatio));
+    image = reader.read();
+  }
+  if (image.isNull()) return std::nullopt;
+  return DifferenceHash(image);
+}
+
+clusters_t NearDuplicateClusters(
+    QVector<std::optional<quint64>> const& hashes, int max_distance) {
+  max_distance = std::clamp(max_distance, 0, 63);
+  const int blocks = max_distance + 1;
+  DisjointSets sets(hashes.size());
+  for (int block = 0; block < blocks; ++block) {
+    const int first_bit = 64 * block / blocks;
+    const int width = 64 * (block + 1) / blocks - first_bit;
+    const quint64 mask = width == 64 ? ~0ull : (1ull << width) - 1;
+    QHash<quint64, std::vector<int>> buckets;
+    for (int i = 0; i < hashes.size(); ++i) {
+      if (hashes[i]) buckets[*hashes[i] >> first_bit & mask].push_back(i);
+    }
+    for (std::vector<int> const& bucket : buckets) {
+      for (std::size_t a = 0; a < bucket.size(); ++a) {
+        const quint64 hash = *hashes[bucket[a]];
+        for (std::size_t b = a + 1; b < bucket.size(); ++b) {
+          if (HammingDistance(hash, *hashes[bucket[b]]) <= max_distance)
+            sets.Join(bucket[a], bucket[b]);
+        }
+      }
+    }
+  }
+
+  // A root is its set's smallest index, so a cluster is numbered as soon
+  // as its first member comes up.
+  std::vector<int> sizes(hashes.size(), 0);
+  for (int i = 0; i < hashes.size(); ++i) ++sizes[sets.Find(i)];
+  clusters_t clusters;
+  QHash<int, int> cluster_of_root;
+  for (int i = 0; i < hashes.size(); ++i) {
+    const int root = sets.Find(i);
+    if (sizes[root] < 2) continue;
+    auto cluster = cluster_of_root.find(root);
+    if (cluster == cluster_of_root.end()) {
+      cluster = cluster_of_root.insert(root, clusters.size());
+      clusters.append({});
+    }
+    clusters[*cluster].append(i);
+  }
+  return clusters;
+}
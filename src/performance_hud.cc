@@ -0,0 +1,126 @@
+#include "performance_hud.hpp"
+
+#include <QFontDatabase>
+#include <QFontMetrics>
+#include <QPainter>
+#include <algorithm>
+
+namespace {
+
+constexpr int kRefreshIntervalMs = 250;
+constexpr int kMargin = 8;
+constexpr int kHistogramHeight = 40;
+
+QString Milliseconds(double value) {
+  return QString::number(value, 'f', value < 10 ? 1 : 0) +
+         QStringLiteral(" ms");
+}
+
+QString Mebibytes(qint64 bytes) {
+  return QString::number(bytes / (1024.0 * 1024.0), 'f', 1) +
+         QStringLiteral(" MiB");
+}
+
+QString BucketLabel(std::size_t bucket) {
+  return bucket < StepStats::kBucketLimits.size()
+             ? QString::number(StepStats::kBucketLimits[bucket])
+             : QStringLiteral(">");
+}
+
+}  // namespace
+
+PerformanceHud::PerformanceHud(QWidget* parent) : QWidget(parent) {
+  setAttribute(Qt::WA_TransparentForMouseEvents);
+  setFont(QFontDatabase::systemFont(QFontDatabase::FixedFont));
+  refresh_.setInterval(kRefreshIntervalMs);
+  connect(&refresh_, &QTimer::timeout, this, [this] { update(); });
+  hide();
+}
+
+void PerformanceHud::SetCacheStatsSource(std::function<CacheStats()> source) {
+  cache_stats_ = std::move(source);
+}
+
+void PerformanceHud::RecordStep(StepSample const& sample) {
+  steps_.Record(sample);
+  if (isVisible()) update();
+}
+
+void PerformanceHud::SetStartupTime(qint64 first_image_ms) {
+  first_image_ms_ = first_image_ms;
+}
+
+void PerformanceHud::Toggle() {
+  if (isVisible()) {
+    refresh_.stop();
+    hide();
+    return;
+  }
+  const QFontMetrics metrics(font());
+  resize(metrics.horizontalAdvance(QString(44, QLatin1Char('0'))) +
+             2 * kMargin,
+         metrics.lineSpacing() * (Lines().size() + 1) + kHistogramHeight +
+             3 * kMargin);
+  move(kMargin, kMargin);
+  raise();
+  show();
+  refresh_.start();
+}
+
+QStringList PerformanceHud::Lines() const {
+  QStringList lines;
+  lines << QStringLiteral("key to paint  p50 %1  p95 %2")
+               .arg(Milliseconds(steps_.Percentile(0.5)),
+                    Milliseconds(steps_.Percentile(0.95)));
+  lines << QStringLiteral("steps %1  ready %2  converted %3")
+               .arg(steps_.Count())
+               .arg(steps_.CountOf(SlotResolve::Ready))
+               .arg(steps_.CountOf(SlotResolve::Converted));
+  lines << QStringLiteral("blocked on decode %1  avg wait %2")
+               .arg(steps_.CountOf(SlotResolve::Blocked))
+               .arg(Milliseconds(steps_.MeanBlockedWaitMs()));
+  const CacheStats cache = cache_stats_ ? cache_stats_() : CacheStats{};
+  lines << QStringLiteral("decodes pending %1").arg(cache.decoding);
+  lines << QStringLiteral("window %1/%2 ready  %3")
+               .arg(cache.ready)
+               .arg(cache.size)
+               .arg(Mebibytes(cache.bytes));
+  if (first_image_ms_ >= 0) {
+    lines << QStringLiteral("startup to first image %1")
+                 .arg(Milliseconds(first_image_ms_));
+  }
+  return lines;
+}
+
+void PerformanceHud::paintEvent(QPaintEvent*) {
+  QPainter painter(this);
+  painter.setRenderHint(QPainter::Antialiasing);
+  painter.setPen(Qt::NoPen);
+  painter.setBrush(QColor(0, 0, 0, 170));
+  painter.drawRoundedRect(rect(), 6, 6);
+
+  const QFontMetrics metrics(font());
+  painter.setPen(QColor(230, 230, 230));
+  int y = kMargin + metrics.ascent();
+  for (QString const& line : Lines()) {
+    painter.drawText(kMargin, y, line);
+    y += metrics.lineSpacing();
+  }
+
+  // Latency histogram: one bar per bucket, scaled to the fullest bucket,
+  // labelled with the bucket's upper bound in ms. Up to two frames at 60 Hz
+  // is green.
+  const StepStats::histogram_t histogram = steps_.Histogram();
+  const int fullest =
+      std::max(1, *std::max_element(histogram.begin(), histogram.end()));
+  const int bar_width = (width() - 2 * kMargin) / int(histogram.size());
+  const int base = y - metrics.ascent() + kMargin + kHistogramHeight;
+  for (std::size_t i = 0; i < histogram.size(); ++i) {
+    const int x = kMargin + int(i) * bar_width;
+    const int height = histogram[i] * kHistogramHeight / fullest;
+    painter.fillRect(x + 1, base - height, bar_width - 2, height,
+                     i < 3 ? QColor(90, 190, 90) : QColor(220, 140, 60));
+    painter.drawText(QRect(x, base, bar_width, metrics.lineSpacing()),
+                     Qt::AlignCenter, BucketLabel(i));
+  }
+}
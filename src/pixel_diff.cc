@@ -0,0 +1,193 @@
+#include "pixel_diff.hpp"
+
+#include <QtConcurrent>
+#include <algorithm>
+#include <cstdlib>
+#include <vector>
+
+#ifdef PVIEWER_X86_SIMD
+#include <immintrin.h>
+#endif
+
+namespace {
+
+constexpr int kBandRows = 64;
+
+struct RowStats {
+  qint64 changed = 0;
+  int max_delta = 0;
+};
+
+using row_kernel_t = void (*)(const quint32* a, const quint32* b,
+                              quint32* out, int n, int threshold, int gain,
+                              RowStats& stats);
+
+int Delta(quint32 a, quint32 b) {
+  int delta = 0;
+  for (int shift = 0; shift < 24; shift += 8) {
+    delta = std::max(
+        delta, std::abs(int((a >> shift) & 0xff) - int((b >> shift) & 0xff)));
+  }
+  return delta;
+}
+
+void DiffRowScalar(const quint32* a, const quint32* b, quint32* out, int n,
+                   int threshold, int gain, RowStats& stats) {
+  for (int i = 0; i < n; ++i) {
+    const int delta = Delta(a[i], b[i]);
+    stats.changed += delta > threshold;
+    stats.max_delta = std::max(stats.max_delta, delta);
+    const quint32 heat = std::min(255, delta * gain);
+    out[i] = heat << 24 | heat << 16;
+  }
+}
+
+#ifdef PVIEWER_X86_SIMD
+
+// Both vector kernels work on whole pixels in 32-bit lanes: the saturating
+// byte differences taken both ways give |a - b| per channel, two shifted
+// maxima fold the three colour channels into the lowest byte, and since the
+// gain is below 128 the product stays a positive 16-bit value that a signed
+// minimum can cap.
+
+__attribute__((target("sse2"))) void DiffRowSse2(const quint32* a,
+                                                 const quint32* b,
+                                                 quint32* out, int n,
+                                                 int threshold, int gain,
+                                                 RowStats& stats) {
+  const __m128i rgb = _mm_set1_epi32(0x00ffffff);
+  const __m128i low_byte = _mm_set1_epi32(0xff);
+  const __m128i limit = _mm_set1_epi32(threshold);
+  const __m128i factor = _mm_set1_epi32(gain);
+  __m128i max_delta = _mm_setzero_si128();
+  int i = 0;
+  for (; i + 4 <= n; i += 4) {
+    const __m128i va = _mm_loadu_si128(reinterpret_cast<const __m128i*>(a + i));
+    const __m128i vb = _mm_loadu_si128(reinterpret_cast<const __m128i*>(b + i));
+    __m128i delta = _mm_and_si128(
+        _mm_or_si128(_mm_subs_epu8(va, vb), _mm_subs_epu8(vb, va)), rgb);
+    delta = _mm_max_epu8(delta, _mm_srli_epi32(delta, 8));
+    delta = _mm_max_epu8(delta, _mm_srli_epi32(delta, 16));
+    delta = _mm_and_si128(delta, low_byte);
+    max_delta = _mm_max_epi16(max_delta, delta);
+    stats.changed += __builtin_popcount(
+        _mm_movemask_ps(_mm_castsi128_ps(_mm_cmpgt_epi32(delta, limit))));
+    const __m128i heat =
+        _mm_min_epi16(_mm_mullo_epi16(delta, factor), low_byte);
+    _mm_storeu_si128(
+        reinterpret_cast<__m128i*>(out + i),
+        _mm_or_si128(_mm_slli_epi32(heat, 24), _mm_slli_epi32(heat, 16)));
+  }
+  alignas(16) int lanes[4];
+  _mm_store_si128(reinterpret_cast<__m128i*>(lanes), max_delta);
+  for (int lane : lanes) stats.max_delta = std::max(stats.max_delta, lane);
+  DiffRowScalar(a + i, b + i, out + i, n - i, threshold, gain, stats);
+}
+
+__attribute__((target("avx2"))) void DiffRowAvx2(const quint32* a,
+                                                 const quint32* b,
+                                                 quint32* out, int n,
+                                                 int threshold, int gain,
+                                                 RowStats& stats) {
+  const __m256i rgb = _mm256_set1_epi32(0x00ffffff);
+  const __m256i low_byte = _mm256_set1_epi32(0xff);
+  const __m256i limit = _mm256_set1_epi32(threshold);
+  const __m256i factor = _mm256_set1_epi32(gain);
+  __m256i max_delta = _mm256_setzero_si256();
+  int i = 0;
+  for (; i + 8 <= n; i += 8) {
+    const __m256i va =
+        _mm256_loadu_si256(reinterpret_cast<const __m256i*>(a + i));
+    const __m256i vb =
+        _mm256_loadu_si256(reinterpret_cast<const __m256i*>(b + i));
+    __m256i delta = _mm256_and_si256(
+        _mm256_or_si256(_mm256_subs_epu8(va, vb), _mm256_subs_epu8(vb, va)),
+        rgb);
+    delta = _mm256_max_epu8(delta, _mm256_srli_epi32(delta, 8));
+    delta = _mm256_max_epu8(delta, _mm256_srli_epi32(delta, 16));
+    delta = _mm256_and_si256(delta, low_byte);
+    max_delta = _mm256_max_epi16(max_delta, delta);
+    stats.changed += __builtin_popcount(_mm256_movemask_ps(
+        _mm256_castsi256_ps(_mm256_cmpgt_epi32(delta, limit))));
+    const __m256i heat =
+        _mm256_min_epi16(_mm256_mullo_epi16(delta, factor), low_byte);
+    _mm256_storeu_si256(reinterpret_cast<__m256i*>(out + i),
+                        _mm256_or_si256(_mm256_slli_epi32(heat, 24),
+                                        _mm256_slli_epi32(heat, 16)));
+  }
+  alignas(32) int lanes[8];
+  _mm256_store_si256(reinterpret_cast<__m256i*>(lanes), max_delta);
+  for (int lane : lanes) stats.max_delta = std::max(stats.max_delta, lane);
+  DiffRowScalar(a + i, b + i, out + i, n - i, threshold, gain, stats);
+}
+
+#endif
+
+row_kernel_t RowKernel(SimdLevel level) {
+  switch (level) {
+#ifdef PVIEWER_X86_SIMD
+    case SimdLevel::Sse2:
+      return DiffRowSse2;
+    case SimdLevel::Avx2:
+      return DiffRowAvx2;
+#endif
+    default:
+      return DiffRowScalar;
+  }
+}
+
+QImage AsRgb32(QImage const& image) {
+  return image.format() == QImage::Format_RGB32 ||
+                 image.format() == QImage::Format_ARGB32
+             ? image
+             : image.convertToFormat(QImage::Format_ARGB32);
+}
+
+}  // namespace
+
+DiffStats PixelDiff(QImage const& a, QImage const& b, int threshold, int gain,
+                    QImage* heatmap, SimdLevel level) {
+  const QImage first = AsRgb32(a);
+  const QImage second = AsRgb32(b);
+  const int width = std::min(first.width(), second.width());
+  const int height = std::min(first.height(), second.height());
+  if (heatmap) {
+    *heatmap = QImage(std::max(width, 0), std::max(height, 0),
+                      QImage::Format_ARGB32_Premultiplied);
+  }
+  if (width <= 0 || height <= 0) return {};
+  threshold = std::clamp(threshold, 0, 255);
+  gain = std::clamp(gain, 1, 127);
+  if (!IsSupported(level)) level = SimdLevel::Scalar;
+  const row_kernel_t diff_row = RowKernel(level);
+
+  struct Band {
+    int first_row;
+    RowStats stats;
+  };
+  std::vector<Band> bands;
+  for (int row = 0; row < height; row += kBandRows) bands.push_back({row, {}});
+  // Resolved here: scanLine() on the workers could detach the heatmap.
+  uchar* const heat = heatmap ? heatmap->bits() : nullptr;
+  const qsizetype heat_stride = heatmap ? heatmap->bytesPerLine() : 0;
+  QtConcurrent::blockingMap(bands, [&](Band& band) {
+    // Without a heatmap the output of a row is thrown away.
+    std::vector<quint32> scratch(heat ? 0 : width);
+    const int end = std::min(band.first_row + kBandRows, height);
+    for (int row = band.first_row; row < end; ++row) {
+      quint32* out = heat ? reinterpret_cast<quint32*>(heat + row * heat_stride)
+                          : scratch.data();
+      diff_row(reinterpret_cast<const quint32*>(first.constScanLine(row)),
+               reinterpret_cast<const quint32*>(second.constScanLine(row)),
+               out, width, threshold, gain, band.stats);
+    }
+  });
+
+  DiffStats stats;
+  stats.pixels = qint64(width) * height;
+  for (Band const& band : bands) {
+    stats.changed += band.stats.changed;
+    stats.max_delta = std::max(stats.max_delta, band.stats.max_delta);
+  }
+  return stats;
+}
@@ -0,0 +1,182 @@
+#include "preview_cache.hpp"
+
+#include <QBuffer>
+#include <QCryptographicHash>
+#include <QDataStream>
+#include <QDir>
+#include <QDirIterator>
+#include <QElapsedTimer>
+#include <QFile>
+#include <QFileInfo>
+#include <QImageReader>
+#include <QSaveFile>
+#include <QStandardPaths>
+#include <QThread>
+#include <QtConcurrent>
+#include <atomic>
+
+#include "image_formats.hpp"
+#include "trace.hpp"
+
+namespace {
+
+constexpr quint32 kMagic = 0x50565057;  // "PVPW"
+constexpr quint32 kVersion = 1;
+constexpr int kJpegQuality = 85;
+constexpr int kPollIntervalMs = 10;
+
+// What an entry must match to stand for the file at `path`.
+struct Source {
+  qint64 size = -1;
+  qint64 modified = 0;  // ms since the epoch
+};
+
+Source SourceOf(QString const& path) {
+  const QFileInfo info(path);
+  if (!info.isFile()) return {};
+  return {info.size(), info.lastModified().toMSecsSinceEpoch()};
+}
+
+// Positions `stream` past the header of the entry in `file`, if that entry
+// still matches the file at `path`.
+bool ReadFreshHeader(QFile& file, QDataStream& stream, QString const& path) {
+  if (!file.open(QIODevice::ReadOnly)) return false;
+  stream.setDevice(&file);
+  stream.setVersion(QDataStream::Qt_5_12);
+  quint32 magic = 0, version = 0;
+  stream >> magic >> version;
+  if (magic != kMagic || version != kVersion) return false;
+  Source stored;
+  stream >> stored.size >> stored.modified;
+  const Source current = SourceOf(path);
+  return stream.status() == QDataStream::Ok && current.size == stored.size &&
+         current.modified == stored.modified;
+}
+
+}  // namespace
+
+PreviewCache::PreviewCache(QString directory)
+    : directory_(std::move(directory)) {}
+
+QString PreviewCache::DefaultDirectory() {
+  return QStandardPaths::writableLocation(
+             QStandardPaths::GenericCacheLocation) +
+         QStringLiteral("/pviewer/previews");
+}
+
+QString PreviewCache::EntryPath(QString const& path) const {
+  const QByteArray key = QCryptographicHash::hash(
+      QFileInfo(path).absoluteFilePath().toUtf8(), QCryptographicHash::Sha1);
+  return directory_ + QLatin1Char('/') + QString::fromLatin1(key.toHex());
+}
+
+bool PreviewCache::Contains(QString const& path) const {
+  QFile file(EntryPath(path));
+  QDataStream stream;
+  return ReadFreshHeader(file, stream, path);
+}
+
+std::optional<PreviewCache::Entry> PreviewCache::Find(QString const& path,
+                                                     QSize bound) const {
+  trace::Scope scope("preview cache lookup");
+  QFile file(EntryPath(path));
+  QDataStream stream;
+  if (!ReadFreshHeader(file, stream, path)) return std::nullopt;
+  Entry entry;
+  QByteArray encoded;
+  stream >> entry.image_size >> encoded;
+  if (stream.status() != QDataStream::Ok) return std::nullopt;
+  QBuffer buffer(&encoded);
+  QImageReader reader(&buffer);
+  const QSize size = reader.size();
+  if (bound.isValid() && size.isValid() &&
+      (size.width() > bound.width() || size.height() > bound.height()))
+    reader.setScaledSize(size.scaled(bound, Qt::KeepAspectRatio));
+  entry.preview = reader.read();
+  if (entry.preview.isNull()) return std::nullopt;
+  return entry;
+}
+
+bool PreviewCache::Store(QString const& path, QSize bound) const {
+  trace::Scope scope("preview cache store");
+  // Taken before the image is read, so that a change made meanwhile leaves
+  // the entry stale rather than wrong.
+  const Source source = SourceOf(path);
+  if (source.size < 0) return false;
+  QImageReader reader(path);
+  const QSize image_size = reader.size();
+  if (image_size.isValid() &&
+      (image_size.width() > bound.width() ||
+       image_size.height() > bound.height())) {
+    reader.setScaledSize(image_size.scaled(bound, Qt::KeepAspectRatio));
+  }
+  const QImage preview = reader.read();
+  if (preview.isNull()) return false;
+
+  QByteArray encoded;
+  QBuffer buffer(&encoded);
+  buffer.open(QIODevice::WriteOnly);
+  const bool alpha = preview.hasAlphaChannel();
+  if (!preview.save(&buffer, alpha ? "PNG" : "JPG", alpha ? -1 : kJpegQuality))
+    return false;
+
+  if (!QDir().mkpath(directory_)) return false;
+  QSaveFile file(EntryPath(path));
+  if (!file.open(QIODevice::WriteOnly)) return false;
+  QDataStream stream(&file);
+  stream.setVersion(QDataStream::Qt_5_12);
+  stream << kMagic << kVersion << source.size << source.modified
+         << (image_size.isValid() ? image_size : preview.size()) << encoded;
+  return stream.status() == QDataStream::Ok && file.commit();
+}
+
+PrefetchStats Prefetch(QStringList const& directories,
+                       PreviewCache const& cache,
+                       std::function<void(PrefetchStats const&)> progress,
+                       int interval_ms) {
+  QElapsedTimer clock;
+  clock.start();
+  QStringList images;
+  for (QString const& directory : directories) {
+    QDirIterator it(directory, SupportedImageNameFilters(), QDir::Files,
+                    QDirIterator::Subdirectories);
+    while (it.hasNext()) images << it.next();
+  }
+
+  std::atomic<int> done{0}, stored{0}, fresh{0}, failed{0};
+  std::atomic<qint64> bytes{0};
+  auto snapshot = [&] {
+    PrefetchStats stats;
+    stats.images = images.size();
+    stats.done = done.load();
+    stats.stored = stored.load();
+    stats.fresh = fresh.load();
+    stats.failed = failed.load();
+    stats.bytes = bytes.load();
+    stats.elapsed_ms = clock.elapsed();
+    return stats;
+  };
+  // QtConcurrent's global pool has one thread per core.
+  QFuture<void> future =
+      QtConcurrent::map(images, [&](QString const& path) {
+        if (cache.Contains(path)) {
+          ++fresh;
+        } else if (cache.Store(path)) {
+          ++stored;
+          bytes += QFileInfo(path).size();
+        } else {
+          ++failed;
+        }
+        ++done;
+      });
+  QElapsedTimer since_report;
+  since_report.start();
+  while (!future.isFinished()) {
+    QThread::msleep(kPollIntervalMs);
+    if (progress && since_report.elapsed() >= interval_ms) {
+      progress(snapshot());
+      since_report.restart();
+    }
+  }
+  return snapshot();
+}
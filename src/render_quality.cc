@@ -0,0 +1,17 @@
+#include "render_quality.hpp"
+
+RenderQuality::RenderQuality(QObject* parent) : QObject(parent) {
+  idle_.setSingleShot(true);
+  idle_.setInterval(kIdleMs);
+  idle_.callOnTimeout(this, [this] {
+    smooth_ = true;
+    emit changed(true);
+  });
+}
+
+void RenderQuality::Interact() {
+  idle_.start();
+  if (!smooth_) return;
+  smooth_ = false;
+  emit changed(false);
+}
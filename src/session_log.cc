@@ -0,0 +1,132 @@
+#include "session_log.hpp"
+
+#include <QFileInfo>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <initializer_list>
+
+namespace {
+
+using Type = SessionEvent::Type;
+using Kind = EntryEdit::Kind;
+
+const char* TypeName(Type type) {
+  switch (type) {
+    case Type::KeyPress:
+      return "key_press";
+    case Type::KeyRelease:
+      return "key_release";
+    case Type::Edit:
+      return "edit";
+    case Type::Activate:
+      return "activate";
+  }
+  return "";
+}
+
+const char* KindName(Kind kind) {
+  switch (kind) {
+    case Kind::Enable:
+      return "enable";
+    case Kind::Disable:
+      return "disable";
+    case Kind::Move:
+      return "move";
+    case Kind::Remove:
+      return "remove";
+    case Kind::Insert:
+      return "insert";
+  }
+  return "";
+}
+
+template <typename Enum, typename NameOf>
+std::optional<Enum> Parse(QString const& name, NameOf name_of,
+                          std::initializer_list<Enum> values) {
+  for (Enum value : values)
+    if (name == QLatin1String(name_of(value))) return value;
+  return std::nullopt;
+}
+
+}  // namespace
+
+QByteArray ToJsonLine(SessionEvent const& event) {
+  QJsonObject object{{"t", event.time_ms}, {"type", TypeName(event.type)}};
+  switch (event.type) {
+    case Type::KeyPress:
+    case Type::KeyRelease:
+      object["key"] = event.key;
+      if (event.modifiers != 0) object["modifiers"] = event.modifiers;
+      if (event.repeat) object["repeat"] = true;
+      break;
+    case Type::Edit:
+      object["kind"] = KindName(event.edit.kind);
+      object["name"] = QFileInfo(event.edit.path).fileName();
+      if (event.edit.to >= 0) object["to"] = event.edit.to;
+      break;
+    case Type::Activate:
+      object["name"] = QFileInfo(event.name).fileName();
+      break;
+  }
+  return QJsonDocument(object).toJson(QJsonDocument::Compact) + '\n';
+}
+
+std::optional<SessionEvent> FromJsonLine(QByteArray const& line) {
+  const QJsonObject object = QJsonDocument::fromJson(line).object();
+  const std::optional<Type> type =
+      Parse(object["type"].toString(), TypeName,
+            {Type::KeyPress, Type::KeyRelease, Type::Edit, Type::Activate});
+  if (!type) return std::nullopt;
+
+  SessionEvent event;
+  event.type = *type;
+  event.time_ms = object["t"].toVariant().toLongLong();
+  switch (event.type) {
+    case Type::KeyPress:
+    case Type::KeyRelease:
+      event.key = object["key"].toInt();
+      event.modifiers = object["modifiers"].toInt();
+      event.repeat = object["repeat"].toBool();
+      break;
+    case Type::Edit: {
+      const std::optional<Kind> kind =
+          Parse(object["kind"].toString(), KindName,
+                {Kind::Enable, Kind::Disable, Kind::Move, Kind::Remove,
+                 Kind::Insert});
+      if (!kind) return std::nullopt;
+      event.edit = EntryEdit{*kind, object["name"].toString(),
+                             object["to"].toInt(-1)};
+      break;
+    }
+    case Type::Activate:
+      event.name = object["name"].toString();
+      break;
+  }
+  return event;
+}
+
+QVector<SessionEvent> ReadSession(QString const& path, QString* error) {
+  QFile file(path);
+  if (!file.open(QIODevice::ReadOnly | QIODevice::Text)) {
+    if (error) *error = file.errorString();
+    return {};
+  }
+  QVector<SessionEvent> events;
+  while (!file.atEnd()) {
+    if (std::optional<SessionEvent> event = FromJsonLine(file.readLine()))
+      events.push_back(std::move(*event));
+  }
+  return events;
+}
+
+SessionRecorder::SessionRecorder(QString const& path) : file_(path) {
+  file_.open(QIODevice::WriteOnly | QIODevice::Truncate | QIODevice::Text);
+  clock_.start();
+}
+
+void SessionRecorder::Record(SessionEvent event) {
+  if (!file_.isOpen()) return;
+  event.time_ms = clock_.elapsed();
+  file_.write(ToJsonLine(event));
+  file_.flush();
+}
@@ -0,0 +1,98 @@
+#include "session_replay.hpp"
+
+#include <QtGlobal>
+#include <algorithm>
+#include <array>
+
+#include "main_window.hpp"
+
+#ifdef Q_OS_UNIX
+#include <sys/resource.h>
+#endif
+
+namespace {
+
+// Peak resident set size of the process in MiB, or -1 if unknown.
+double PeakResidentMib() {
+#ifdef Q_OS_UNIX
+  rusage usage{};
+  if (getrusage(RUSAGE_SELF, &usage) != 0) return -1;
+#ifdef Q_OS_MACOS
+  return usage.ru_maxrss / (1024.0 * 1024.0);  // bytes
+#else
+  return usage.ru_maxrss / 1024.0;  // KiB
+#endif
+#else
+  return -1;
+#endif
+}
+
+QString OneDecimal(double value) { return QString::number(value, 'f', 1); }
+
+}  // namespace
+
+SessionReplay::SessionReplay(QVector<SessionEvent> events, MainWindow* window,
+                             QObject* parent)
+    : QObject(parent), events_(std::move(events)), window_(window) {
+  timer_.setSingleShot(true);
+  connect(&timer_, &QTimer::timeout, this, [this] {
+    if (next_ == events_.size()) {
+      emit finished();
+      return;
+    }
+    window_->replayEvent(events_[next_++]);
+    ScheduleNext();
+  });
+  connect(window_, &MainWindow::stepMeasured, this,
+          [this](StepSample sample) { samples_.push_back(sample); });
+}
+
+void SessionReplay::Start() {
+  next_ = 0;
+  samples_.clear();
+  ScheduleNext();
+}
+
+void SessionReplay::ScheduleNext() {
+  if (next_ == events_.size()) {
+    timer_.start(kSettleMs);
+    return;
+  }
+  const qint64 previous = next_ == 0 ? 0 : events_[next_ - 1].time_ms;
+  timer_.start(
+      int(std::clamp<qint64>(events_[next_].time_ms - previous, 0, kMaxGapMs)));
+}
+
+QString SessionReplay::Report() const {
+  std::vector<double> latencies;
+  std::array<int, 3> resolved{};  // indexed by SlotResolve
+  double blocked_wait_ms = 0;
+  for (StepSample const& sample : samples_) {
+    latencies.push_back(sample.latency_ms);
+    if (!sample.resolve) continue;
+    ++resolved[int(*sample.resolve)];
+    if (*sample.resolve == SlotResolve::Blocked)
+      blocked_wait_ms += sample.wait_ms;
+  }
+  const int blocked = resolved[int(SlotResolve::Blocked)];
+
+  QString report;
+  report += QStringLiteral("replayed %1 events, %2 steps\n")
+                .arg(events_.size())
+                .arg(samples_.size());
+  report += QStringLiteral("key to paint ms: p50 %1  p90 %2  p99 %3  max %4\n")
+                .arg(OneDecimal(Percentile(latencies, 0.50)),
+                     OneDecimal(Percentile(latencies, 0.90)),
+                     OneDecimal(Percentile(latencies, 0.99)),
+                     OneDecimal(Percentile(latencies, 1.0)));
+  report += QStringLiteral(
+                "images: ready %1  converted %2  blocked on decode %3 "
+                "(mean wait %4 ms)\n")
+                .arg(resolved[int(SlotResolve::Ready)])
+                .arg(resolved[int(SlotResolve::Converted)])
+                .arg(blocked)
+                .arg(OneDecimal(blocked ? blocked_wait_ms / blocked : 0));
+  report += QStringLiteral("peak memory: %1 MiB\n")
+                .arg(OneDecimal(PeakResidentMib()));
+  return report;
+}
@@ -0,0 +1,76 @@
+#include "single_instance.hpp"
+
+#include <QDataStream>
+#include <QLocalServer>
+#include <QLocalSocket>
+
+namespace {
+
+// Sent back once the arguments have been read, so that the sender only exits
+// when they are in good hands.
+constexpr char kAcknowledged = '\1';
+
+}  // namespace
+
+SingleInstance::SingleInstance(QObject* parent)
+    : QObject(parent), server_(new QLocalServer(this)) {
+  server_->setSocketOptions(QLocalServer::UserAccessOption);
+  connect(server_, &QLocalServer::newConnection, this,
+          &SingleInstance::Accept);
+}
+
+QString SingleInstance::DefaultName() {
+  QString user = qEnvironmentVariable("USER");
+  if (user.isEmpty()) user = qEnvironmentVariable("USERNAME");
+  return QStringLiteral("pviewer-") + user;
+}
+
+bool SingleInstance::Forward(QString const& name, QStringList const& arguments,
+                             int timeout_ms) {
+  QLocalSocket socket;
+  socket.connectToServer(name);
+  if (!socket.waitForConnected(timeout_ms)) return false;
+  QDataStream stream(&socket);
+  stream.setVersion(QDataStream::Qt_5_12);
+  stream << arguments;
+  if (!socket.waitForBytesWritten(timeout_ms)) return false;
+  char reply = 0;
+  return socket.waitForReadyRead(timeout_ms) && socket.getChar(&reply) &&
+         reply == kAcknowledged;
+}
+
+bool SingleInstance::Listen(QString const& name) {
+  if (server_->listen(name)) return true;
+  if (server_->serverError() != QAbstractSocket::AddressInUseError)
+    return false;
+  // Taken over only when nobody is behind it any more: a viewer that is
+  // merely slow to answer keeps its socket.
+  QLocalSocket probe;
+  probe.connectToServer(name);
+  if (probe.waitForConnected(kForwardTimeoutMs)) return false;
+  if (probe.error() != QLocalSocket::ServerNotFoundError &&
+      probe.error() != QLocalSocket::ConnectionRefusedError)
+    return false;
+  QLocalServer::removeServer(name);
+  return server_->listen(name);
+}
+
+void SingleInstance::Accept() {
+  while (QLocalSocket* socket = server_->nextPendingConnection()) {
+    connect(socket, &QLocalSocket::disconnected, socket,
+            &QObject::deleteLater);
+    // The arguments may arrive in pieces; the transaction rolls the socket
+    // back until the whole list is there.
+    connect(socket, &QLocalSocket::readyRead, this, [this, socket] {
+      QDataStream stream(socket);
+      stream.setVersion(QDataStream::Qt_5_12);
+      QStringList arguments;
+      stream.startTransaction();
+      stream >> arguments;
+      if (!stream.commitTransaction()) return;
+      socket->putChar(kAcknowledged);
+      socket->flush();
+      emit argumentsReceived(arguments);
+    });
+  }
+}
@@ -0,0 +1,111 @@
+#include "split_view.hpp"
+
+#include <QPainter>
+#include <algorithm>
+
+#include "trace.hpp"
+
+namespace {
+
+constexpr int kDividerWidth = 2;
+constexpr int kMargin = 6;
+
+// One axis of VisibleSource(): where the visible part starts in the image,
+// how long it is, and where it starts in the pane.
+void VisibleSpan(double image, double pane, double scale, double fraction,
+                 double* source_start, double* source_length,
+                 double* target_start) {
+  const double scaled = image * scale;
+  if (scaled <= pane) {
+    *source_start = 0;
+    *source_length = image;
+    *target_start = (pane - scaled) / 2;
+    return;
+  }
+  const double half = pane / 2 / scale;
+  const double center = std::clamp(fraction * image, half, image - half);
+  *source_start = center - half;
+  *source_length = 2 * half;
+  *target_start = 0;
+}
+
+}  // namespace
+
+SplitView::SplitView(QWidget* parent) : QWidget(parent) {
+  // Keys, clicks and the wheel belong to the main view.
+  setAttribute(Qt::WA_TransparentForMouseEvents);
+  setAttribute(Qt::WA_OpaquePaintEvent);
+  setFocusPolicy(Qt::NoFocus);
+}
+
+void SplitView::SetPanes(QVector<Pane> panes) {
+  panes_ = std::move(panes);
+  update();
+}
+
+void SplitView::SetView(double zoom_factor, QPointF center) {
+  if (zoom_factor == zoom_factor_ && center == center_) return;
+  zoom_factor_ = zoom_factor;
+  center_ = center;
+  update();
+}
+
+void SplitView::SetSmooth(bool smooth) {
+  if (smooth == smooth_) return;
+  smooth_ = smooth;
+  update();
+}
+
+QRectF SplitView::VisibleSource(QSizeF image, QSizeF pane, double scale,
+                                QPointF center, QRectF* target) {
+  double x, width, target_x, y, height, target_y;
+  VisibleSpan(image.width(), pane.width(), scale, center.x(), &x, &width,
+              &target_x);
+  VisibleSpan(image.height(), pane.height(), scale, center.y(), &y, &height,
+              &target_y);
+  if (target)
+    *target = QRectF(target_x, target_y, width * scale, height * scale);
+  return QRectF(x, y, width, height);
+}
+
+void SplitView::paintEvent(QPaintEvent*) {
+  trace::Scope scope("paint split view");
+  QPainter painter(this);
+  painter.fillRect(rect(), QColor(32, 32, 32));
+  if (panes_.isEmpty()) return;
+  painter.setRenderHint(QPainter::SmoothPixmapTransform, smooth_);
+  const int pane_width = width() / panes_.size();
+  for (int i = 0; i < panes_.size(); ++i) {
+    Pane const& pane = panes_.at(i);
+    const QRect divider(i * pane_width, 0, kDividerWidth, height());
+    painter.fillRect(divider, QColor(90, 90, 90));
+    const QRect area(divider.right() + 1, 0, pane_width - kDividerWidth,
+                     height());
+    if (pane.name.isEmpty() || area.isEmpty()) continue;
+
+    if (!pane.pixmap.isNull()) {
+      const QSizeF image = pane.pixmap.size();
+      const double fit = std::min(area.width() / image.width(),
+                                  area.height() / image.height());
+      QRectF target;
+      const QRectF source = VisibleSource(image, area.size(),
+                                          fit * zoom_factor_, center_,
+                                          &target);
+      painter.setClipRect(area);
+      painter.drawPixmap(target.translated(area.topLeft()), pane.pixmap,
+                         source);
+      painter.setClipping(false);
+    }
+
+    const QString label =
+        pane.pixmap.isNull() ? pane.name + QStringLiteral(" (decoding)")
+                             : pane.name;
+    QRect text = painter.fontMetrics().boundingRect(label);
+    text.moveTopLeft(area.topLeft() + QPoint(kMargin, kMargin));
+    painter.fillRect(text.adjusted(-kMargin / 2, -kMargin / 2, kMargin / 2,
+                                   kMargin / 2),
+                     QColor(0, 0, 0, 170));
+    painter.setPen(QColor(230, 230, 230));
+    painter.drawText(text, Qt::AlignLeft | Qt::AlignVCenter, label);
+  }
+}
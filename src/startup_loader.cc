@@ -0,0 +1,75 @@
+#include "startup_loader.hpp"
+
+#include <QDir>
+#include <QFutureWatcher>
+#include <QImageReader>
+#include <QtConcurrent>
+#include <algorithm>
+
+#include "image_formats.hpp"
+#include "trace.hpp"
+
+StartupLoader::StartupLoader(QSize target, PreviewCache cache,
+                             QObject* parent)
+    : QObject(parent), target_(target), cache_(std::move(cache)) {
+  clock_.start();
+  pool_.setMaxThreadCount(1);
+}
+
+void StartupLoader::LoadDirectory(QString path, int position) {
+  Start(
+      [path] {
+        trace::Scope scope("list directory");
+        return ImagesInDirectory(QDir(path));
+      },
+      position);
+}
+
+void StartupLoader::LoadImages(QList<QString> images, int position) {
+  Start([images] { return images; }, position);
+}
+
+QImage StartupLoader::Preview(QString const& path, QSize target,
+                              QSize* image_size) {
+  trace::Scope scope("preview decode");
+  QImageReader reader(path);
+  const QSize size = reader.size();
+  if (image_size) *image_size = size;
+  if (size.isValid() && target.isValid() &&
+      (size.width() > target.width() || size.height() > target.height())) {
+    reader.setScaledSize(size.scaled(target, Qt::KeepAspectRatio));
+  }
+  QImage preview = reader.read();
+  if (image_size && !size.isValid()) *image_size = preview.size();
+  return preview;
+}
+
+void StartupLoader::Start(std::function<QList<QString>()> list, int position) {
+  auto* watcher = new QFutureWatcher<Result>(this);
+  connect(watcher, &QFutureWatcher<Result>::finished, this, [this, watcher] {
+    watcher->deleteLater();
+    emit loaded(watcher->result());
+  });
+  watcher->setFuture(
+      QtConcurrent::run(&pool_, [list, position, this] {
+        Result result;
+        result.images = list();
+        if (result.images.isEmpty()) return result;
+        result.position = std::clamp(position, 1, int(result.images.size()));
+        QString const& start = result.images.at(result.position - 1);
+        // A target beyond the cached previews' bound, as on a HiDPI screen,
+        // would show a blurry preview: decode the image itself instead.
+        const bool cacheable =
+            target_.width() <= PreviewCache::kBound.width() &&
+            target_.height() <= PreviewCache::kBound.height();
+        std::optional<PreviewCache::Entry> cached;
+        if (cacheable) cached = cache_.Find(start, target_);
+        if (cached) {
+          result.preview = std::move(cached->preview);
+          result.image_size = cached->image_size;
+        } else {
+          result.preview = Preview(start, target_, &result.image_size);
+        }
+        return result;
+      }));
+}
@@ -0,0 +1,33 @@
+#include "toast.hpp"
+
+namespace {
+
+constexpr int kMargin = 24;
+
+}  // namespace
+
+Toast::Toast(QWidget* parent) : QLabel(parent) {
+  setAttribute(Qt::WA_TransparentForMouseEvents);
+  setAlignment(Qt::AlignCenter);
+  setStyleSheet(QStringLiteral(
+      "background: rgba(0, 0, 0, 190); color: rgb(240, 240, 240);"
+      "padding: 10px 18px; border-radius: 8px; font-size: 16pt;"));
+  expiry_.setSingleShot(true);
+  expiry_.callOnTimeout(this, &QWidget::hide);
+  if (parent) area_ = parent->rect();
+  hide();
+}
+
+void Toast::Show(QString const& text, int duration_ms) {
+  setText(text);
+  adjustSize();
+  Place(area_);
+  raise();
+  show();
+  expiry_.start(duration_ms);
+}
+
+void Toast::Place(QRect const& area) {
+  area_ = area;
+  move(area.center().x() - width() / 2, area.top() + kMargin);
+}
@@ -0,0 +1,237 @@
+#include "trace.hpp"
+
+#include <QCoreApplication>
+#include <QFile>
+#include <algorithm>
+#include <array>
+#include <cstdio>
+#include <memory>
+#include <mutex>
+#include <string_view>
+#include <vector>
+
+namespace trace {
+
+namespace detail {
+
+std::atomic<bool> enabled{false};
+
+}  // namespace detail
+
+namespace {
+
+struct Event {
+  const char* name;
+  const char* arg_name;
+  std::int64_t start;
+  std::int64_t duration;
+  std::int64_t arg;
+};
+
+// One event of a ring, guarded by a sequence lock: `seq` is the event's
+// number plus one once it is written, and 0 while it is being written. The
+// fields are relaxed atomics so that a concurrent copy is no data race.
+struct Slot {
+  std::atomic<std::uint64_t> seq{0};
+  std::atomic<const char*> name{nullptr};
+  std::atomic<const char*> arg_name{nullptr};
+  std::atomic<std::int64_t> start{0};
+  std::atomic<std::int64_t> duration{0};
+  std::atomic<std::int64_t> arg{0};
+};
+
+// Written only by its own thread. The exporter copies it without stopping the
+// writer and keeps only the slots whose sequence says they were committed
+// and not overwritten during the copy.
+struct Ring {
+  std::array<Slot, kEventsPerThread> events;
+  std::atomic<std::uint64_t> head{0};  // total events ever recorded
+  std::atomic<std::uint64_t> tail{0};  // events before it were cleared
+  int tid = 0;
+  std::string name;    // guarded by Registry::mutex
+  bool ended = false;  // its thread is gone; guarded by Registry::mutex
+};
+
+// Rings of ended threads kept for export; older ones are dropped first.
+constexpr std::size_t kEndedRings = 32;
+
+struct Registry {
+  std::mutex mutex;
+  // The ring of a thread that ended stays until Clear(), so short-lived
+  // workers still get exported, unless it holds no events.
+  std::vector<std::shared_ptr<Ring>> rings;
+  std::atomic<std::int64_t> origin{0};  // exported timestamps start here
+};
+
+// Never destroyed: threads that are still running at exit may record.
+Registry& GetRegistry() {
+  static Registry* registry = new Registry;
+  return *registry;
+}
+
+// Registers the calling thread's ring on first use and retires it when the
+// thread ends.
+class LocalRingOwner {
+ public:
+  LocalRingOwner() : ring_(std::make_shared<Ring>()) {
+    Registry& registry = GetRegistry();
+    std::lock_guard<std::mutex> lock(registry.mutex);
+    ring_->tid = next_tid_++;
+    registry.rings.push_back(ring_);
+  }
+  ~LocalRingOwner() {
+    Registry& registry = GetRegistry();
+    std::lock_guard<std::mutex> lock(registry.mutex);
+    std::vector<std::shared_ptr<Ring>>& rings = registry.rings;
+    ring_->ended = true;
+    if (ring_->head.load() == ring_->tail.load()) {
+      rings.erase(std::find(rings.begin(), rings.end(), ring_));
+      return;
+    }
+    const auto is_ended = [](auto const& ring) { return ring->ended; };
+    if (std::size_t(std::count_if(rings.begin(), rings.end(), is_ended)) >
+        kEndedRings)
+      rings.erase(std::find_if(rings.begin(), rings.end(), is_ended));
+  }
+  Ring& ring() { return *ring_; }
+
+ private:
+  static inline int next_tid_ = 1;  // guarded by Registry::mutex
+  const std::shared_ptr<Ring> ring_;
+};
+
+Ring& LocalRing() {
+  thread_local LocalRingOwner owner;
+  return owner.ring();
+}
+
+std::vector<Event> Snapshot(Ring const& ring) {
+  const std::uint64_t head = ring.head.load(std::memory_order_acquire);
+  const std::uint64_t overwritten =
+      head > kEventsPerThread ? head - kEventsPerThread : 0;
+  const std::uint64_t begin = std::max(overwritten, ring.tail.load());
+  std::vector<Event> events;
+  events.reserve(head - std::min(begin, head));
+  for (std::uint64_t i = begin; i < head; ++i) {
+    Slot const& slot = ring.events[i % kEventsPerThread];
+    if (slot.seq.load(std::memory_order_acquire) != i + 1) continue;
+    const Event event{slot.name.load(std::memory_order_relaxed),
+                      slot.arg_name.load(std::memory_order_relaxed),
+                      slot.start.load(std::memory_order_relaxed),
+                      slot.duration.load(std::memory_order_relaxed),
+                      slot.arg.load(std::memory_order_relaxed)};
+    std::atomic_thread_fence(std::memory_order_acquire);
+    // The owner wrapped over the slot while it was being copied.
+    if (slot.seq.load(std::memory_order_relaxed) != i + 1) continue;
+    events.push_back(event);
+  }
+  return events;
+}
+
+std::string Quoted(std::string_view text) {
+  std::string result = "\"";
+  for (char c : text) {
+    if (c == '"' || c == '\\') result += '\\';
+    result += c;
+  }
+  return result + '"';
+}
+
+std::string Microseconds(std::int64_t nanoseconds) {
+  char buffer[32];
+  std::snprintf(buffer, sizeof buffer, "%.3f", nanoseconds / 1000.0);
+  return buffer;
+}
+
+}  // namespace
+
+namespace detail {
+
+void Record(const char* name, std::int64_t start, std::int64_t duration,
+            const char* arg_name, std::int64_t arg) {
+  Ring& ring = LocalRing();
+  const std::uint64_t head = ring.head.load(std::memory_order_relaxed);
+  Slot& slot = ring.events[head % kEventsPerThread];
+  slot.seq.store(0, std::memory_order_relaxed);
+  std::atomic_thread_fence(std::memory_order_release);
+  slot.name.store(name, std::memory_order_relaxed);
+  slot.arg_name.store(arg_name, std::memory_order_relaxed);
+  slot.start.store(start, std::memory_order_relaxed);
+  slot.duration.store(duration, std::memory_order_relaxed);
+  slot.arg.store(arg, std::memory_order_relaxed);
+  slot.seq.store(head + 1, std::memory_order_release);
+  ring.head.store(head + 1, std::memory_order_release);
+}
+
+}  // namespace detail
+
+void Start() {
+  std::int64_t unset = 0;
+  GetRegistry().origin.compare_exchange_strong(unset, detail::Now());
+  detail::enabled.store(true);
+}
+
+void Stop() { detail::enabled.store(false); }
+
+void Clear() {
+  Registry& registry = GetRegistry();
+  std::lock_guard<std::mutex> lock(registry.mutex);
+  std::vector<std::shared_ptr<Ring>>& rings = registry.rings;
+  rings.erase(std::remove_if(rings.begin(), rings.end(),
+                             [](auto const& ring) { return ring->ended; }),
+              rings.end());
+  for (auto const& ring : rings) ring->tail.store(ring->head.load());
+}
+
+void NameThread(const char* name) {
+  // A thread that never records needs no ring, nor its name.
+  if (!Enabled()) return;
+  Ring& ring = LocalRing();
+  std::lock_guard<std::mutex> lock(GetRegistry().mutex);
+  ring.name = name;
+}
+
+std::string ChromeJson() {
+  Registry& registry = GetRegistry();
+  std::lock_guard<std::mutex> lock(registry.mutex);
+  const std::int64_t origin = registry.origin.load();
+  const std::string pid = std::to_string(QCoreApplication::applicationPid());
+  std::string json = "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[";
+  bool first = true;
+  auto append = [&](std::string const& event) {
+    json += first ? "\n" : ",\n";
+    json += event;
+    first = false;
+  };
+  for (auto const& ring : registry.rings) {
+    const std::string thread =
+        ",\"pid\":" + pid + ",\"tid\":" + std::to_string(ring->tid);
+    if (!ring->name.empty()) {
+      append("{\"name\":\"thread_name\",\"ph\":\"M\"" + thread +
+             ",\"args\":{\"name\":" + Quoted(ring->name) + "}}");
+    }
+    for (Event const& event : Snapshot(*ring)) {
+      std::string entry = "{\"name\":" + Quoted(event.name) + thread +
+                          ",\"ts\":" + Microseconds(event.start - origin);
+      if (event.duration < 0)
+        entry += ",\"ph\":\"i\",\"s\":\"t\"";
+      else
+        entry += ",\"ph\":\"X\",\"dur\":" + Microseconds(event.duration);
+      if (event.arg_name) {
+        entry += ",\"args\":{" + Quoted(event.arg_name) + ':' +
+                 std::to_string(event.arg) + '}';
+      }
+      append(entry + '}');
+    }
+  }
+  return json + "\n]}\n";
+}
+
+bool WriteChromeJson(QString const& path) {
+  const std::string json = ChromeJson();
+  QFile file(path);
+  if (!file.open(QIODevice::WriteOnly | QIODevice::Truncate)) return false;
+  return file.write(json.data(), json.size()) == qint64(json.size());
+}
+
+}  // namespace trace
@@ -0,0 +1,56 @@
+#include "arrow_keys_scroller.hpp"
+
+#include <gtest/gtest.h>
+
+#include <QCoreApplication>
+#include <QElapsedTimer>
+
+namespace {
+
+void Send(ArrowKeysScroller& scroller, QEvent::Type type, Qt::Key key) {
+  QKeyEvent event(type, key, Qt::NoModifier);
+  scroller.setKeyState(&event);
+}
+
+}  // namespace
+
+TEST(ArrowKeysScrollerTest, SpeedRampsAlongTheCurve) {
+  ArrowKeysScroller::Profile profile;
+  profile.initial_speed = 100;
+  profile.max_speed = 500;
+  profile.ramp_ms = 1000;
+
+  profile.curve = ArrowKeysScroller::Curve::EaseIn;
+  EXPECT_DOUBLE_EQ(ArrowKeysScroller::Speed(profile, 0), 100);
+  EXPECT_DOUBLE_EQ(ArrowKeysScroller::Speed(profile, 500), 200);
+  EXPECT_DOUBLE_EQ(ArrowKeysScroller::Speed(profile, 5000), 500);
+  profile.curve = ArrowKeysScroller::Curve::Linear;
+  EXPECT_DOUBLE_EQ(ArrowKeysScroller::Speed(profile, 500), 300);
+  profile.curve = ArrowKeysScroller::Curve::Constant;
+  EXPECT_DOUBLE_EQ(ArrowKeysScroller::Speed(profile, 5000), 100);
+}
+
+TEST(ArrowKeysScrollerTest, ScrollsOnlyWhileAKeyIsHeld) {
+  QScrollBar horizontal(Qt::Horizontal);
+  QScrollBar vertical(Qt::Vertical);
+  horizontal.setRange(0, 10000);
+  vertical.setRange(0, 10000);
+  ArrowKeysScroller scroller(&horizontal, &vertical);
+  EXPECT_FALSE(scroller.isScrolling());
+
+  Send(scroller, QEvent::KeyPress, Qt::Key_Down);
+  Send(scroller, QEvent::KeyPress, Qt::Key_Down);  // auto-repeat
+  ASSERT_TRUE(scroller.isScrolling());
+  QElapsedTimer clock;
+  clock.start();
+  while (vertical.value() == 0 && clock.elapsed() < 2000)
+    QCoreApplication::processEvents(QEventLoop::WaitForMoreEvents, 50);
+  EXPECT_GT(vertical.value(), 0);
+  EXPECT_EQ(horizontal.value(), 0);
+
+  Send(scroller, QEvent::KeyRelease, Qt::Key_Down);
+  EXPECT_FALSE(scroller.isScrolling());
+  const int stopped_at = vertical.value();
+  QCoreApplication::processEvents(QEventLoop::AllEvents, 50);
+  EXPECT_EQ(vertical.value(), stopped_at);
+}
@@ -0,0 +1,68 @@
+#include "blink_comparison.hpp"
+
+#include <gtest/gtest.h>
+
+#include <QCoreApplication>
+#include <QElapsedTimer>
+#include <QGraphicsScene>
+
+namespace {
+
+QPixmap Filled(QSize size, QColor color) {
+  QPixmap pixmap(size);
+  pixmap.fill(color);
+  return pixmap;
+}
+
+struct BlinkComparisonFixture : public ::testing::Test {
+  BlinkComparisonFixture() {
+    base->setPixmap(Filled({400, 300}, Qt::red));
+    scene.addItem(base);
+    scene.setSceneRect(base->boundingRect());
+  }
+  QGraphicsScene scene;
+  QGraphicsPixmapItem* base = new QGraphicsPixmapItem();
+  BlinkComparison blink{base};
+};
+
+}  // namespace
+
+TEST_F(BlinkComparisonFixture, PartnerCoversTheDisplayedImage) {
+  blink.Pin(Filled({200, 150}, Qt::green));
+  blink.ShowPartner(true);
+
+  ASSERT_TRUE(blink.IsPartnerShown());
+  const QList<QGraphicsItem*> children = base->childItems();
+  ASSERT_EQ(children.size(), 1);
+  EXPECT_EQ(children.first()->sceneBoundingRect(), base->sceneBoundingRect());
+  EXPECT_EQ(scene.sceneRect(), QRectF(0, 0, 400, 300));
+}
+
+TEST_F(BlinkComparisonFixture, AlternatesOnTheTimerUntilStopped) {
+  blink.Start();
+  EXPECT_FALSE(blink.IsRunning());  // nothing pinned yet
+
+  blink.Pin(Filled({400, 300}, Qt::green));
+  blink.Start();
+  ASSERT_TRUE(blink.IsRunning());
+  EXPECT_TRUE(blink.IsPartnerShown());
+  QElapsedTimer clock;
+  clock.start();
+  while (blink.IsPartnerShown() && clock.elapsed() < 2000)
+    QCoreApplication::processEvents(QEventLoop::WaitForMoreEvents, 50);
+  EXPECT_FALSE(blink.IsPartnerShown());
+  EXPECT_GE(clock.elapsed(), BlinkComparison::kIntervalMs / 2);
+
+  blink.Stop();
+  EXPECT_FALSE(blink.IsRunning());
+  EXPECT_FALSE(blink.IsPartnerShown());
+}
+
+TEST_F(BlinkComparisonFixture, StopsWhenTheDisplayedImageGoes) {
+  blink.Pin(Filled({400, 300}, Qt::green));
+  blink.Start();
+  base->setPixmap(QPixmap());
+  blink.BaseChanged();
+  EXPECT_FALSE(blink.IsRunning());
+  EXPECT_FALSE(blink.IsPartnerShown());
+}
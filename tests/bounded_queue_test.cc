@@ -0,0 +1,56 @@
+#include "bounded_queue.hpp"
+
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <atomic>
+#include <thread>
+#include <vector>
+
+TEST(BoundedQueueTest, KeepsFifoOrderAndReportsFullAndEmpty) {
+  BoundedQueue<int> queue(3);  // rounded up to 4
+  ASSERT_EQ(queue.Capacity(), 4u);
+  EXPECT_FALSE(queue.TryPop().has_value());
+
+  for (int i = 0; i < 4; ++i) EXPECT_TRUE(queue.TryPush(i));
+  EXPECT_FALSE(queue.TryPush(4));
+
+  for (int i = 0; i < 4; ++i) EXPECT_EQ(queue.TryPop(), i);
+  EXPECT_FALSE(queue.TryPop().has_value());
+}
+
+// Several producers and consumers race on a small ring; every value must come
+// out exactly once.
+TEST(BoundedQueueTest, ConcurrentProducersAndConsumersLoseNothing) {
+  constexpr int kProducers = 4;
+  constexpr int kConsumers = 4;
+  constexpr int kPerProducer = 20000;
+  BoundedQueue<int> queue(64);
+  std::vector<std::atomic<int>> seen(kProducers * kPerProducer);
+  std::atomic<int> consumed{0};
+
+  std::vector<std::thread> threads;
+  for (int p = 0; p < kProducers; ++p) {
+    threads.emplace_back([&, p] {
+      for (int i = 0; i < kPerProducer; ++i) {
+        while (!queue.TryPush(p * kPerProducer + i)) std::this_thread::yield();
+      }
+    });
+  }
+  for (int c = 0; c < kConsumers; ++c) {
+    threads.emplace_back([&] {
+      while (consumed.load() < kProducers * kPerProducer) {
+        if (auto value = queue.TryPop()) {
+          seen[*value].fetch_add(1);
+          consumed.fetch_add(1);
+        } else {
+          std::this_thread::yield();
+        }
+      }
+    });
+  }
+  for (std::thread& thread : threads) thread.join();
+
+  EXPECT_TRUE(std::all_of(seen.begin(), seen.end(),
+                          [](std::atomic<int> const& n) { return n == 1; }));
+}
@@ -43,7 +43,7 @@ using info_test_t = Info;
 using info_storage_test_t = QVector<info_test_t>;
 using image_storage_test_t = QList<image_test_t>;
 
-using info_t = info_storage_test_t::iterator;
+using info_t = ListHandle<info_storage_test_t>;
 using queue_storage_t = QList<info_t>;
 
 class FakeTaskQueue : public Abstract::TaskQueue<info_test_t, image_test_t> {
@@ -71,28 +71,34 @@ class FakeImagePathList
   using smart_pointer_t = std::shared_ptr<FakeImagePathList>;
 
  public:
-  FakeImagePathList(info_storage_test_t vec, info_t pos)
-      : ImageLocation(pos), file_info_(std::move(vec)) {}
+  FakeImagePathList(info_storage_test_t vec, int pos)
+      : ImageLocation(info_t(&file_info_, pos)), file_info_(std::move(vec)) {}
   static smart_pointer_t Construct(int size, elem_pos_t pos = elem_pos_t(-1)) {
     return Construct(0, size, pos);
   }
   static smart_pointer_t Construct(int begin, int end,
                                    elem_pos_t pos = elem_pos_t(-1)) {
     info_storage_test_t result;
-    info_t iter;
     for (int i = begin; i != end; ++i) result.push_back(i);
-    if (pos.value == -1)
-      iter = result.begin();
-    else
-      iter = std::find(result.begin(), result.end(), pos.value);
-    return std::make_shared<FakeImagePathList>(std::move(result), iter);
+    const int index =
+        pos.value == -1
+            ? 0
+            : std::distance(result.begin(),
+                            std::find(result.begin(), result.end(), pos.value));
+    return std::make_shared<FakeImagePathList>(std::move(result), index);
   }
   int size() const override { return file_info_.size(); }
   bool isEmpty() const override { return file_info_.empty(); }
   int Image() { return file_info_.at(Pos()).value_; }
-  info_t Begin() override { return file_info_.begin(); }
-  info_t End() override { return file_info_.end(); }
-  const_info_t CBegin() const override { return file_info_.begin(); }
+  info_t Begin() override { return info_t(&file_info_, 0); }
+  info_t End() override { return info_t(&file_info_, file_info_.size()); }
+  const_info_t CBegin() const override { return const_info_t(&file_info_, 0); }
+  info_test_t TakeAt(int position) override {
+    return file_info_.takeAt(position);
+  }
+  void InsertAt(int position, info_test_t value) override {
+    file_info_.insert(position, value);
+  }
 
   info_storage_test_t file_info_;
 };
@@ -120,6 +126,11 @@ class FakeCachedImageList
   void PopBack() override { cache_.pop_back(); }
   std::size_t Size() const override { return cache_.size(); }
   void Push(pointer_t op, info_t value) override { (cache_.*op)(Decode(*value)); }
+  void RemoveSlot(int slot) override { cache_.removeAt(slot); }
+  void InsertSlot(int slot, info_t value) override {
+    cache_.insert(slot, Decode(*value));
+  }
+  void MoveSlot(int from, int to) override { cache_.move(from, to); }
 
  public:
   QList<image_test_t> cache_;
@@ -139,3 +139,122 @@ TEST(CacheInvariants, SingleImageList) {
   s.move->moveTo<PreviousImage>();
   CheckInvariants(s, "N=1 after prev");
 }
+
+// In-place list edits (panel toggles, reorders, deletions) must leave the
+// window satisfying the same contract as navigation does, keep every cached
+// slot in sync with the image it stands for, and keep the cursor on the image
+// it was on (or on its successor when that very image is removed).
+TEST(CacheInvariants, RandomEditsKeepWindowInPlace) {
+  using RemoveImage = RemoveImageImpl<info_test_t, image_test_t>;
+  using InsertImage = InsertImageImpl<info_test_t, image_test_t>;
+  using MoveImage = MoveImageImpl<info_test_t, image_test_t>;
+  for (unsigned seed = 0; seed < 200; ++seed) {
+    std::mt19937 rng(seed);
+    const int n = std::uniform_int_distribution<int>(2, 30)(rng);
+    const int cap = std::uniform_int_distribution<int>(3, 15)(rng);
+    System s = Build(n, cap);
+    s.move->moveTo<ImageNumber>(std::uniform_int_distribution<int>(1, n)(rng));
+    int next_value = n;
+
+    for (int step = 0; step < 40 && s.images->size() > 1; ++step) {
+      const int size = s.images->size();
+      const int roll = std::uniform_int_distribution<int>(0, 5)(rng);
+      const int a = std::uniform_int_distribution<int>(0, size - 1)(rng);
+      const int b = std::uniform_int_distribution<int>(0, size - 1)(rng);
+      const int current_value = s.images->Image();
+      std::string action;
+      int expected_value = current_value;
+      if (roll < 2) {
+        if (a == s.images->Pos())
+          expected_value = s.images->file_info_.at(a + 1 < size ? a + 1 : a - 1)
+                               .value_;
+        s.move->moveTo<RemoveImage>(a);
+        action = "Remove" + std::to_string(a);
+      } else if (roll < 4) {
+        s.move->moveTo<InsertImage>(a, info_test_t(next_value++));
+        action = "Insert" + std::to_string(a);
+      } else if (roll == 4) {
+        s.move->moveTo<MoveImage>(a, b);
+        action = "Move" + std::to_string(a) + "->" + std::to_string(b);
+      } else {
+        s.move->moveTo<NextImage>();
+        s.move->moveTo<NextImage>();
+        action = "Next";
+        expected_value = s.images->Image();
+      }
+
+      const std::string ctx = "seed=" + std::to_string(seed) +
+                              " cap=" + std::to_string(cap) +
+                              " step=" + std::to_string(step) + " " + action;
+      CheckInvariants(s, ctx);
+      EXPECT_EQ(s.images->Image(), expected_value) << ctx;
+      const int left = std::distance(s.images->Begin(), s.cache->LeftEdge());
+      for (int i = 0; i < s.cache->cache_.size(); ++i) {
+        EXPECT_EQ(s.cache->cache_.at(i),
+                  Decode(s.images->file_info_.at(left + i)))
+            << ctx << " slot=" << i;
+      }
+    }
+  }
+}
+
+// Toggling an image outside the window must not touch any cached slot.
+TEST(CacheInvariants, EditOutsideWindowKeepsSlots) {
+  using RemoveImage = RemoveImageImpl<info_test_t, image_test_t>;
+  using InsertImage = InsertImageImpl<info_test_t, image_test_t>;
+  System s = Build(/*n=*/30, /*capacity=*/5);
+  s.move->moveTo<ImageNumber>(15);
+  const image_storage_test_t before = s.cache->cache_;
+
+  s.move->moveTo<RemoveImage>(2);
+  s.move->moveTo<InsertImage>(25, info_test_t(100));
+
+  EXPECT_EQ(s.cache->cache_, before);
+  EXPECT_EQ(s.images->Image(), 14);
+  CheckInvariants(s, "after edits outside the window");
+}
+
+// Stress: a directory scan streams paths in while the user keeps navigating.
+// Appends go through InsertImage (so a short list grows its window) and, for
+// the bulk of the scan, straight into the list -- which reallocates it many
+// times over. Neither may disturb the window: handles stay valid and every
+// slot still holds the image at its position.
+TEST(CacheInvariants, ListGrowsDuringNavigation) {
+  using InsertImage = InsertImageImpl<info_test_t, image_test_t>;
+  for (unsigned seed = 0; seed < 50; ++seed) {
+    std::mt19937 rng(seed);
+    const int cap = std::uniform_int_distribution<int>(3, 15)(rng);
+    System s = Build(/*n=*/2, cap);
+    s.move->moveTo<ImageNumber>(1);
+    int next_value = 2;
+
+    for (int step = 0; step < 200; ++step) {
+      const std::string ctx = "seed=" + std::to_string(seed) +
+                              " cap=" + std::to_string(cap) +
+                              " step=" + std::to_string(step);
+      const int roll = std::uniform_int_distribution<int>(0, 3)(rng);
+      if (roll == 0 && s.images->size() < 2 * cap) {
+        s.move->moveTo<InsertImage>(s.images->size(),
+                                    info_test_t(next_value++));
+      } else if (roll == 0) {
+        const int current = s.images->Image();
+        const image_storage_test_t cached = s.cache->cache_;
+        for (int i = 0; i < 64; ++i)
+          s.images->file_info_.push_back(next_value++);
+        EXPECT_EQ(s.images->Image(), current) << ctx;
+        EXPECT_EQ(s.cache->cache_, cached) << ctx;
+      } else {
+        roll == 1 ? s.move->moveTo<PreviousImage>()
+                  : s.move->moveTo<NextImage>();
+      }
+
+      CheckInvariants(s, ctx);
+      const int left = std::distance(s.images->Begin(), s.cache->LeftEdge());
+      for (int i = 0; i < s.cache->cache_.size(); ++i) {
+        EXPECT_EQ(s.cache->cache_.at(i),
+                  Decode(s.images->file_info_.at(left + i)))
+            << ctx << " slot=" << i;
+      }
+    }
+  }
+}
@@ -1,6 +1,9 @@
 #include <gtest/gtest.h>
 
 #include <QColor>
+#include <QCoreApplication>
+#include <QDateTime>
+#include <QElapsedTimer>
 #include <QFile>
 #include <QImage>
 #include <QPixmap>
@@ -30,9 +33,9 @@
  */
 class CachedImagesListTest : public ::testing::Test {
  protected:
-  using NextImage = ImageBase<NumericalOrder, QString, QPixmap>;
-  using PreviousImage = ImageBase<ReverseOrder, QString, QPixmap>;
-  using ImageNumber = ImageNumberImpl<QString, QPixmap>;
+  using NextImage = ImageBase<NumericalOrder, PathId, QPixmap>;
+  using PreviousImage = ImageBase<ReverseOrder, PathId, QPixmap>;
+  using ImageNumber = ImageNumberImpl<PathId, QPixmap>;
 
   static constexpr int kW = 200;
   static constexpr int kH = 150;
@@ -66,18 +69,33 @@ class CachedImagesListTest : public ::testing::Test {
     images_ = std::make_shared<ImagePath>();
     images_->CreateTaskQueue<TaskQueue>(capacity);
     cache_ = images_->CreateCacheObject<CachedImagesList>(
-        capacity, [this](QPixmap const& p) { displayed_ = p; });
+        capacity, [this](QPixmap const& p) {
+          displayed_ = p;
+          ++presents_;
+        });
     cache_->SetScrollCallbacks([] {}, [] {});
     folders_ = std::make_shared<FolderPath>();
-    move_ = std::make_unique<ImagesNavigator<QString, QPixmap>>(
+    move_ = std::make_unique<ImagesNavigator<PathId, QPixmap>>(
         images_, cache_, folders_, [this] { return displayed_.isNull(); });
     images_->setNewList(std::move(paths));
     move_->moveTo<ImageNumber>(start_pos_1_based);
+    WaitForFrame();
   }
 
   template <typename Where, typename... Args>
   Step Go(Args... args) {
-    return move_->moveTo<Where>(args...);
+    const Step step = move_->moveTo<Where>(args...);
+    WaitForFrame();
+    return step;
+  }
+
+  // Display is asynchronous: lets a requested frame be decoded and shown.
+  void WaitForFrame() {
+    QElapsedTimer clock;
+    clock.start();
+    while (cache_->HasPendingFrame() && clock.elapsed() < 5000)
+      QCoreApplication::processEvents(QEventLoop::WaitForMoreEvents, 10);
+    ASSERT_FALSE(cache_->HasPendingFrame());
   }
 
   int DisplayedIndex() const {
@@ -91,16 +109,18 @@ class CachedImagesListTest : public ::testing::Test {
 
   QTemporaryDir tmp_;
   QPixmap displayed_;
+  int presents_ = 0;
   std::shared_ptr<ImagePath> images_;
   std::shared_ptr<CachedImagesList> cache_;
   std::shared_ptr<FolderPath> folders_;
-  std::unique_ptr<ImagesNavigator<QString, QPixmap>> move_;
+  std::unique_ptr<ImagesNavigator<PathId, QPixmap>> move_;
 };
 
 // The decode future is resolved into a real, correctly-sized pixmap.
 TEST_F(CachedImagesListTest, DecodesAndDisplaysRealPixmap) {
   Build(MakeImages(10), /*capacity=*/5, /*start=*/1);  // index 0
   cache_->DisplayImage();
+  WaitForFrame();
 
   ASSERT_FALSE(displayed_.isNull());
   EXPECT_EQ(displayed_.size(), QSize(kW, kH));
@@ -141,7 +161,110 @@ TEST_F(CachedImagesListTest, CorruptImageShowsPlaceholder) {
   paths << MakeImage(0) << MakeCorrupt(1) << MakeImage(2);
   Build(std::move(paths), /*capacity=*/5, /*start=*/2);  // index 1 (corrupt)
   cache_->DisplayImage();
+  WaitForFrame();
 
   ASSERT_FALSE(displayed_.isNull());
   EXPECT_EQ(displayed_.size(), QSize(640, 360));
 }
+
+// PrepareSlot() reports the next image ready once it is decoded, without
+// ever blocking, and treats the end of the window as nothing to wait for.
+TEST_F(CachedImagesListTest, PrepareSlotBecomesReadyWithoutBlocking) {
+  Build(MakeImages(3), /*capacity=*/5, /*start=*/2);  // index 1
+
+  QElapsedTimer clock;
+  clock.start();
+  while (!cache_->PrepareSlot(1) && clock.elapsed() < 5000)
+    QCoreApplication::processEvents(QEventLoop::AllEvents, 10);
+  EXPECT_TRUE(cache_->PrepareSlot(1));
+  EXPECT_FALSE(cache_->SlotPixmap(1).isNull());
+  EXPECT_TRUE(cache_->PrepareSlot(2));  // past the end of the list
+}
+
+// A step to an image that is not decoded yet returns at once and leaves the
+// previous image up; the new one is presented when its decode completes. A
+// later step supersedes a frame that is still pending.
+TEST_F(CachedImagesListTest, DisplayNeverBlocksAndLatestRequestWins) {
+  Build(MakeImages(10), /*capacity=*/3, /*start=*/1);  // index 0
+  Go<NextImage>();
+  EXPECT_EQ(DisplayedIndex(), 0);
+
+  move_->moveTo<NextImage>();
+  move_->moveTo<NextImage>();
+  move_->moveTo<NextImage>();
+  WaitForFrame();
+  EXPECT_EQ(DisplayedIndex(), 3);
+  EXPECT_EQ(cache_->Size(), static_cast<std::size_t>(3));
+}
+
+// Steps that come faster than frames move the index and the window at once,
+// but only where they end up is presented. The slots stepped past stay in
+// line with the list.
+TEST_F(CachedImagesListTest, RapidStepsPresentOnlyTheLastTarget) {
+  Build(MakeImages(12), /*capacity=*/5, /*start=*/1);  // index 0
+  // However slowly the steps run, no frame is due before the last one.
+  cache_->SetFrameClock([] { return qint64(0); });
+  Go<NextImage>();
+  const int presents = presents_;
+
+  for (int i = 0; i < 6; ++i) move_->moveTo<NextImage>();
+  EXPECT_EQ(presents_, presents);
+  WaitForFrame();
+  EXPECT_EQ(presents_, presents + 1);
+  EXPECT_EQ(DisplayedIndex(), 6);
+  EXPECT_EQ(cache_->Size(), static_cast<std::size_t>(5));
+
+  for (int expected = 5; expected >= 2; --expected) {
+    Go<PreviousImage>();
+    EXPECT_EQ(DisplayedIndex(), expected);
+  }
+}
+
+// Slots hold frames fitted to the target, while the decoded image stays full
+// size. A new target re-targets the displayed slot in the background and
+// presents it again; the other slots follow when they are asked for.
+TEST_F(CachedImagesListTest, FramesFollowTheTarget) {
+  Build(MakeImages(3), /*capacity=*/5, /*start=*/1);  // index 0
+  EXPECT_EQ(displayed_.size(), QSize(kW, kH));
+
+  cache_->SetFrameTarget(QSize(100, 100));
+  QElapsedTimer clock;
+  clock.start();
+  while (displayed_.size() != QSize(100, 75) && clock.elapsed() < 5000)
+    QCoreApplication::processEvents(QEventLoop::AllEvents, 10);
+  EXPECT_EQ(displayed_.size(), QSize(100, 75));
+  EXPECT_EQ(DisplayedIndex(), 0);
+  EXPECT_EQ(cache_->ShownImage().size(), QSize(kW, kH));
+
+  while (cache_->SlotPixmap(1).size() != QSize(100, 75) &&
+         clock.elapsed() < 5000)
+    QCoreApplication::processEvents(QEventLoop::AllEvents, 10);
+  EXPECT_EQ(cache_->SlotPixmap(1).size(), QSize(100, 75));
+}
+
+// A rebuilt window starts from the decodes of the old one. One whose file
+// changed meanwhile is found out in the background and decoded again.
+TEST_F(CachedImagesListTest, KeptDecodeFollowsAChangedFile) {
+  const QVector<QString> paths = MakeImages(3);
+  Build(paths, /*capacity=*/5, /*start=*/1);  // index 0
+  cache_->DisplayImage();
+  WaitForFrame();
+  ASSERT_EQ(DisplayedIndex(), 0);
+
+  QImage image(kW, kH, QImage::Format_RGB32);
+  image.fill(QColor(200, 0, 0));
+  ASSERT_TRUE(image.save(paths[0], "PNG"));
+  QFile file(paths[0]);
+  ASSERT_TRUE(file.open(QIODevice::ReadWrite));
+  ASSERT_TRUE(file.setFileTime(QDateTime::currentDateTime().addSecs(60),
+                               QFileDevice::FileModificationTime));
+  file.close();
+
+  move_->moveTo<ImageNumber>(1);
+  cache_->DisplayImage();
+  QElapsedTimer clock;
+  clock.start();
+  while (DisplayedIndex() != 200 && clock.elapsed() < 5000)
+    QCoreApplication::processEvents(QEventLoop::AllEvents, 10);
+  EXPECT_EQ(DisplayedIndex(), 200);
+}
@@ -0,0 +1,135 @@
+#include "decode_queue.hpp"
+
+#include <gtest/gtest.h>
+
+#include <QColor>
+#include <QCoreApplication>
+#include <QElapsedTimer>
+#include <QHash>
+#include <QImage>
+#include <QTemporaryDir>
+#include <QVector>
+#include <atomic>
+#include <thread>
+#include <vector>
+
+namespace {
+
+struct DecodeQueueTest : public ::testing::Test {
+  QString MakeImage(QString const& name, QSize size) {
+    QImage image(size, QImage::Format_RGB32);
+    image.fill(QColor(10, 20, 30));
+    const QString path = tmp_.filePath(name);
+    EXPECT_TRUE(image.save(path, "PNG"));
+    return path;
+  }
+
+  // Records the order in which tasks are first announced, which is when
+  // their image is out, and how often each is announced in all.
+  void Watch(DecodeQueue& queue) {
+    QObject::connect(&queue, &DecodeQueue::taskFinished,
+                     [this](decode_task_t task) {
+                       if (announced_[task.get()]++ == 0)
+                         order_.append(task.get());
+                     });
+  }
+
+  // Lets the workers finish `tasks`, statistics included, and their
+  // announcements arrive.
+  void WaitForStats(QVector<decode_task_t> const& tasks) {
+    QElapsedTimer clock;
+    clock.start();
+    auto done = [&tasks] {
+      for (decode_task_t const& task : tasks)
+        if (!task->Stats()) return false;
+      return true;
+    };
+    while (!done() && clock.elapsed() < 10000)
+      QCoreApplication::processEvents(QEventLoop::AllEvents, 10);
+    ASSERT_TRUE(done());
+    QCoreApplication::processEvents(QEventLoop::AllEvents, 10);
+  }
+
+  QTemporaryDir tmp_;
+  QHash<DecodeTask*, int> announced_;
+  QVector<DecodeTask*> order_;
+};
+
+}  // namespace
+
+TEST(DecodeTaskTest, ExactlyOneThreadClaimsATask) {
+  for (int round = 0; round < 100; ++round) {
+    DecodeTask task(QStringLiteral("unused.png"));
+    std::atomic<int> claimed{0};
+    std::vector<std::thread> threads;
+    for (int i = 0; i < 4; ++i)
+      threads.emplace_back([&] { claimed += task.Claim(); });
+    for (std::thread& thread : threads) thread.join();
+    EXPECT_EQ(claimed.load(), 1);
+  }
+}
+
+// A task that is both queued for the workers and expedited is decoded once:
+// announced for its image and then for its statistics, no more.
+TEST_F(DecodeQueueTest, ExpeditedTasksAreDecodedOnce) {
+  const QString path = MakeImage("small.png", QSize(64, 48));
+  DecodeQueue queue(4);
+  Watch(queue);
+  QVector<decode_task_t> tasks;
+  for (int i = 0; i < 40; ++i) {
+    tasks.append(queue.Submit(path));
+    queue.Expedite(tasks.back());
+  }
+  WaitForStats(tasks);
+  for (decode_task_t const& task : tasks) {
+    EXPECT_TRUE(task->IsDone());
+    EXPECT_EQ(announced_.value(task.get()), 2);
+  }
+}
+
+// A deferred task waits for every other request, even one that found the
+// request ring full; Prefetch() takes that back.
+TEST_F(DecodeQueueTest, DeferredTaskGoesLastUnlessPrefetched) {
+  // Keeps the only worker busy while the rest is queued and deferred.
+  const QString large = MakeImage("large.png", QSize(6000, 4000));
+  const QString small = MakeImage("small.png", QSize(64, 48));
+  DecodeQueue queue(1);
+  Watch(queue);
+  const decode_task_t gate = queue.Submit(large);
+  const decode_task_t b = queue.Submit(small);
+  const decode_task_t c = queue.Submit(small);
+  const decode_task_t d = queue.Submit(small);
+  const decode_task_t e = queue.Submit(small);
+  queue.Defer(b);
+  queue.Defer(d);
+  queue.Prefetch(d);
+  // More than the ring holds, so that f and g overflow.
+  QVector<decode_task_t> fillers;
+  for (int i = 0; i < 80; ++i) fillers.append(queue.Submit(small));
+  const decode_task_t f = queue.Submit(small);
+  const decode_task_t g = queue.Submit(small);
+  queue.Defer(f);
+
+  QVector<decode_task_t> tasks{gate, b, c, d, e};
+  tasks << fillers << f << g;
+  WaitForStats(tasks);
+  QVector<DecodeTask*> expected{gate.get(), c.get(), d.get(), e.get()};
+  for (decode_task_t const& filler : fillers) expected.append(filler.get());
+  expected << g.get() << b.get() << f.get();
+  EXPECT_EQ(order_, expected);
+}
+
+// Requests beyond the capacity of the request ring still reach the workers,
+// in order, without anyone asking for their result.
+TEST_F(DecodeQueueTest, FullRequestRingOverflowsToTheWorkers) {
+  const QString large = MakeImage("large.png", QSize(6000, 4000));
+  const QString small = MakeImage("small.png", QSize(16, 16));
+  DecodeQueue queue(1);
+  Watch(queue);
+  QVector<decode_task_t> tasks{queue.Submit(large)};
+  for (int i = 0; i < 200; ++i) tasks.append(queue.Submit(small));
+  WaitForStats(tasks);
+  QVector<DecodeTask*> submitted;
+  for (decode_task_t const& task : tasks) submitted.append(task.get());
+  EXPECT_EQ(order_, submitted);
+}
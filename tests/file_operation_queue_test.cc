@@ -0,0 +1,117 @@
+#include "file_operation_queue.hpp"
+
+#include <gtest/gtest.h>
+
+#include <QCoreApplication>
+#include <QDir>
+#include <QFile>
+#include <QTemporaryDir>
+#include <QVector>
+
+namespace {
+
+QString MakeFile(QDir const& dir, QString const& name) {
+  const QString path = dir.filePath(name);
+  QFile file(path);
+  EXPECT_TRUE(file.open(QIODevice::WriteOnly));
+  file.write("pviewer");
+  return path;
+}
+
+// The queue reports back through queued QFutureWatcher signals, so spin the
+// event loop until every submitted operation (and undo) has been handled.
+void WaitForIdle(FileOperationQueue& queue) {
+  while (queue.Pending() > 0)
+    QCoreApplication::processEvents(QEventLoop::AllEvents, 10);
+}
+
+}  // namespace
+
+TEST(FileOperationQueueTest, MoveThenUndoRestoresFile) {
+  QTemporaryDir dir;
+  ASSERT_TRUE(dir.isValid());
+  QDir root(dir.path());
+  ASSERT_TRUE(root.mkdir("target"));
+  const QString source = MakeFile(root, "a.png");
+
+  FileOperationQueue queue;
+  queue.MoveTo(source, root.filePath("target"));
+  WaitForIdle(queue);
+  EXPECT_FALSE(QFile::exists(source));
+  EXPECT_TRUE(QFile::exists(root.filePath("target/a.png")));
+
+  int undone = 0;
+  QObject::connect(&queue, &FileOperationQueue::undone,
+                   [&](FileOperationQueue::Operation) { ++undone; });
+  ASSERT_TRUE(queue.Undo());
+  WaitForIdle(queue);
+  EXPECT_EQ(undone, 1);
+  EXPECT_TRUE(QFile::exists(source));
+  EXPECT_FALSE(QFile::exists(root.filePath("target/a.png")));
+  EXPECT_FALSE(queue.CanUndo());
+}
+
+TEST(FileOperationQueueTest, UndoOfCopyRemovesOnlyTheCopy) {
+  QTemporaryDir dir;
+  ASSERT_TRUE(dir.isValid());
+  QDir root(dir.path());
+  ASSERT_TRUE(root.mkdir("target"));
+  const QString source = MakeFile(root, "a.png");
+
+  FileOperationQueue queue;
+  queue.CopyTo(source, root.filePath("target"));
+  // Undo is accepted before the copy has even run; the serial queue orders it.
+  ASSERT_TRUE(queue.Undo());
+  WaitForIdle(queue);
+
+  EXPECT_TRUE(QFile::exists(source));
+  EXPECT_FALSE(QFile::exists(root.filePath("target/a.png")));
+}
+
+TEST(FileOperationQueueTest, MoveOntoExistingFileFailsWithoutTouchingIt) {
+  QTemporaryDir dir;
+  ASSERT_TRUE(dir.isValid());
+  QDir root(dir.path());
+  ASSERT_TRUE(root.mkdir("target"));
+  const QString source = MakeFile(root, "a.png");
+  MakeFile(QDir(root.filePath("target")), "a.png");
+
+  FileOperationQueue queue;
+  int failed_id = 0;
+  QObject::connect(&queue, &FileOperationQueue::failed,
+                   [&](FileOperationQueue::Operation operation, QString) {
+                     failed_id = operation.id;
+                   });
+  const int id = queue.MoveTo(source, root.filePath("target"));
+  WaitForIdle(queue);
+
+  EXPECT_EQ(failed_id, id);
+  EXPECT_TRUE(QFile::exists(source));
+  EXPECT_FALSE(queue.CanUndo());
+}
+
+TEST(FileOperationQueueTest, OnlyTheLastOperationsCanBeUndone) {
+  QTemporaryDir dir;
+  ASSERT_TRUE(dir.isValid());
+  QDir root(dir.path());
+  ASSERT_TRUE(root.mkdir("target"));
+
+  FileOperationQueue queue;
+  QVector<int> expired;
+  QObject::connect(&queue, &FileOperationQueue::expired,
+                   [&expired](int id) { expired.append(id); });
+  QVector<int> ids;
+  for (int i = 0; i <= FileOperationQueue::kUndoDepth; ++i) {
+    const QString source = MakeFile(root, QStringLiteral("%1.png").arg(i));
+    ids.append(queue.CopyTo(source, root.filePath("target")));
+  }
+  WaitForIdle(queue);
+  EXPECT_EQ(expired, QVector<int>{ids.first()});
+
+  int undone = 0;
+  while (queue.Undo()) ++undone;
+  WaitForIdle(queue);
+  EXPECT_EQ(undone, FileOperationQueue::kUndoDepth);
+  EXPECT_TRUE(QFile::exists(root.filePath("target/0.png")));
+  EXPECT_FALSE(QFile::exists(root.filePath("target/1.png")));
+}
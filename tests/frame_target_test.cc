@@ -0,0 +1,57 @@
+#include "frame_target.hpp"
+
+#include <gtest/gtest.h>
+
+#include <QColor>
+#include <QWidget>
+
+TEST(FrameTargetTest, ScreenTargetIsInDevicePixels) {
+  EXPECT_EQ(ScreenFrameTarget(QSize(1920, 1080), 1), QSize(1920, 1080));
+  EXPECT_EQ(ScreenFrameTarget(QSize(1920, 1080), 2), QSize(3840, 2160));
+  EXPECT_EQ(ScreenFrameTarget(QSize(1280, 720), 1.5), QSize(1920, 1080));
+  EXPECT_FALSE(ScreenFrameTarget(nullptr).isValid());
+  EXPECT_FALSE(ViewFrameTarget(nullptr).isValid());
+}
+
+TEST(FrameTargetTest, ViewTargetFollowsTheViewSize) {
+  QWidget view;
+  view.resize(640, 480);
+  const double ratio = view.devicePixelRatioF();
+  EXPECT_EQ(ViewFrameTarget(&view), ScreenFrameTarget(QSize(640, 480), ratio));
+  EXPECT_EQ(ViewFrameTarget(&view, 2),
+            ScreenFrameTarget(QSize(640, 480), ratio, 2));
+}
+
+TEST(FrameTargetTest, ZoomIsRoundedUpToAPowerOfTwo) {
+  const QSize screen(1000, 500);
+  EXPECT_EQ(ScreenFrameTarget(screen, 1, 0.5), QSize(1000, 500));
+  EXPECT_EQ(ScreenFrameTarget(screen, 1, 1), QSize(1000, 500));
+  EXPECT_EQ(ScreenFrameTarget(screen, 1, 1.25), QSize(2000, 1000));
+  EXPECT_EQ(ScreenFrameTarget(screen, 1, 2), QSize(2000, 1000));
+  EXPECT_EQ(ScreenFrameTarget(screen, 2, 3), QSize(8000, 4000));
+}
+
+TEST(FrameTargetTest, LargerImagesAreFittedKeepingTheirAspectRatio) {
+  QImage image(2000, 1000, QImage::Format_RGB32);
+  image.fill(QColor(10, 20, 30));
+  const QImage frame = FitToTarget(image, QSize(800, 800));
+  EXPECT_EQ(frame.size(), QSize(800, 400));
+  EXPECT_EQ(frame.pixelColor(400, 200), QColor(10, 20, 30));
+}
+
+TEST(FrameTargetTest, ImagesThatFitAreNotCopied) {
+  QImage image(300, 200, QImage::Format_RGB32);
+  image.fill(Qt::white);
+  EXPECT_EQ(FitToTarget(image, QSize(300, 200)).constBits(),
+            image.constBits());
+  EXPECT_EQ(FitToTarget(image, QSize()).constBits(), image.constBits());
+}
+
+TEST(FrameTargetTest, TargetsTheImageFitsGiveTheSameFrame) {
+  const QSize image(1000, 800);
+  EXPECT_TRUE(SameFrame(image, QSize(500, 500), QSize(500, 500)));
+  EXPECT_TRUE(SameFrame(image, QSize(1000, 800), QSize(4000, 4000)));
+  EXPECT_TRUE(SameFrame(image, QSize(2000, 2000), QSize()));
+  EXPECT_FALSE(SameFrame(image, QSize(500, 500), QSize(2000, 2000)));
+  EXPECT_FALSE(SameFrame(image, QSize(2000, 700), QSize(2000, 2000)));
+}
@@ -10,6 +10,10 @@ QVector<QString> Paths(std::initializer_list<const char*> paths) {
   return result;
 }
 
+QVector<QString> EnabledPaths(ImageComparisonModel const& model) {
+  return PathStore::Shared().Paths(model.EnabledIds());
+}
+
 }  // namespace
 
 TEST(ImageComparisonModelTest, EnabledPathsFollowCheckboxState) {
@@ -18,7 +22,7 @@ TEST(ImageComparisonModelTest, EnabledPathsFollowCheckboxState) {
 
   ASSERT_TRUE(model.SetEnabled(1, false));
 
-  EXPECT_EQ(model.EnabledPaths(), Paths({"a.png", "c.png"}));
+  EXPECT_EQ(EnabledPaths(model), Paths({"a.png", "c.png"}));
 }
 
 TEST(ImageComparisonModelTest, SetPathEnabledUpdatesCheckboxStateByIdentity) {
@@ -27,7 +31,7 @@ TEST(ImageComparisonModelTest, SetPathEnabledUpdatesCheckboxStateByIdentity) {
 
   ASSERT_TRUE(model.SetPathEnabled("b.png", false));
 
-  EXPECT_EQ(model.EnabledPaths(), Paths({"a.png", "c.png"}));
+  EXPECT_EQ(EnabledPaths(model), Paths({"a.png", "c.png"}));
   EXPECT_FALSE(model.SetPathEnabled("missing.png", false));
 }
 
@@ -37,7 +41,7 @@ TEST(ImageComparisonModelTest, MoveReordersEnabledPaths) {
 
   ASSERT_TRUE(model.Move(2, 0));
 
-  EXPECT_EQ(model.EnabledPaths(), Paths({"c.png", "a.png", "b.png"}));
+  EXPECT_EQ(EnabledPaths(model), Paths({"c.png", "a.png", "b.png"}));
 }
 
 TEST(ImageComparisonModelTest, MovePathReordersByImageIdentity) {
@@ -46,7 +50,7 @@ TEST(ImageComparisonModelTest, MovePathReordersByImageIdentity) {
 
   ASSERT_TRUE(model.MovePath("b.png", 1));
 
-  EXPECT_EQ(model.EnabledPaths(), Paths({"a.png", "c.png", "b.png"}));
+  EXPECT_EQ(EnabledPaths(model), Paths({"a.png", "c.png", "b.png"}));
   EXPECT_FALSE(model.MovePath("missing.png", 1));
   EXPECT_FALSE(model.MovePath("b.png", 1));
 }
@@ -80,7 +84,7 @@ TEST(ImageComparisonModelTest, RemovePathDropsImageFromComparison) {
 
   ASSERT_TRUE(model.RemovePath("b.png"));
 
-  EXPECT_EQ(model.EnabledPaths(), Paths({"a.png", "c.png"}));
+  EXPECT_EQ(EnabledPaths(model), Paths({"a.png", "c.png"}));
   EXPECT_FALSE(model.RemovePath("missing.png"));
 }
 
@@ -90,6 +94,75 @@ TEST(ImageComparisonModelTest, NoEnabledImagesHaveNoActivePosition) {
   ASSERT_TRUE(model.SetEnabled(0, false));
   ASSERT_TRUE(model.SetEnabled(1, false));
 
-  EXPECT_TRUE(model.EnabledPaths().isEmpty());
+  EXPECT_TRUE(EnabledPaths(model).isEmpty());
   EXPECT_EQ(model.EnabledPositionFor("a.png"), 0);
 }
+
+TEST(ImageComparisonModelTest, ActiveIndexSkipsDisabledEntries) {
+  ImageComparisonModel model;
+  model.SetImages(Paths({"a.png", "b.png", "c.png"}));
+  ASSERT_TRUE(model.SetEnabled(0, false));
+
+  EXPECT_EQ(model.ActiveIndexOf("a.png"), -1);
+  EXPECT_EQ(model.ActiveIndexOf("c.png"), 1);
+  EXPECT_EQ(model.ActiveIndexOf("missing.png"), -1);
+}
+
+TEST(ImageComparisonModelTest, ApplyEditMatchesDirectOperations) {
+  ImageComparisonModel model;
+  model.SetImages(Paths({"a.png", "b.png", "c.png", "d.png"}));
+
+  ASSERT_TRUE(model.ApplyEdit({EntryEdit::Kind::Disable, "b.png"}));
+  ASSERT_TRUE(model.ApplyEdit({EntryEdit::Kind::Move, "d.png", 0}));
+  ASSERT_TRUE(model.ApplyEdit({EntryEdit::Kind::Remove, "c.png"}));
+  EXPECT_EQ(EnabledPaths(model), Paths({"d.png", "a.png"}));
+
+  ASSERT_TRUE(model.ApplyEdit({EntryEdit::Kind::Enable, "b.png"}));
+  EXPECT_EQ(EnabledPaths(model), Paths({"d.png", "a.png", "b.png"}));
+  EXPECT_FALSE(model.ApplyEdit({EntryEdit::Kind::Move, "b.png", 3}));
+  EXPECT_FALSE(model.ApplyEdit({EntryEdit::Kind::Remove, "missing.png"}));
+}
+
+TEST(ImageComparisonModelTest, InsertRestoresRemovedEntryAtClampedRow) {
+  ImageComparisonModel model;
+  model.SetImages(Paths({"a.png", "b.png", "c.png"}));
+  ASSERT_TRUE(model.RemovePath("c.png"));
+
+  ASSERT_TRUE(model.ApplyEdit({EntryEdit::Kind::Insert, "c.png", 7}));
+  EXPECT_EQ(EnabledPaths(model), Paths({"a.png", "b.png", "c.png"}));
+  const PathId a = PathStore::Shared().Intern("a.png");
+  EXPECT_FALSE(model.Insert(0, ImageEntry{a, true}));
+}
+
+TEST(ImageComparisonModelTest, DefaultEntryNamesNoImage) {
+  ImageComparisonModel model;
+  model.SetImages(Paths({"a.png", "b.png"}));
+
+  const ImageEntry entry;
+  EXPECT_EQ(entry.id, kNoPath);
+  EXPECT_TRUE(entry.Path().isEmpty());
+  EXPECT_EQ(model.RowOf(entry.id), -1);
+  EXPECT_FALSE(model.Insert(0, entry));
+  EXPECT_EQ(model.Entries().size(), 2);
+}
+
+TEST(ImageComparisonModelTest, EditsBetweenReproduceAWholesaleChange) {
+  ImageComparisonModel model;
+  model.SetImages(Paths({"a.png", "b.png", "c.png", "d.png", "e.png"}));
+  const QVector<ImageEntry> before = model.Entries();
+
+  ImageComparisonModel changed;
+  changed.SetImages(Paths({"e.png", "c.png", "f.png", "a.png", "b.png"}));
+  ASSERT_TRUE(changed.SetEnabled(1, false));
+  const QVector<ImageEntry> after = changed.Entries();
+
+  const QVector<EntryEdit> edits = EditsBetween(before, after);
+  for (EntryEdit const& edit : edits) ASSERT_TRUE(model.ApplyEdit(edit));
+  ASSERT_EQ(model.Entries().size(), after.size());
+  for (int row = 0; row < after.size(); ++row) {
+    EXPECT_EQ(model.Entries()[row].id, after[row].id);
+    EXPECT_EQ(model.Entries()[row].enabled, after[row].enabled);
+  }
+  EXPECT_EQ(edits.front().kind, EntryEdit::Kind::Remove);
+  EXPECT_TRUE(EditsBetween(after, after).isEmpty());
+}
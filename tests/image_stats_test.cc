@@ -0,0 +1,78 @@
+#include "image_stats.hpp"
+
+#include <gtest/gtest.h>
+
+#include <QColor>
+#include <random>
+
+namespace {
+
+QImage Noise(int width, int height, std::mt19937& random) {
+  QImage image(width, height, QImage::Format_RGB32);
+  for (int y = 0; y < height; ++y) {
+    auto* line = reinterpret_cast<QRgb*>(image.scanLine(y));
+    for (int x = 0; x < width; ++x) line[x] = 0xff000000 | (random() >> 8);
+  }
+  return image;
+}
+
+}  // namespace
+
+TEST(ImageStatsTest, CountsLevelsPerChannel) {
+  QImage image(4, 1, QImage::Format_RGB32);
+  image.setPixel(0, 0, qRgb(0, 0, 0));
+  image.setPixel(1, 0, qRgb(255, 255, 255));
+  image.setPixel(2, 0, qRgb(255, 10, 20));
+  image.setPixel(3, 0, qRgb(100, 100, 100));
+  const ImageStats stats = ComputeImageStats(image);
+  EXPECT_EQ(stats.pixels, 4);
+  EXPECT_EQ(stats.histograms[ImageStats::Red][255], 2u);
+  EXPECT_EQ(stats.histograms[ImageStats::Green][10], 1u);
+  EXPECT_EQ(stats.histograms[ImageStats::Blue][20], 1u);
+  EXPECT_EQ(stats.histograms[ImageStats::Luma][0], 1u);
+  EXPECT_EQ(stats.histograms[ImageStats::Luma][255], 1u);
+  EXPECT_EQ(stats.histograms[ImageStats::Luma][100], 1u);
+  // (77 * 255 + 150 * 10 + 29 * 20 + 128) / 256
+  EXPECT_EQ(stats.histograms[ImageStats::Luma][85], 1u);
+  EXPECT_EQ(stats.black, 1);
+  EXPECT_EQ(stats.white, 2);
+}
+
+TEST(ImageStatsTest, DerivesMinMaxAndMean) {
+  QImage image(2, 2, QImage::Format_RGB32);
+  image.fill(qRgb(40, 0, 0));
+  image.setPixel(1, 1, qRgb(200, 0, 0));
+  const ImageStats stats = ComputeImageStats(image);
+  EXPECT_EQ(stats.Min(ImageStats::Red), 40);
+  EXPECT_EQ(stats.Max(ImageStats::Red), 200);
+  EXPECT_DOUBLE_EQ(stats.Mean(ImageStats::Red), 80.0);
+  EXPECT_EQ(stats.Max(ImageStats::Green), 0);
+  EXPECT_EQ(ComputeImageStats(QImage()).Min(ImageStats::Luma), -1);
+}
+
+TEST(ImageStatsTest, VectorKernelsMatchTheScalarOne) {
+  std::mt19937 random(11);
+  // An odd width leaves a tail after the last full vector of every row.
+  QImage image = Noise(203, 131, random);
+  // Saturated and black pixels exercise the clipping counts.
+  for (int x = 0; x < 203; x += 5) {
+    image.setPixel(x, 7, qRgb(x % 3 ? 255 : 0, 0, 0));
+    image.setPixel(x, 9, qRgb(0, 0, 0));
+  }
+  const ImageStats scalar = ComputeImageStats(image, SimdLevel::Scalar);
+  for (SimdLevel level : {SimdLevel::Sse2, SimdLevel::Avx2}) {
+    if (!IsSupported(level)) continue;
+    const ImageStats stats = ComputeImageStats(image, level);
+    EXPECT_EQ(stats.histograms, scalar.histograms);
+    EXPECT_EQ(stats.black, scalar.black);
+    EXPECT_EQ(stats.white, scalar.white);
+  }
+}
+
+TEST(ImageStatsTest, ConvertsOtherFormats) {
+  QImage image(3, 3, QImage::Format_Grayscale8);
+  image.fill(128);
+  const ImageStats stats = ComputeImageStats(image);
+  EXPECT_EQ(stats.histograms[ImageStats::Luma][128], 9u);
+  EXPECT_EQ(stats.histograms[ImageStats::Red][128], 9u);
+}
@@ -3,16 +3,30 @@
 #include <QApplication>
 #include <QClipboard>
 #include <QColor>
+#include <QElapsedTimer>
+#include <QFile>
 #include <QImage>
 #include <QKeyEvent>
 #include <QMimeData>
 #include <QScrollBar>
 #include <QTemporaryDir>
+#include <vector>
 
 #include "main_window.hpp"
+#include "split_view.hpp"
 
 namespace {
 
+// Display is asynchronous: lets the image a step asked for be decoded and
+// shown.
+void WaitForDisplay(MainWindow& window) {
+  QElapsedTimer clock;
+  clock.start();
+  while (window.isDisplayPending() && clock.elapsed() < 5000)
+    QCoreApplication::processEvents(QEventLoop::WaitForMoreEvents, 10);
+  EXPECT_FALSE(window.isDisplayPending());
+}
+
 QString MakeImage(QTemporaryDir& dir, QString name, QSize size, QColor color) {
   QImage image(size, QImage::Format_RGB32);
   image.fill(color);
@@ -28,6 +42,7 @@ void SendCtrlArrow(MainWindow& window, Qt::Key key) {
   QKeyEvent release(QEvent::KeyRelease, key, Qt::ControlModifier);
   QApplication::sendEvent(&window, &release);
   QCoreApplication::processEvents(QEventLoop::AllEvents, 10);
+  WaitForDisplay(window);
 }
 
 double ViewportCenterYFraction(MainWindow& window) {
@@ -45,6 +60,7 @@ void SendKey(MainWindow& window, Qt::Key key,
   QKeyEvent release(QEvent::KeyRelease, key, modifiers);
   QApplication::sendEvent(&window, &release);
   QCoreApplication::processEvents(QEventLoop::AllEvents, 10);
+  WaitForDisplay(window);
 }
 
 }  // namespace
@@ -60,6 +76,7 @@ TEST(MainWindowViewportTest, OpensTallImageFitToViewportHeight) {
   window.resize(800, 600);
   window.show();
   QCoreApplication::processEvents(QEventLoop::AllEvents, 10);
+  WaitForDisplay(window);
 
   EXPECT_EQ(window.sceneRect().size(), QSizeF(500, 1400));
   EXPECT_DOUBLE_EQ(window.transform().m11(),
@@ -81,6 +98,7 @@ TEST(MainWindowViewportTest, HidesCurrentImageAndDisplaysNextActiveImage) {
   window.resize(800, 600);
   window.show();
   QCoreApplication::processEvents(QEventLoop::AllEvents, 10);
+  WaitForDisplay(window);
   ASSERT_EQ(window.sceneRect().size(), QSizeF(320, 240));
 
   SendKey(window, Qt::Key_H);
@@ -88,6 +106,37 @@ TEST(MainWindowViewportTest, HidesCurrentImageAndDisplaysNextActiveImage) {
   EXPECT_EQ(window.sceneRect().size(), QSizeF(640, 360));
 }
 
+TEST(MainWindowViewportTest, SplitViewNarrowsMainViewAndShowsNextImage) {
+  QTemporaryDir dir;
+  ASSERT_TRUE(dir.isValid());
+
+  const QString first =
+      MakeImage(dir, "first.png", QSize(400, 300), QColor(180, 0, 0));
+  const QString second =
+      MakeImage(dir, "second.png", QSize(400, 300), QColor(0, 180, 0));
+
+  MainWindow window(QList<QString>{first, second});
+  window.resize(800, 600);
+  window.show();
+  QCoreApplication::processEvents(QEventLoop::AllEvents, 10);
+  WaitForDisplay(window);
+  auto* split_view = window.findChild<SplitView*>();
+  ASSERT_NE(split_view, nullptr);
+  EXPECT_FALSE(split_view->isVisible());
+
+  SendKey(window, Qt::Key_V);
+
+  EXPECT_TRUE(split_view->isVisible());
+  EXPECT_EQ(split_view->PaneCount(), 1);
+  EXPECT_EQ(window.viewport()->width(), 400);
+  EXPECT_DOUBLE_EQ(window.transform().m11(), 1.0);
+
+  SendKey(window, Qt::Key_V);
+
+  EXPECT_FALSE(split_view->isVisible());
+  EXPECT_EQ(window.viewport()->width(), 800);
+}
+
 TEST(MainWindowViewportTest, CopiesCurrentImageFileToClipboard) {
   QTemporaryDir dir;
   ASSERT_TRUE(dir.isValid());
@@ -99,6 +148,7 @@ TEST(MainWindowViewportTest, CopiesCurrentImageFileToClipboard) {
   window.resize(800, 600);
   window.show();
   QCoreApplication::processEvents(QEventLoop::AllEvents, 10);
+  WaitForDisplay(window);
 
   QApplication::clipboard()->clear();
   SendKey(window, Qt::Key_C, Qt::ControlModifier);
@@ -126,6 +176,7 @@ TEST(MainWindowViewportTest,
   window.resize(800, 600);
   window.show();
   QCoreApplication::processEvents(QEventLoop::AllEvents, 10);
+  WaitForDisplay(window);
 
   SendCtrlArrow(window, Qt::Key_Right);
   SendCtrlArrow(window, Qt::Key_Right);
@@ -147,3 +198,84 @@ TEST(MainWindowViewportTest,
 
   EXPECT_NEAR(after, before, 0.005);
 }
+
+// Delete acts on the image on screen. While the frame of a step is pending,
+// that is still the previous image, not the one the list already points to.
+TEST(MainWindowViewportTest, DeleteDuringPendingFrameRemovesShownImage) {
+  QTemporaryDir dir;
+  ASSERT_TRUE(dir.isValid());
+
+  const QString first =
+      MakeImage(dir, "first.png", QSize(320, 240), QColor(180, 0, 0));
+  // Large, so that its decode is still running when the step asks for it.
+  const QString second =
+      MakeImage(dir, "second.png", QSize(6000, 4000), QColor(0, 180, 0));
+
+  MainWindow window(QList<QString>{first, second});
+  window.resize(800, 600);
+  window.show();
+  QCoreApplication::processEvents(QEventLoop::AllEvents, 10);
+  WaitForDisplay(window);
+  ASSERT_EQ(window.sceneRect().size(), QSizeF(320, 240));
+
+  // No events are processed in between, so the frame cannot arrive before
+  // Delete does.
+  QKeyEvent step(QEvent::KeyPress, Qt::Key_Right, Qt::ControlModifier);
+  QApplication::sendEvent(&window, &step);
+  ASSERT_TRUE(window.isDisplayPending());
+  QKeyEvent remove(QEvent::KeyPress, Qt::Key_Delete, Qt::NoModifier);
+  QApplication::sendEvent(&window, &remove);
+
+  QElapsedTimer clock;
+  clock.start();
+  while (QFile::exists(first) && clock.elapsed() < 5000)
+    QCoreApplication::processEvents(QEventLoop::AllEvents, 10);
+  EXPECT_FALSE(QFile::exists(first));
+  EXPECT_TRUE(QFile::exists(second));
+  WaitForDisplay(window);
+  EXPECT_EQ(window.sceneRect().size(), QSizeF(6000, 4000));
+
+  // Takes the file back out of the trash.
+  SendKey(window, Qt::Key_Z, Qt::ControlModifier);
+  clock.restart();
+  while (!QFile::exists(first) && clock.elapsed() < 5000)
+    QCoreApplication::processEvents(QEventLoop::AllEvents, 10);
+  EXPECT_TRUE(QFile::exists(first));
+}
+
+// A key that paints nothing is not measured, and the next key's latency is
+// timed from that key, not from the idle one before it.
+TEST(MainWindowViewportTest, KeyWithoutRepaintDoesNotTimeTheNextStep) {
+  QTemporaryDir dir;
+  ASSERT_TRUE(dir.isValid());
+
+  const QString first =
+      MakeImage(dir, "first.png", QSize(320, 240), QColor(180, 0, 0));
+  const QString second =
+      MakeImage(dir, "second.png", QSize(320, 240), QColor(0, 180, 0));
+
+  MainWindow window(QList<QString>{first, second});
+  window.resize(800, 600);
+  window.show();
+  QCoreApplication::processEvents(QEventLoop::AllEvents, 10);
+  WaitForDisplay(window);
+
+  std::vector<double> latencies;
+  QObject::connect(&window, &MainWindow::stepMeasured,
+                   [&latencies](StepSample sample) {
+                     latencies.push_back(sample.latency_ms);
+                   });
+  SendKey(window, Qt::Key_F1);
+  QElapsedTimer clock;
+  clock.start();
+  while (clock.elapsed() < 300)
+    QCoreApplication::processEvents(QEventLoop::AllEvents, 10);
+  latencies.clear();
+
+  SendCtrlArrow(window, Qt::Key_Right);
+  clock.restart();
+  while (latencies.empty() && clock.elapsed() < 5000)
+    QCoreApplication::processEvents(QEventLoop::AllEvents, 10);
+  ASSERT_FALSE(latencies.empty());
+  EXPECT_LT(latencies.front(), 300);
+}
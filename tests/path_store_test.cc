@@ -0,0 +1,60 @@
+#include "path_store.hpp"
+
+#include <gtest/gtest.h>
+
+TEST(PathStoreTest, EqualPathsShareAnId) {
+  PathStore store;
+  const PathId a = store.Intern(QStringLiteral("/photos/a.jpg"));
+  const PathId b = store.Intern(QStringLiteral("/photos/b.jpg"));
+  const PathId other = store.Intern(QStringLiteral("/other/a.jpg"));
+  EXPECT_NE(a, b);
+  EXPECT_NE(a, other);
+  EXPECT_EQ(store.Intern(QStringLiteral("/photos/a.jpg")), a);
+  EXPECT_EQ(store.Size(), 3);
+}
+
+TEST(PathStoreTest, IdsGiveBackTheirPaths) {
+  PathStore store;
+  const PathId id = store.Intern(QStringLiteral("/photos/2024/IMG_0001.jpg"));
+  const PathId bare = store.Intern(QStringLiteral("relative.png"));
+  EXPECT_EQ(store.Path(id), QStringLiteral("/photos/2024/IMG_0001.jpg"));
+  EXPECT_EQ(store.FileName(id), QStringLiteral("IMG_0001.jpg"));
+  EXPECT_EQ(store.Path(bare), QStringLiteral("relative.png"));
+}
+
+TEST(PathStoreTest, FindNeverAdds) {
+  PathStore store;
+  EXPECT_FALSE(store.Find(QStringLiteral("/photos/a.jpg")));
+  const PathId id = store.Intern(QStringLiteral("/photos/a.jpg"));
+  EXPECT_EQ(store.Find(QStringLiteral("/photos/a.jpg")), id);
+  EXPECT_FALSE(store.Find(QStringLiteral("/photos/b.jpg")));
+  EXPECT_FALSE(store.Find(QStringLiteral("/elsewhere/a.jpg")));
+  EXPECT_EQ(store.Size(), 1);
+}
+
+// Past many rehashes, every id still finds its own path and no other.
+TEST(PathStoreTest, StaysConsistentAsItGrows) {
+  PathStore store;
+  QVector<QString> paths;
+  for (int i = 0; i < 20000; ++i) {
+    const QString name =
+        QStringLiteral("IMG_%1.jpg").arg(i, 6, 10, QLatin1Char('0'));
+    paths.push_back(QStringLiteral("/photos/dir_%1/").arg(i % 7) + name);
+  }
+  const QVector<PathId> ids = store.Intern(paths);
+  ASSERT_EQ(store.Size(), 20000);
+  EXPECT_EQ(store.Intern(paths), ids);
+  EXPECT_EQ(store.Paths(ids), paths);
+  EXPECT_LT(store.MemoryBytes(), 20000 * 64);
+}
+
+TEST(PathStoreTest, InterningKnownPathsAgainKeepsTheFootprint) {
+  PathStore store;
+  QVector<QString> paths;
+  for (int i = 0; i < 1000; ++i)
+    paths.push_back(QStringLiteral("/photos/IMG_%1.jpg").arg(i));
+  const QVector<PathId> ids = store.Intern(paths);
+  const qint64 bytes = store.MemoryBytes();
+  for (int round = 0; round < 3; ++round) EXPECT_EQ(store.Intern(paths), ids);
+  EXPECT_EQ(store.MemoryBytes(), bytes);
+}
@@ -0,0 +1,142 @@
+#include "perceptual_hash.hpp"
+
+#include <gtest/gtest.h>
+
+#include <QColor>
+#include <QPainter>
+#include <numeric>
+#include <random>
+#include <vector>
+
+#include "duplicate_finder.hpp"
+
+namespace {
+
+// Horizontal bands of grey, brightest in the middle.
+QImage Gradient(QSize size, int offset) {
+  QImage image(size, QImage::Format_RGB32);
+  for (int x = 0; x < size.width(); ++x) {
+    const int level = std::clamp(
+        offset + 255 - std::abs(2 * 255 * x / size.width() - 255), 0, 255);
+    for (int y = 0; y < size.height(); ++y)
+      image.setPixel(x, y, qRgb(level, level, level));
+  }
+  return image;
+}
+
+QImage Checkers(QSize size) {
+  QImage image(size, QImage::Format_RGB32);
+  image.fill(Qt::white);
+  QPainter painter(&image);
+  const int cell = size.width() / 9;
+  for (int y = 0; y * cell < size.height(); ++y) {
+    for (int x = (y % 2); x * cell < size.width(); x += 2)
+      painter.fillRect(x * cell, y * cell, cell, cell, Qt::black);
+  }
+  return image;
+}
+
+// Bursts: random base hashes, each followed by copies with a few random
+// bits flipped, so that pairs fall on both sides of any small distance.
+QVector<std::optional<quint64>> Bursts(std::mt19937_64& random, int count) {
+  QVector<std::optional<quint64>> hashes;
+  quint64 base = random();
+  for (int i = 0; i < count; ++i) {
+    if (random() % 8 == 0) base = random();
+    quint64 hash = base;
+    for (int flips = random() % 12; flips > 0; --flips)
+      hash ^= 1ull << (random() % 64);
+    if (random() % 20 == 0)
+      hashes.append(std::nullopt);
+    else
+      hashes.append(hash);
+  }
+  return hashes;
+}
+
+// Joins every pair within `max_distance`, numbered as NearDuplicateClusters
+// numbers its result.
+clusters_t AllPairsClusters(QVector<std::optional<quint64>> const& hashes,
+                            int max_distance) {
+  std::vector<int> parent(hashes.size());
+  std::iota(parent.begin(), parent.end(), 0);
+  auto find = [&parent](int i) {
+    while (parent[i] != i) i = parent[i];
+    return i;
+  };
+  for (int a = 0; a < hashes.size(); ++a) {
+    for (int b = a + 1; b < hashes.size(); ++b) {
+      if (hashes[a] && hashes[b] &&
+          HammingDistance(*hashes[a], *hashes[b]) <= max_distance) {
+        const int root_a = find(a), root_b = find(b);
+        parent[std::max(root_a, root_b)] = std::min(root_a, root_b);
+      }
+    }
+  }
+  clusters_t clusters;
+  std::vector<int> cluster_of_root(hashes.size(), -1);
+  for (int i = 0; i < hashes.size(); ++i) {
+    const int root = find(i);
+    if (cluster_of_root[root] < 0) {
+      cluster_of_root[root] = clusters.size();
+      clusters.append({});
+    }
+    clusters[cluster_of_root[root]].append(i);
+  }
+  clusters.erase(std::remove_if(clusters.begin(), clusters.end(),
+                                [](QVector<int> const& cluster) {
+                                  return cluster.size() < 2;
+                                }),
+                 clusters.end());
+  return clusters;
+}
+
+}  // namespace
+
+TEST(PerceptualHashTest, SurvivesRescalingAndBrightening) {
+  const quint64 hash = DifferenceHash(Gradient({900, 600}, 0));
+  EXPECT_LE(HammingDistance(hash, DifferenceHash(Gradient({300, 200}, 0))), 2);
+  EXPECT_LE(HammingDistance(hash, DifferenceHash(Gradient({900, 600}, -20))),
+            2);
+  EXPECT_GT(HammingDistance(hash, DifferenceHash(Checkers({900, 600}))), 10);
+}
+
+TEST(PerceptualHashTest, ClustersAreTransitiveAndInListOrder) {
+  const QVector<std::optional<quint64>> hashes{
+      0x0000'0000'0000'00ffull,  // 0: group with 2 and 4
+      0xffff'ffff'0000'0000ull,  // 1: alone
+      0x0000'0000'0000'003full,  // 2: 2 bits from 0
+      0xffff'0000'ffff'0000ull,  // 3: group with 5
+      0x0000'0000'0000'0003ull,  // 4: 4 bits from 2, 6 from 0
+      0xffff'0000'ffff'0001ull,  // 5: 1 bit from 3
+      std::nullopt,              // 6: unreadable
+  };
+  const clusters_t clusters = NearDuplicateClusters(hashes, 4);
+  ASSERT_EQ(clusters.size(), 2);
+  EXPECT_EQ(clusters[0], (QVector<int>{0, 2, 4}));
+  EXPECT_EQ(clusters[1], (QVector<int>{3, 5}));
+}
+
+TEST(PerceptualHashTest, DistanceLimitIsInclusive) {
+  const QVector<std::optional<quint64>> hashes{0x0ull, 0x7ull};
+  EXPECT_EQ(NearDuplicateClusters(hashes, 3).size(), 1);
+  EXPECT_TRUE(NearDuplicateClusters(hashes, 2).isEmpty());
+}
+
+TEST(PerceptualHashTest, MissingHashesJoinNoCluster) {
+  const QVector<std::optional<quint64>> hashes{std::nullopt, std::nullopt};
+  EXPECT_TRUE(NearDuplicateClusters(hashes, 6).isEmpty());
+}
+
+TEST(PerceptualHashTest, ClustersMatchAllPairsComparison) {
+  std::mt19937_64 random(5);
+  for (int round = 0; round < 20; ++round) {
+    const QVector<std::optional<quint64>> hashes = Bursts(random, 300);
+    for (int max_distance : {0, 1, 3, DuplicateFinder::kMaxDistance, 10}) {
+      SCOPED_TRACE(testing::Message() << "round " << round << ", distance "
+                                      << max_distance);
+      EXPECT_EQ(NearDuplicateClusters(hashes, max_distance),
+                AllPairsClusters(hashes, max_distance));
+    }
+  }
+}
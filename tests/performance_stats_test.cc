@@ -0,0 +1,54 @@
+#include "performance_stats.hpp"
+
+#include <gtest/gtest.h>
+
+TEST(StepStats, EmptyReportsZeros) {
+  StepStats stats;
+  EXPECT_EQ(stats.Count(), 0);
+  EXPECT_EQ(stats.Percentile(0.5), 0);
+  EXPECT_EQ(stats.MeanBlockedWaitMs(), 0);
+  StepStats::histogram_t empty{};
+  EXPECT_EQ(stats.Histogram(), empty);
+}
+
+TEST(StepStats, NearestRankPercentiles) {
+  StepStats stats;
+  for (int i = 1; i <= 100; ++i) stats.Record(i);
+  EXPECT_EQ(stats.Percentile(0.5), 50);
+  EXPECT_EQ(stats.Percentile(0.95), 95);
+  EXPECT_EQ(stats.Percentile(1.0), 100);
+  EXPECT_EQ(stats.Percentile(0.0), 1);
+}
+
+TEST(StepStats, CountsResolvesAndBlockedWait) {
+  StepStats stats;
+  stats.Record(5, SlotResolve::Ready);
+  stats.Record(20, SlotResolve::Converted);
+  stats.Record(120, SlotResolve::Blocked, 100);
+  stats.Record(60, SlotResolve::Blocked, 40);
+  stats.Record(3);  // a key that did not change the image
+  EXPECT_EQ(stats.Count(), 5);
+  EXPECT_EQ(stats.CountOf(SlotResolve::Ready), 1);
+  EXPECT_EQ(stats.CountOf(SlotResolve::Converted), 1);
+  EXPECT_EQ(stats.CountOf(SlotResolve::Blocked), 2);
+  EXPECT_DOUBLE_EQ(stats.MeanBlockedWaitMs(), 70);
+}
+
+TEST(StepStats, HistogramBucketsByUpperBound) {
+  StepStats stats;
+  for (double latency : {1.0, 8.0, 9.0, 33.0, 499.0, 501.0, 10000.0})
+    stats.Record(latency);
+  const StepStats::histogram_t expected{2, 1, 1, 0, 0, 0, 1, 2};
+  EXPECT_EQ(stats.Histogram(), expected);
+}
+
+TEST(StepStats, KeepsOnlyTheLastWindow) {
+  StepStats stats;
+  for (int i = 0; i < StepStats::kWindow; ++i)
+    stats.Record(1000, SlotResolve::Blocked, 900);
+  for (int i = 0; i < StepStats::kWindow; ++i)
+    stats.Record(1, SlotResolve::Ready);
+  EXPECT_EQ(stats.Count(), StepStats::kWindow);
+  EXPECT_EQ(stats.CountOf(SlotResolve::Blocked), 0);
+  EXPECT_EQ(stats.Percentile(1.0), 1);
+}
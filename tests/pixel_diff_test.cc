@@ -0,0 +1,81 @@
+#include "pixel_diff.hpp"
+
+#include <gtest/gtest.h>
+
+#include <QColor>
+#include <random>
+
+namespace {
+
+QImage Filled(int width, int height, QRgb color) {
+  QImage image(width, height, QImage::Format_RGB32);
+  image.fill(color);
+  return image;
+}
+
+QImage Noise(int width, int height, std::mt19937& random) {
+  QImage image(width, height, QImage::Format_RGB32);
+  for (int y = 0; y < height; ++y) {
+    auto* line = reinterpret_cast<QRgb*>(image.scanLine(y));
+    for (int x = 0; x < width; ++x) line[x] = 0xff000000 | (random() >> 8);
+  }
+  return image;
+}
+
+}  // namespace
+
+TEST(PixelDiffTest, IdenticalImagesHaveNoChangedPixels) {
+  const QImage image = Filled(37, 11, qRgb(10, 200, 30));
+  QImage heatmap;
+  const DiffStats stats = PixelDiff(image, image, 0, 8, &heatmap);
+  EXPECT_EQ(stats.pixels, 37 * 11);
+  EXPECT_EQ(stats.changed, 0);
+  EXPECT_EQ(stats.max_delta, 0);
+  ASSERT_EQ(heatmap.size(), QSize(37, 11));
+  EXPECT_EQ(heatmap.pixel(36, 10), 0u);
+}
+
+TEST(PixelDiffTest, LargestChannelDifferenceIsAmplifiedAndThresholded) {
+  QImage a = Filled(5, 1, qRgb(100, 100, 100));
+  QImage b = a.copy();
+  b.setPixel(1, 0, qRgb(104, 100, 100));  // below the threshold
+  b.setPixel(2, 0, qRgb(100, 90, 120));   // 20 in blue beats 10 in green
+  b.setPixel(4, 0, qRgb(0, 100, 100));    // 100 saturates the heatmap
+  QImage heatmap;
+  const DiffStats stats = PixelDiff(a, b, 5, 10, &heatmap);
+  EXPECT_EQ(stats.changed, 2);
+  EXPECT_EQ(stats.max_delta, 100);
+  EXPECT_EQ(heatmap.pixel(0, 0), 0u);
+  EXPECT_EQ(heatmap.pixel(1, 0), 0x28280000u);
+  EXPECT_EQ(heatmap.pixel(2, 0), 0xc8c80000u);
+  EXPECT_EQ(heatmap.pixel(4, 0), 0xffff0000u);
+}
+
+TEST(PixelDiffTest, ComparesTheCommonAreaOfDifferentSizes) {
+  QImage heatmap;
+  const DiffStats stats =
+      PixelDiff(Filled(40, 10, qRgb(0, 0, 0)), Filled(30, 20, qRgb(0, 0, 9)),
+                8, 1, &heatmap);
+  EXPECT_EQ(heatmap.size(), QSize(30, 10));
+  EXPECT_EQ(stats.pixels, 300);
+  EXPECT_EQ(stats.changed, 300);
+  EXPECT_EQ(stats.max_delta, 9);
+}
+
+TEST(PixelDiffTest, VectorKernelsMatchTheScalarOne) {
+  std::mt19937 random(7);
+  // An odd width leaves a tail after the last full vector of every row.
+  const QImage a = Noise(203, 131, random);
+  const QImage b = Noise(203, 131, random);
+  QImage expected;
+  const DiffStats scalar = PixelDiff(a, b, 40, 3, &expected, SimdLevel::Scalar);
+  for (SimdLevel level : {SimdLevel::Sse2, SimdLevel::Avx2}) {
+    if (!IsSupported(level)) continue;
+    QImage heatmap;
+    const DiffStats stats = PixelDiff(a, b, 40, 3, &heatmap, level);
+    EXPECT_EQ(stats.changed, scalar.changed);
+    EXPECT_EQ(stats.max_delta, scalar.max_delta);
+    EXPECT_EQ(heatmap, expected);
+    EXPECT_EQ(PixelDiff(a, b, 40, 3, nullptr, level).changed, scalar.changed);
+  }
+}
@@ -0,0 +1,108 @@
+#include "preview_cache.hpp"
+
+#include <gtest/gtest.h>
+
+#include <QCoreApplication>
+#include <QDir>
+#include <QFile>
+#include <QTemporaryDir>
+
+#include "startup_loader.hpp"
+#include "test-images.hpp"
+
+namespace {
+
+struct PreviewCacheFixture : public ::testing::Test {
+  void SetUp() override {
+    ASSERT_TRUE(images_dir.isValid());
+    ASSERT_TRUE(cache_dir.isValid());
+  }
+  QTemporaryDir images_dir;
+  QTemporaryDir cache_dir;
+  QDir images{images_dir.path()};
+  PreviewCache cache{cache_dir.path()};
+};
+
+}  // namespace
+
+TEST_F(PreviewCacheFixture, StoredPreviewFitsTheBoundAndKeepsTheFullSize) {
+  const QString path = MakeImage(images, "wide.png", {800, 400});
+  EXPECT_FALSE(cache.Find(path).has_value());
+
+  ASSERT_TRUE(cache.Store(path, QSize(200, 200)));
+  EXPECT_TRUE(cache.Contains(path));
+  const std::optional<PreviewCache::Entry> entry = cache.Find(path);
+  ASSERT_TRUE(entry.has_value());
+  EXPECT_EQ(entry->preview.size(), QSize(200, 100));
+  EXPECT_EQ(entry->image_size, QSize(800, 400));
+}
+
+TEST_F(PreviewCacheFixture, ChangedFileInvalidatesItsEntry) {
+  const QString path = MakeImage(images, "image.png", {64, 64});
+  ASSERT_TRUE(cache.Store(path));
+  MakeImage(images, "image.png", {96, 48});
+  EXPECT_FALSE(cache.Contains(path));
+  EXPECT_FALSE(cache.Find(path).has_value());
+}
+
+TEST_F(PreviewCacheFixture, UnreadableImageIsNotStored) {
+  const QString path = images.filePath("broken.jpg");
+  QFile file(path);
+  ASSERT_TRUE(file.open(QIODevice::WriteOnly));
+  file.write("not an image");
+  file.close();
+  EXPECT_FALSE(cache.Store(path));
+  EXPECT_FALSE(cache.Contains(path));
+}
+
+TEST_F(PreviewCacheFixture, PrefetchWalksSubfoldersAndSkipsFreshEntries) {
+  ASSERT_TRUE(images.mkdir("nested"));
+  const QString top = MakeImage(images, "top.png", {64, 64});
+  const QString nested = MakeImage(images, "nested/inner.png", {64, 64});
+
+  PrefetchStats stats = Prefetch({images.path()}, cache);
+  EXPECT_EQ(stats.images, 2);
+  EXPECT_EQ(stats.done, 2);
+  EXPECT_EQ(stats.stored, 2);
+  EXPECT_EQ(stats.failed, 0);
+  EXPECT_TRUE(cache.Contains(top));
+  EXPECT_TRUE(cache.Contains(nested));
+
+  stats = Prefetch({images.path()}, cache);
+  EXPECT_EQ(stats.stored, 0);
+  EXPECT_EQ(stats.fresh, 2);
+}
+
+TEST_F(PreviewCacheFixture, StartupLoaderShowsTheCachedPreview) {
+  const QString path = MakeImage(images, "image.png", {800, 400});
+  ASSERT_TRUE(cache.Store(path, QSize(100, 100)));
+
+  // Larger than the cached preview: a decode would have produced 400x200.
+  StartupLoader loader(QSize(400, 400), cache);
+  std::optional<StartupLoader::Result> result;
+  QObject::connect(&loader, &StartupLoader::loaded,
+                   [&result](StartupLoader::Result loaded) {
+                     result = std::move(loaded);
+                   });
+  loader.LoadImages({path});
+  while (!result) QCoreApplication::processEvents(QEventLoop::AllEvents, 10);
+  EXPECT_EQ(result->preview.size(), QSize(100, 50));
+  EXPECT_EQ(result->image_size, QSize(800, 400));
+}
+
+TEST_F(PreviewCacheFixture, StartupLoaderDecodesForTargetsBeyondTheBound) {
+  const QString path = MakeImage(images, "image.png", {4000, 2000});
+  ASSERT_TRUE(cache.Store(path));
+
+  // A HiDPI screen: the cached preview, 1920x960, would be scaled up.
+  StartupLoader loader(QSize(3000, 3000), cache);
+  std::optional<StartupLoader::Result> result;
+  QObject::connect(&loader, &StartupLoader::loaded,
+                   [&result](StartupLoader::Result loaded) {
+                     result = std::move(loaded);
+                   });
+  loader.LoadImages({path});
+  while (!result) QCoreApplication::processEvents(QEventLoop::AllEvents, 10);
+  EXPECT_EQ(result->preview.size(), QSize(3000, 1500));
+  EXPECT_EQ(result->image_size, QSize(4000, 2000));
+}
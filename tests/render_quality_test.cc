@@ -0,0 +1,30 @@
+#include "render_quality.hpp"
+
+#include <gtest/gtest.h>
+
+#include <QCoreApplication>
+#include <QElapsedTimer>
+#include <QVector>
+
+TEST(RenderQualityTest, BurstOfInteractionSwitchesOnceEachWay) {
+  RenderQuality quality;
+  QVector<bool> changes;
+  QObject::connect(&quality, &RenderQuality::changed,
+                   [&changes](bool smooth) { changes << smooth; });
+  ASSERT_TRUE(quality.IsSmooth());
+
+  QElapsedTimer clock;
+  clock.start();
+  for (int i = 0; i < 5; ++i) {
+    quality.Interact();
+    QCoreApplication::processEvents(QEventLoop::AllEvents, 10);
+  }
+  EXPECT_FALSE(quality.IsSmooth());
+  EXPECT_EQ(changes, QVector<bool>{false});
+
+  while (!quality.IsSmooth() && clock.elapsed() < 2000)
+    QCoreApplication::processEvents(QEventLoop::WaitForMoreEvents, 50);
+  EXPECT_TRUE(quality.IsSmooth());
+  EXPECT_GE(clock.elapsed(), RenderQuality::kIdleMs);
+  EXPECT_EQ(changes, (QVector<bool>{false, true}));
+}
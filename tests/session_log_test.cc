@@ -0,0 +1,92 @@
+#include "session_log.hpp"
+
+#include <gtest/gtest.h>
+
+#include <QFile>
+#include <QTemporaryDir>
+
+namespace {
+
+SessionEvent RoundTrip(SessionEvent const& event) {
+  const QByteArray line = ToJsonLine(event);
+  EXPECT_TRUE(line.endsWith('\n'));
+  EXPECT_EQ(line.count('\n'), 1);
+  std::optional<SessionEvent> parsed = FromJsonLine(line);
+  EXPECT_TRUE(parsed.has_value());
+  return parsed.value_or(SessionEvent{});
+}
+
+}  // namespace
+
+TEST(SessionLog, KeyEventsRoundTrip) {
+  SessionEvent press{1234, SessionEvent::Type::KeyPress, Qt::Key_Right,
+                     int(Qt::ControlModifier), true};
+  const SessionEvent parsed = RoundTrip(press);
+  EXPECT_EQ(parsed.type, SessionEvent::Type::KeyPress);
+  EXPECT_EQ(parsed.time_ms, 1234);
+  EXPECT_EQ(parsed.key, Qt::Key_Right);
+  EXPECT_EQ(parsed.modifiers, int(Qt::ControlModifier));
+  EXPECT_TRUE(parsed.repeat);
+
+  SessionEvent release{99, SessionEvent::Type::KeyRelease, Qt::Key_Down};
+  EXPECT_EQ(RoundTrip(release).type, SessionEvent::Type::KeyRelease);
+  EXPECT_FALSE(RoundTrip(release).repeat);
+}
+
+TEST(SessionLog, EditsKeepOnlyTheFileName) {
+  SessionEvent event{10, SessionEvent::Type::Edit};
+  event.edit = EntryEdit{EntryEdit::Kind::Move, "/photos/trip/b.jpg", 3};
+  const SessionEvent parsed = RoundTrip(event);
+  EXPECT_EQ(parsed.type, SessionEvent::Type::Edit);
+  EXPECT_EQ(parsed.edit.kind, EntryEdit::Kind::Move);
+  EXPECT_EQ(parsed.edit.path, QString("b.jpg"));
+  EXPECT_EQ(parsed.edit.to, 3);
+
+  event.edit = EntryEdit{EntryEdit::Kind::Disable, "/photos/trip/c.jpg"};
+  EXPECT_EQ(RoundTrip(event).edit.kind, EntryEdit::Kind::Disable);
+  EXPECT_EQ(RoundTrip(event).edit.to, -1);
+}
+
+TEST(SessionLog, ActivationsRoundTrip) {
+  SessionEvent event{5, SessionEvent::Type::Activate};
+  event.name = "/photos/trip/a.png";
+  EXPECT_EQ(RoundTrip(event).name, QString("a.png"));
+}
+
+TEST(SessionLog, RejectsUnknownLines) {
+  EXPECT_FALSE(FromJsonLine("not json\n").has_value());
+  EXPECT_FALSE(FromJsonLine("{\"t\":1,\"type\":\"teleport\"}\n").has_value());
+  EXPECT_FALSE(
+      FromJsonLine("{\"t\":1,\"type\":\"edit\",\"kind\":\"paint\"}\n")
+          .has_value());
+}
+
+TEST(SessionLog, RecorderOutputReadsBackSkippingDamage) {
+  QTemporaryDir dir;
+  ASSERT_TRUE(dir.isValid());
+  const QString path = dir.filePath("session.jsonl");
+  {
+    SessionRecorder recorder(path);
+    ASSERT_TRUE(recorder.IsOpen());
+    recorder.Record(SessionEvent{0, SessionEvent::Type::KeyPress, Qt::Key_A});
+    recorder.Record(SessionEvent{0, SessionEvent::Type::KeyRelease, Qt::Key_A});
+  }
+  {
+    // A session cut short mid-line by a crash.
+    QFile file(path);
+    ASSERT_TRUE(file.open(QIODevice::Append));
+    file.write("{\"t\":5,\"type\":\"key_pr");
+  }
+  QString error;
+  const QVector<SessionEvent> events = ReadSession(path, &error);
+  ASSERT_EQ(events.size(), 2);
+  EXPECT_EQ(events[0].type, SessionEvent::Type::KeyPress);
+  EXPECT_EQ(events[1].type, SessionEvent::Type::KeyRelease);
+  EXPECT_LE(events[0].time_ms, events[1].time_ms);
+}
+
+TEST(SessionLog, MissingFileReportsError) {
+  QString error;
+  EXPECT_TRUE(ReadSession("/nonexistent/session.jsonl", &error).isEmpty());
+  EXPECT_FALSE(error.isEmpty());
+}
@@ -0,0 +1,71 @@
+#include "single_instance.hpp"
+
+#include <gtest/gtest.h>
+
+#include <QCoreApplication>
+#include <QUuid>
+#include <future>
+#include <optional>
+
+namespace {
+
+// Forward() blocks, so it runs on its own thread while this one spins the
+// event loop that the listening side needs.
+bool ForwardAndServe(QString const& name, QStringList const& arguments) {
+  auto forwarded = std::async(std::launch::async, [&] {
+    return SingleInstance::Forward(name, arguments);
+  });
+  while (forwarded.wait_for(std::chrono::milliseconds(0)) !=
+         std::future_status::ready)
+    QCoreApplication::processEvents(QEventLoop::AllEvents, 10);
+  return forwarded.get();
+}
+
+QString UniqueName() {
+  return QStringLiteral("pviewer-test-") +
+         QUuid::createUuid().toString(QUuid::Id128);
+}
+
+}  // namespace
+
+TEST(SingleInstanceTest, ForwardedArgumentsReachTheListener) {
+  const QString name = UniqueName();
+  SingleInstance instance;
+  ASSERT_TRUE(instance.Listen(name));
+  std::optional<QStringList> received;
+  QObject::connect(&instance, &SingleInstance::argumentsReceived,
+                   [&received](QStringList args) { received = args; });
+
+  const QStringList arguments{"/images/a.png", "/images/b.jpg"};
+  EXPECT_TRUE(ForwardAndServe(name, arguments));
+  ASSERT_TRUE(received.has_value());
+  EXPECT_EQ(*received, arguments);
+}
+
+TEST(SingleInstanceTest, ForwardFailsWithoutAListener) {
+  EXPECT_FALSE(SingleInstance::Forward(UniqueName(), {"/images/a.png"}, 100));
+}
+
+TEST(SingleInstanceTest, NameIsFreeAgainOnceTheListenerIsGone) {
+  const QString name = UniqueName();
+  {
+    SingleInstance first;
+    ASSERT_TRUE(first.Listen(name));
+  }
+  SingleInstance second;
+  EXPECT_TRUE(second.Listen(name));
+}
+
+TEST(SingleInstanceTest, LiveListenerIsNotTakenOver) {
+  const QString name = UniqueName();
+  SingleInstance first;
+  ASSERT_TRUE(first.Listen(name));
+  std::optional<QStringList> received;
+  QObject::connect(&first, &SingleInstance::argumentsReceived,
+                   [&received](QStringList args) { received = args; });
+
+  SingleInstance second;
+  EXPECT_FALSE(second.Listen(name));
+  EXPECT_TRUE(ForwardAndServe(name, {"/images/a.png"}));
+  EXPECT_TRUE(received.has_value());
+}
@@ -0,0 +1,33 @@
+#include "split_view.hpp"
+
+#include <gtest/gtest.h>
+
+TEST(SplitViewTest, PictureSmallerThanThePaneIsCentred) {
+  QRectF target;
+  const QRectF source = SplitView::VisibleSource(
+      QSizeF(100, 50), QSizeF(400, 300), 2.0, QPointF(0.1, 0.9), &target);
+  EXPECT_EQ(source, QRectF(0, 0, 100, 50));
+  EXPECT_EQ(target, QRectF(100, 100, 200, 100));
+}
+
+TEST(SplitViewTest, OnlyTheVisiblePartAroundTheCentreIsSource) {
+  QRectF target;
+  const QRectF source = SplitView::VisibleSource(
+      QSizeF(1000, 1000), QSizeF(200, 100), 1.0, QPointF(0.5, 0.25), &target);
+  EXPECT_EQ(source, QRectF(400, 200, 200, 100));
+  EXPECT_EQ(target, QRectF(0, 0, 200, 100));
+}
+
+TEST(SplitViewTest, CentreIsLimitedToTheEdgesOfThePicture) {
+  const QRectF source = SplitView::VisibleSource(
+      QSizeF(1000, 1000), QSizeF(200, 200), 0.5, QPointF(0.0, 1.0));
+  EXPECT_EQ(source, QRectF(0, 600, 400, 400));
+}
+
+TEST(SplitViewTest, EachAxisIsLimitedSeparately) {
+  QRectF target;
+  const QRectF source = SplitView::VisibleSource(
+      QSizeF(1000, 100), QSizeF(200, 200), 1.0, QPointF(0.75, 0.75), &target);
+  EXPECT_EQ(source, QRectF(650, 0, 200, 100));
+  EXPECT_EQ(target, QRectF(0, 50, 200, 100));
+}
@@ -0,0 +1,86 @@
+#include "startup_loader.hpp"
+
+#include <gtest/gtest.h>
+
+#include <QCoreApplication>
+#include <QDir>
+#include <QTemporaryDir>
+#include <optional>
+
+#include "test-images.hpp"
+
+namespace {
+
+// `loaded` is delivered through the event loop; spin it until it arrives.
+StartupLoader::Result WaitForResult(StartupLoader& loader) {
+  std::optional<StartupLoader::Result> result;
+  QObject::connect(&loader, &StartupLoader::loaded,
+                   [&result](StartupLoader::Result loaded) {
+                     result = std::move(loaded);
+                   });
+  while (!result) QCoreApplication::processEvents(QEventLoop::AllEvents, 10);
+  return *result;
+}
+
+}  // namespace
+
+TEST(StartupLoaderTest, PreviewIsScaledDownToTheTarget) {
+  QTemporaryDir dir;
+  ASSERT_TRUE(dir.isValid());
+  const QString path = MakeImage(QDir(dir.path()), "wide.png", {2000, 1000});
+
+  QSize image_size;
+  const QImage preview =
+      StartupLoader::Preview(path, QSize(400, 400), &image_size);
+  EXPECT_EQ(preview.size(), QSize(400, 200));
+  EXPECT_EQ(image_size, QSize(2000, 1000));
+}
+
+TEST(StartupLoaderTest, PreviewNeverScalesUp) {
+  QTemporaryDir dir;
+  ASSERT_TRUE(dir.isValid());
+  const QString path = MakeImage(QDir(dir.path()), "small.png", {300, 200});
+
+  EXPECT_EQ(StartupLoader::Preview(path, QSize(1920, 1080)).size(),
+            QSize(300, 200));
+}
+
+TEST(StartupLoaderTest, DirectoryIsListedInNaturalOrder) {
+  QTemporaryDir dir;
+  ASSERT_TRUE(dir.isValid());
+  QDir root(dir.path());
+  const QString second = MakeImage(root, "img10.png", {64, 32});
+  const QString first = MakeImage(root, "img2.png", {32, 32});
+  MakeImage(root, "notes.txt", {8, 8});
+
+  StartupLoader loader(QSize(16, 16));
+  loader.LoadDirectory(dir.path(), 2);
+  const StartupLoader::Result result = WaitForResult(loader);
+  EXPECT_EQ(result.images, (QList<QString>{first, second}));
+  EXPECT_EQ(result.position, 2);
+  EXPECT_EQ(result.image_size, QSize(64, 32));
+  EXPECT_EQ(result.preview.size(), QSize(16, 8));
+}
+
+TEST(StartupLoaderTest, StartPositionIsClampedToTheList) {
+  QTemporaryDir dir;
+  ASSERT_TRUE(dir.isValid());
+  const QString only = MakeImage(QDir(dir.path()), "only.png", {32, 32});
+
+  StartupLoader loader(QSize(16, 16));
+  loader.LoadImages({only}, 5);
+  const StartupLoader::Result result = WaitForResult(loader);
+  EXPECT_EQ(result.position, 1);
+  EXPECT_FALSE(result.preview.isNull());
+}
+
+TEST(StartupLoaderTest, EmptyDirectoryLoadsNothing) {
+  QTemporaryDir dir;
+  ASSERT_TRUE(dir.isValid());
+
+  StartupLoader loader(QSize(16, 16));
+  loader.LoadDirectory(dir.path(), 1);
+  const StartupLoader::Result result = WaitForResult(loader);
+  EXPECT_TRUE(result.images.isEmpty());
+  EXPECT_TRUE(result.preview.isNull());
+}
@@ -0,0 +1,19 @@
+#pragma once
+
+#include <gtest/gtest.h>
+
+#include <QColor>
+#include <QDir>
+#include <QImage>
+#include <QSize>
+#include <QString>
+
+// Saves a `size` PNG filled with `color` as `name` in `dir`; returns its path.
+inline QString MakeImage(QDir const& dir, QString const& name, QSize size,
+                         QColor color = QColor(0, 120, 0)) {
+  QImage image(size, QImage::Format_RGB32);
+  image.fill(color);
+  const QString path = dir.filePath(name);
+  EXPECT_TRUE(image.save(path, "PNG"));
+  return path;
+}
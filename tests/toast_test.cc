@@ -0,0 +1,45 @@
+#include "toast.hpp"
+
+#include <gtest/gtest.h>
+
+#include <QCoreApplication>
+#include <QElapsedTimer>
+
+#include "messagebox.hpp"
+
+TEST(ToastTest, ShowsCentredAndHidesAfterItsTime) {
+  QWidget parent;
+  parent.resize(800, 600);
+  parent.show();
+  Toast toast(&parent);
+  toast.Place(parent.rect());
+
+  QElapsedTimer clock;
+  clock.start();
+  toast.Show(QStringLiteral("first"), 100);
+  EXPECT_LT(clock.elapsed(), 100);  // never waits for the message to go
+  ASSERT_TRUE(toast.isVisible());
+  EXPECT_EQ(toast.text(), QStringLiteral("first"));
+  // Integer halving may leave it a pixel off either way.
+  EXPECT_NEAR(toast.geometry().center().x(), parent.rect().center().x(), 1);
+
+  while (toast.isVisible() && clock.elapsed() < 2000)
+    QCoreApplication::processEvents(QEventLoop::WaitForMoreEvents, 50);
+  EXPECT_FALSE(toast.isVisible());
+  EXPECT_GE(clock.elapsed(), 100);
+}
+
+TEST(ToastTest, MessageBoxGoesToTheSinkWithoutBlocking) {
+  QString received;
+  int duration = 0;
+  MessageBox::SetSink([&](QString const& info, int for_time_ms) {
+    received = info;
+    duration = for_time_ms;
+  });
+  MessageBox::inform(QStringLiteral("/photos/2024"), 600);
+  EXPECT_EQ(received, QStringLiteral("/photos/2024"));
+  EXPECT_EQ(duration, 600);
+  MessageBox::SetSink({});
+  MessageBox::inform(QStringLiteral("dropped"), 600);
+  EXPECT_EQ(received, QStringLiteral("/photos/2024"));
+}
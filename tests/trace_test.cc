@@ -0,0 +1,126 @@
+#include "trace.hpp"
+
+#include <gtest/gtest.h>
+
+#include <string>
+#include <thread>
+
+namespace {
+
+std::size_t Count(std::string const& text, std::string const& what) {
+  std::size_t count = 0;
+  for (auto at = text.find(what); at != std::string::npos;
+       at = text.find(what, at + what.size()))
+    ++count;
+  return count;
+}
+
+struct TraceFixture : public ::testing::Test {
+  void SetUp() override {
+#ifndef PVIEWER_TRACING
+    GTEST_SKIP() << "built without PVIEWER_TRACING";
+#endif
+    trace::Clear();
+    trace::Start();
+  }
+  void TearDown() override {
+    trace::Stop();
+    trace::Clear();
+  }
+};
+
+}  // namespace
+
+TEST_F(TraceFixture, RecordsInstantsAndScopes) {
+  trace::Instant("key", "key", 42);
+  { trace::Scope scope("decode", "task", 7); }
+  const std::string json = trace::ChromeJson();
+  EXPECT_EQ(Count(json, "\"name\":\"key\""), 1u);
+  EXPECT_EQ(Count(json, "\"ph\":\"i\""), 1u);
+  EXPECT_EQ(Count(json, "\"key\":42"), 1u);
+  EXPECT_EQ(Count(json, "\"name\":\"decode\""), 1u);
+  EXPECT_EQ(Count(json, "\"ph\":\"X\""), 1u);
+  EXPECT_EQ(Count(json, "\"task\":7"), 1u);
+}
+
+TEST_F(TraceFixture, NothingIsRecordedWhileStopped) {
+  trace::Stop();
+  trace::Instant("key");
+  { trace::Scope scope("decode"); }
+  EXPECT_EQ(Count(trace::ChromeJson(), "\"ph\":"), 0u);
+}
+
+TEST_F(TraceFixture, ScopeStartedWhileStoppedStaysUnrecorded) {
+  trace::Stop();
+  {
+    trace::Scope scope("decode");
+    trace::Start();
+  }
+  EXPECT_EQ(Count(trace::ChromeJson(), "\"name\":\"decode\""), 0u);
+}
+
+TEST_F(TraceFixture, FullRingKeepsTheNewestEvents) {
+  const std::size_t extra = 10;
+  for (std::size_t i = 0; i != trace::kEventsPerThread + extra; ++i)
+    trace::Instant("tick", "i", i);
+  const std::string json = trace::ChromeJson();
+  EXPECT_EQ(Count(json, "\"name\":\"tick\""), trace::kEventsPerThread);
+  EXPECT_EQ(Count(json, "\"i\":" + std::to_string(extra - 1) + '}'), 0u);
+  EXPECT_EQ(Count(json, "\"i\":" + std::to_string(extra) + '}'), 1u);
+}
+
+TEST_F(TraceFixture, ThreadsRecordSeparatelyUnderTheirNames) {
+  std::thread worker([] {
+    trace::NameThread("test worker");
+    trace::Instant("work");
+  });
+  worker.join();
+  trace::Instant("main");
+  const std::string json = trace::ChromeJson();
+  EXPECT_EQ(Count(json, "\"name\":\"test worker\""), 1u);
+  EXPECT_EQ(Count(json, "\"name\":\"work\""), 1u);
+  EXPECT_EQ(Count(json, "\"name\":\"main\""), 1u);
+  const auto tid_of = [&json](std::string const& name) {
+    const auto event = json.find("\"name\":\"" + name + '"');
+    const auto tid = json.find("\"tid\":", event);
+    return json.substr(tid, json.find(',', tid) - tid);
+  };
+  EXPECT_NE(tid_of("work"), tid_of("main"));
+}
+
+TEST_F(TraceFixture, ClearDropsRecordedEvents) {
+  trace::Instant("key");
+  trace::Clear();
+  trace::Instant("paint");
+  const std::string json = trace::ChromeJson();
+  EXPECT_EQ(Count(json, "\"name\":\"key\""), 0u);
+  EXPECT_EQ(Count(json, "\"name\":\"paint\""), 1u);
+}
+
+TEST_F(TraceFixture, EndedThreadsGoWithClear) {
+  std::thread([] {
+    trace::NameThread("short worker");
+    trace::Instant("work");
+  }).join();
+  std::thread([] { trace::NameThread("idle worker"); }).join();
+  std::string json = trace::ChromeJson();
+  EXPECT_EQ(Count(json, "\"name\":\"short worker\""), 1u);
+  EXPECT_EQ(Count(json, "\"name\":\"idle worker\""), 0u);
+
+  trace::Clear();
+  json = trace::ChromeJson();
+  EXPECT_EQ(Count(json, "\"name\":\"short worker\""), 0u);
+}
+
+TEST_F(TraceFixture, ThreadsAreNotNamedWhileStopped) {
+  trace::Stop();
+  std::thread worker([] {
+    trace::NameThread("unnamed worker");
+    trace::Start();
+    trace::Instant("work");
+  });
+  worker.join();
+  const std::string json = trace::ChromeJson();
+  EXPECT_EQ(Count(json, "\"name\":\"work\""), 1u);
+  EXPECT_EQ(Count(json, "\"name\":\"unnamed worker\""), 0u);
+}